@@ -26,6 +26,52 @@ namespace vkInit
 		return requiredExtensionSet.empty();
 	}
 
+	//the features CreateLogicalDevice enables without a fallback
+	bool CheckPhysicalDeviceFeatureSupport(const vk::PhysicalDevice& physicalDevice)
+	{
+		//the 1.1 and 1.2 feature structs can only be queried on a 1.2 device
+		if (physicalDevice.getProperties().apiVersion < VK_API_VERSION_1_2)
+		{
+			std::cout << "Physical device does not support Vulkan 1.2\n";
+
+			return false;
+		}
+
+		auto const featureChain{ physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan11Features, vk::PhysicalDeviceVulkan12Features>() };
+		vk::PhysicalDeviceFeatures const& features{ featureChain.get<vk::PhysicalDeviceFeatures2>().features };
+		vk::PhysicalDeviceVulkan11Features const& features11{ featureChain.get<vk::PhysicalDeviceVulkan11Features>() };
+		vk::PhysicalDeviceVulkan12Features const& features12{ featureChain.get<vk::PhysicalDeviceVulkan12Features>() };
+
+		const std::vector<std::pair<const char*, vk::Bool32>> requiredFeatureVec
+		{
+			{ "drawIndirectFirstInstance", features.drawIndirectFirstInstance },
+			{ "multiDrawIndirect", features.multiDrawIndirect },
+			{ "shaderSampledImageArrayDynamicIndexing", features.shaderSampledImageArrayDynamicIndexing },
+			{ "shaderDrawParameters", features11.shaderDrawParameters },
+			{ "timelineSemaphore", features12.timelineSemaphore },
+			{ "descriptorIndexing", features12.descriptorIndexing },
+			{ "runtimeDescriptorArray", features12.runtimeDescriptorArray },
+			{ "descriptorBindingPartiallyBound", features12.descriptorBindingPartiallyBound },
+			{ "descriptorBindingVariableDescriptorCount", features12.descriptorBindingVariableDescriptorCount },
+			{ "descriptorBindingSampledImageUpdateAfterBind", features12.descriptorBindingSampledImageUpdateAfterBind },
+			{ "descriptorBindingUpdateUnusedWhilePending", features12.descriptorBindingUpdateUnusedWhilePending },
+			{ "shaderSampledImageArrayNonUniformIndexing", features12.shaderSampledImageArrayNonUniformIndexing }
+		};
+
+		bool isSupported{ true };
+		for (const auto& [featureName, featureSupported] : requiredFeatureVec)
+		{
+			if (not featureSupported)
+			{
+				std::cout << "Physical device does not support the feature \"" << featureName << "\"\n";
+
+				isSupported = false;
+			}
+		}
+
+		return isSupported;
+	}
+
 	bool CheckPhysicalDeviceSuitability(const vk::PhysicalDevice& physicalDevice)
 	{
 		
@@ -44,18 +90,23 @@ namespace vkInit
 		}
 		
 
-		if (CheckPhysicalDeviceExtensionSupport(physicalDevice, requestedExtensionVec))
+		if (not CheckPhysicalDeviceExtensionSupport(physicalDevice, requestedExtensionVec))
 		{
-			std::cout << "Physical device can support the extensions\n";
+			std::cout << "Physical device can not support the extensions\n";
 			
-			return true;
+			return false;
 		}
-		else
+		std::cout << "Physical device can support the extensions\n";
+
+		if (not CheckPhysicalDeviceFeatureSupport(physicalDevice))
 		{
-			std::cout << "Physical device can not support the extensions\n";
-			
+			std::cout << "Physical device can not support the features\n";
+
 			return false;
 		}
+		std::cout << "Physical device can support the features\n";
+
+		return true;
 	}
 
 	vk::PhysicalDevice ChoosePhysicalDevice(const vk::Instance& instance)
@@ -93,6 +144,11 @@ namespace vkInit
 		{
 			uniqueIndexVec.emplace_back(queueFamilyIndices.PresentFamily.value());
 		}
+		if (queueFamilyIndices.TransferFamily.has_value()
+			and std::ranges::find(uniqueIndexVec, queueFamilyIndices.TransferFamily.value()) == uniqueIndexVec.end())
+		{
+			uniqueIndexVec.emplace_back(queueFamilyIndices.TransferFamily.value());
+		}
 		
 		float queuePriority{ 1.0f };
 
@@ -117,7 +173,35 @@ namespace vkInit
 			VK_KHR_SWAPCHAIN_EXTENSION_NAME
 		};
 
-		vk::PhysicalDeviceFeatures physicalDeviceFeatures{};
+		//the required features are checked by CheckPhysicalDeviceFeatureSupport when the device is chosen
+		vk::PhysicalDeviceFeatures2 physicalDeviceFeatures{};
+		//indirect draws start at the first visible instance of their mesh
+		physicalDeviceFeatures.features.drawIndirectFirstInstance = VK_TRUE;
+		//the whole scene in one indirect draw, the draw index picks the texture
+		physicalDeviceFeatures.features.multiDrawIndirect = VK_TRUE;
+		physicalDeviceFeatures.features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+		//optional, the texture samplers fall back to trilinear filtering without it
+		physicalDeviceFeatures.features.samplerAnisotropy = physicalDevice.getFeatures().samplerAnisotropy;
+		//optional, a texture whose ktx2 format can not be sampled is loaded from its source image instead
+		physicalDeviceFeatures.features.textureCompressionBC = physicalDevice.getFeatures().textureCompressionBC;
+		physicalDeviceFeatures.features.textureCompressionASTC_LDR = physicalDevice.getFeatures().textureCompressionASTC_LDR;
+
+		vk::PhysicalDeviceVulkan11Features physicalDeviceFeatures11{};
+		physicalDeviceFeatures11.shaderDrawParameters = VK_TRUE;
+		physicalDeviceFeatures.pNext = &physicalDeviceFeatures11;
+
+		//uploads signal a timeline value the graphics submit waits on
+		vk::PhysicalDeviceVulkan12Features physicalDeviceFeatures12{};
+		physicalDeviceFeatures12.timelineSemaphore = VK_TRUE;
+		//bindless textures, one runtime sized sampler array that is written while frames using it are in flight
+		physicalDeviceFeatures12.descriptorIndexing = VK_TRUE;
+		physicalDeviceFeatures12.runtimeDescriptorArray = VK_TRUE;
+		physicalDeviceFeatures12.descriptorBindingPartiallyBound = VK_TRUE;
+		physicalDeviceFeatures12.descriptorBindingVariableDescriptorCount = VK_TRUE;
+		physicalDeviceFeatures12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		physicalDeviceFeatures12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		physicalDeviceFeatures12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		physicalDeviceFeatures11.pNext = &physicalDeviceFeatures12;
 
 		std::vector<const char*> enabledLayerVec{};
 		
@@ -133,8 +217,9 @@ namespace vkInit
 			enabledLayerVec.data(),
 			static_cast<uint32_t>(deviceExtensionVec.size()),
 			deviceExtensionVec.data(),
-			&physicalDeviceFeatures
+			nullptr
 		};
+		deviceCreateInfo.pNext = &physicalDeviceFeatures;
 		
 		try
 		{
@@ -152,14 +237,16 @@ namespace vkInit
 		}
 	}
 
-	std::array<vk::Queue, 2> GetQueuesFromGPU(const vk::PhysicalDevice& physicalDevice, const vk::Device& device, const vk::SurfaceKHR& surface)
+	//graphics, present and transfer, the transfer queue is the graphics queue when there is no transfer family
+	std::array<vk::Queue, 3> GetQueuesFromGPU(const vk::PhysicalDevice& physicalDevice, const vk::Device& device, const vk::SurfaceKHR& surface)
 	{
 		vkUtil::QueueFamilyIndices queueFamilyIndices = vkUtil::FindQueueFamilies(physicalDevice, surface);
 
-		return	std::array<vk::Queue, 2>
+		return	std::array<vk::Queue, 3>
 				{
 					device.getQueue(queueFamilyIndices.GraphicsFamily.value(), 0),
-					device.getQueue(queueFamilyIndices.PresentFamily.value(), 0)
+					device.getQueue(queueFamilyIndices.PresentFamily.value(), 0),
+					device.getQueue(queueFamilyIndices.GetUploadFamily(), 0)
 				};
 	}
 
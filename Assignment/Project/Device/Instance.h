@@ -77,7 +77,8 @@ namespace vkInit
 
 		versionNumber &= ~(0xFFFU);
 
-		versionNumber = VK_MAKE_API_VERSION(0, 1, 0, 0);
+		//1.2 for draw parameters (gl_DrawID) in the core
+		versionNumber = VK_MAKE_API_VERSION(0, 1, 2, 0);
 
 		vk::ApplicationInfo applicationInfo
 		{
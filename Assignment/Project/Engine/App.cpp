@@ -55,6 +55,18 @@ void ave::App::CalculateFPS()
 		int frameRate{ std::max(-1, static_cast<int>(m_NumberOfFrames / m_TimeElapsed)) };
 		std::stringstream title;
 		title << frameRate << " fps";
+		vkUtil::FrameStatistics const& statistics{ m_VKEngineUPtr->GetFrameStatistics() };
+		title << " | instance upload: " << statistics.UploadedInstanceBytes / 1024.0 << " KB";
+		title << " | visible instances: " << statistics.VisibleInstances << "/" << statistics.TotalInstances;
+		title << " | visible triangles: " << statistics.VisibleTriangles;
+		title << " | cpu cull: " << statistics.CpuCullMilliseconds << " ms";
+		title << " | gpu cull: " << statistics.GpuCullMilliseconds << " ms";
+		title << " | gpu render pass: " << statistics.GpuRenderPassMilliseconds << " ms";
+		title << " | instances: " << statistics.InstanceCapacity << " (" << statistics.InstanceBufferBytes / 1024 << " KB gpu, " << statistics.HostInstanceBytes / 1024 << " KB cpu)";
+		title << " | vram: " << statistics.DeviceLocalUsedBytes / (1024 * 1024) << "/" << statistics.DeviceLocalAllocatedBytes / (1024 * 1024) << " MB";
+		title << " | textures: " << statistics.TextureResidentBytes / (1024 * 1024) << "/" << statistics.TextureBudgetBytes / (1024 * 1024) << " MB";
+		title << " | draw recording: " << statistics.RecordMilliseconds << " ms (";
+		title << (statistics.RecordingThreads > 0 ? std::to_string(statistics.RecordingThreads) + " threads)" : std::string{ "primary)" });
 		glfwSetWindowTitle(m_WindowPtr, title.str().c_str());
 		m_TimeElapsed = 0.0;
 		m_NumberOfFrames = -1;
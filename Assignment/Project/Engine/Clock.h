@@ -1,31 +1,12 @@
 #ifndef VK_CLOCK_H
 #define VK_CLOCK_H
 #include "Engine/Configuration.h"
+#include "Engine/Singleton.h"
 #include <GLFW/glfw3.h>
 
 namespace ave
 {
 
-	template <typename T>
-	class Singleton
-	{
-	public:
-		static T& GetInstance()
-		{
-			static T instance{};
-			return instance;
-		}
-
-		virtual ~Singleton() = default;
-		Singleton(const Singleton& other) = delete;
-		Singleton(Singleton&& other) = delete;
-		Singleton& operator=(const Singleton& other) = delete;
-		Singleton& operator=(Singleton&& other) = delete;
-
-	protected:
-		Singleton() = default;
-	};
-
 	class Clock final : public Singleton<Clock>
 	{
 	public:
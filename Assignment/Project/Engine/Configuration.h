@@ -13,6 +13,7 @@
 #include <chrono>
 #include <glm/gtc/matrix_transform.hpp>
 #include <execution>
+#include <algorithm>
 
 namespace ave
 {
@@ -0,0 +1,28 @@
+#ifndef VK_SINGLETON_H
+#define VK_SINGLETON_H
+
+namespace ave
+{
+
+	template <typename T>
+	class Singleton
+	{
+	public:
+		static T& GetInstance()
+		{
+			static T instance{};
+			return instance;
+		}
+
+		virtual ~Singleton() = default;
+		Singleton(const Singleton& other) = delete;
+		Singleton(Singleton&& other) = delete;
+		Singleton& operator=(const Singleton& other) = delete;
+		Singleton& operator=(Singleton&& other) = delete;
+
+	protected:
+		Singleton() = default;
+	};
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "ThreadPool.h"
+#include <atomic>
+
+namespace
+{
+	//shared with the queued tasks, a task that starts after the loop finished must still find it alive
+	struct ParallelForState
+	{
+		std::function<void(std::int64_t, std::int64_t)> Function;
+		std::int64_t Count{};
+		std::int64_t ChunkSize{};
+		std::int64_t ChunkCount{};
+
+		std::atomic<std::int64_t> NextChunk{};
+		std::atomic<std::int64_t> FinishedChunks{};
+
+		std::mutex Mutex;
+		std::condition_variable Condition;
+	};
+
+	void RunChunks(ParallelForState& state)
+	{
+		for (std::int64_t chunkIdx{ state.NextChunk++ }; chunkIdx < state.ChunkCount; chunkIdx = state.NextChunk++)
+		{
+			std::int64_t const begin{ chunkIdx * state.ChunkSize };
+			state.Function(begin, std::min(begin + state.ChunkSize, state.Count));
+
+			if (++state.FinishedChunks == state.ChunkCount)
+			{
+				std::lock_guard<std::mutex> lock{ state.Mutex };
+				state.Condition.notify_all();
+			}
+		}
+	}
+}
+
+ave::ThreadPool::ThreadPool()
+{
+	//the thread that calls ParallelFor works too
+	int const workerCount{ std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1) };
+	m_WorkerVec.reserve(workerCount);
+	for (int workerIdx{}; workerIdx < workerCount; ++workerIdx)
+	{
+		m_WorkerVec.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ave::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_Condition.notify_all();
+
+	for (auto& worker : m_WorkerVec)
+	{
+		worker.join();
+	}
+}
+
+int ave::ThreadPool::GetThreadCount() const
+{
+	return static_cast<int>(m_WorkerVec.size()) + 1;
+}
+
+void ave::ThreadPool::ParallelFor(std::int64_t count, std::int64_t chunkSize, std::function<void(std::int64_t begin, std::int64_t end)> const& function)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	chunkSize = std::max<std::int64_t>(chunkSize, 1);
+	std::int64_t const chunkCount{ (count + chunkSize - 1) / chunkSize };
+	if (chunkCount == 1)
+	{
+		function(0, count);
+		return;
+	}
+
+	auto statePtr{ std::make_shared<ParallelForState>() };
+	statePtr->Function = function;
+	statePtr->Count = count;
+	statePtr->ChunkSize = chunkSize;
+	statePtr->ChunkCount = chunkCount;
+
+	std::int64_t const helperCount{ std::min<std::int64_t>(chunkCount - 1, std::ssize(m_WorkerVec)) };
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		for (std::int64_t helperIdx{}; helperIdx < helperCount; ++helperIdx)
+		{
+			m_TaskQueue.emplace_back([statePtr]() { RunChunks(*statePtr); });
+		}
+	}
+	m_Condition.notify_all();
+
+	RunChunks(*statePtr);
+
+	std::unique_lock<std::mutex> lock{ statePtr->Mutex };
+	statePtr->Condition.wait(lock, [&statePtr]() { return statePtr->FinishedChunks == statePtr->ChunkCount; });
+}
+
+void ave::ThreadPool::Enqueue(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_TaskQueue.emplace_back(std::move(task));
+	}
+	m_Condition.notify_one();
+}
+
+void ave::ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_Condition.wait(lock, [this]() { return m_Stopping or not m_TaskQueue.empty(); });
+
+			if (m_Stopping and m_TaskQueue.empty())
+			{
+				return;
+			}
+
+			task = std::move(m_TaskQueue.front());
+			m_TaskQueue.pop_front();
+		}
+		task();
+	}
+}
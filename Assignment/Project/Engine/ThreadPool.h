@@ -0,0 +1,55 @@
+#ifndef VK_THREAD_POOL_H
+#define VK_THREAD_POOL_H
+#include "Engine/Configuration.h"
+#include "Engine/Singleton.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <future>
+
+namespace ave
+{
+
+	class ThreadPool final : public Singleton<ThreadPool>
+	{
+	public:
+		~ThreadPool() override;
+
+		//worker threads plus the calling thread
+		int GetThreadCount() const;
+
+		//splits [0, count) in chunks of chunkSize and blocks until every chunk ran, the calling thread takes chunks as well
+		void ParallelFor(std::int64_t count, std::int64_t chunkSize, std::function<void(std::int64_t begin, std::int64_t end)> const& function);
+
+		//runs the function on a worker without waiting for it, the future holds its result
+		//queued behind other tasks, a ParallelFor issued meanwhile still progresses on the calling thread
+		template<typename Function>
+		std::future<std::invoke_result_t<Function>> Async(Function&& function)
+		{
+			using Result = std::invoke_result_t<Function>;
+
+			//std::function has to be copyable, the packaged task is not
+			auto taskPtr{ std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function)) };
+			std::future<Result> future{ taskPtr->get_future() };
+			Enqueue([taskPtr]() { (*taskPtr)(); });
+			return future;
+		}
+	private:
+		friend class Singleton<ThreadPool>;
+		ThreadPool();
+
+		void WorkerLoop();
+		void Enqueue(std::function<void()> task);
+
+		std::vector<std::thread> m_WorkerVec;
+		std::deque<std::function<void()>> m_TaskQueue;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping{ false };
+	};
+}
+
+#endif
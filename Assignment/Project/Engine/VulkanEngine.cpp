@@ -10,7 +10,9 @@
 #include "Utils/RenderStructs.h"
 #include "Pipeline/Descriptor.h"
 #include "Utils/Frame.h"
+#include "Utils/CookedAsset.h"
 #include "Clock.h"
+#include "ThreadPool.h"
 #include <algorithm>
 #include <execution>
 
@@ -36,16 +38,35 @@ ave::VulkanEngine::~VulkanEngine()
 
 	m_RenderPassUPtr.reset();
 	m_Pipeline3DUPtr.reset();
+	m_PipelineCompressed3DUPtr.reset();
+	m_CullPipelineUPtr.reset();
 	m_InstancedScene3DUPtr.reset();
+	m_InstancedSceneCompressed3DUPtr.reset();
+	m_TextureLoaderUPtr.reset();
+	m_GeometryPool3DUPtr.reset();
+	m_GeometryPoolCompressed3DUPtr.reset();
+	m_UploadContextUPtr.reset();
 
 	m_Device.destroyCommandPool(m_CommandPool);
+	m_Device.destroyQueryPool(m_TimestampQueryPool);
 
 	m_Device.destroyDescriptorSetLayout(m_DescriptorSetLayoutFrame);
-	m_Device.destroyDescriptorSetLayout(m_DescriptorSetLayoutMesh);
-	m_Device.destroyDescriptorPool(m_DescriptorPoolMesh);
+	m_TextureSetUPtr.reset();
+
+	for (auto& frame : m_FrameContextVec)
+	{
+		frame.Destroy();
+	}
+	m_Device.destroyDescriptorPool(m_DescriptorPoolFrame);
 
 	DestroySwapchain();
 
+	//the pipelines are all released by now, what the driver compiled this run is kept for the next
+	vkInit::PipelineCache::GetInstance().Destroy();
+
+	vkUtil::MemoryAllocator::GetInstance().PrintHeapStatistics();
+	vkUtil::MemoryAllocator::GetInstance().Destroy();
+
 	m_Device.destroy();
 
 	m_Instance.destroySurfaceKHR(m_Surface);
@@ -61,39 +82,71 @@ void ave::VulkanEngine::Render()
 {
 	vk::Result result;
 
+	vkUtil::FrameContext& frameContext{ m_FrameContextVec[m_CurrentFrameNr] };
+
 	//uint64_max is a macro to wait for ever
-	result = m_Device.waitForFences(1, &m_SwapchainFrameVec[m_CurrentFrameNr].InFlightFence, VK_TRUE, UINT64_MAX);
+	result = m_Device.waitForFences(1, &frameContext.InFlightFence, VK_TRUE, UINT64_MAX);
 	if (result != vk::Result::eSuccess)
 	{
 		std::cout << "Waiting for fence failure\n";
 	}
 
-	result = m_Device.resetFences(1, &m_SwapchainFrameVec[m_CurrentFrameNr].InFlightFence);
+	result = m_Device.resetFences(1, &frameContext.InFlightFence);
 	if (result != vk::Result::eSuccess)
 	{
 		std::cout << "Waiting for fence failure\n";
 	}
 	
-	uint32_t imageIndex{ m_Device.acquireNextImageKHR(m_Swapchain, UINT64_MAX, m_SwapchainFrameVec[m_CurrentFrameNr].SemaphoreImageAvailable, nullptr).value };
+	ReadTimestamps(m_CurrentFrameNr);
+
+	//the secondary command buffers of the frame were executed by now
+	for (auto const& commandPool : frameContext.RecordingCommandPoolVec)
+	{
+		m_Device.resetCommandPool(commandPool);
+	}
+
+	//the frame that is reused has finished, geometry it could still draw can go now
+	m_GeometryPool3DUPtr->AdvanceFrame();
+	m_GeometryPoolCompressed3DUPtr->AdvanceFrame();
+	m_TextureLoaderUPtr->AdvanceFrame();
+	for (auto& frame : m_FrameContextVec)
+	{
+		frame.AdvanceRetiredBuffers();
+	}
 
-	vk::CommandBuffer commandBuffer{ m_SwapchainFrameVec[m_CurrentFrameNr].CommandBuffer };
+	uint32_t imageIndex{ m_Device.acquireNextImageKHR(m_Swapchain, UINT64_MAX, frameContext.SemaphoreImageAvailable, nullptr).value };
+
+	vk::CommandBuffer commandBuffer{ frameContext.CommandBuffer };
 
 	commandBuffer.reset();
 
-	PrepareFrame(imageIndex);
+	PrepareFrame();
 
 	RecordDrawCommands(commandBuffer, imageIndex);
 
 	std::vector<vk::Semaphore> waitSemaphoreVec;
-	waitSemaphoreVec.emplace_back(m_SwapchainFrameVec[m_CurrentFrameNr].SemaphoreImageAvailable);
+	waitSemaphoreVec.emplace_back(frameContext.SemaphoreImageAvailable);
+	waitSemaphoreVec.emplace_back(m_UploadContextUPtr->GetTimelineSemaphore());
 
 	std::vector<vk::PipelineStageFlags> waitStageVec;
 	waitStageVec.emplace_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+	waitStageVec.emplace_back(m_UploadContextUPtr->GetWaitStages());
 
 	std::vector<vk::Semaphore> signalSemaphoreVec;
-	signalSemaphoreVec.emplace_back(m_SwapchainFrameVec[m_CurrentFrameNr].SemaphoreRenderingFinished);
+	signalSemaphoreVec.emplace_back(m_SwapchainFrameVec[imageIndex].SemaphoreRenderingFinished);
+
+	//the binary semaphores ignore their value
+	std::vector<uint64_t> waitValueVec{ 0, m_UploadWaitTicket };
+	std::vector<uint64_t> signalValueVec{ 0 };
+
+	vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+	timelineSubmitInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValueVec.size());
+	timelineSubmitInfo.pWaitSemaphoreValues = waitValueVec.data();
+	timelineSubmitInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValueVec.size());
+	timelineSubmitInfo.pSignalSemaphoreValues = signalValueVec.data();
 
 	vk::SubmitInfo submitInfo{};
+	submitInfo.pNext = &timelineSubmitInfo;
 	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphoreVec.size());
 	submitInfo.pWaitSemaphores = waitSemaphoreVec.data();
 	submitInfo.pWaitDstStageMask = waitStageVec.data();
@@ -104,13 +157,16 @@ void ave::VulkanEngine::Render()
 
 	try
 	{
-		m_GraphicsQueue.submit(submitInfo, m_SwapchainFrameVec[m_CurrentFrameNr].InFlightFence);
+		m_GraphicsQueue.submit(submitInfo, frameContext.InFlightFence);
 	}
 	catch (const vk::SystemError& systemError)
 	{
 		std::cout << systemError.what() << "\n";
 	}
 
+	//after the submit, so the textures uploaded now are acquired by the next frame instead of holding up this one
+	m_TextureLoaderUPtr->Update();
+
 	std::vector<vk::SwapchainKHR> swapchainVec;
 	swapchainVec.emplace_back(m_Swapchain);
 
@@ -137,6 +193,11 @@ void ave::VulkanEngine::Render()
 	m_CurrentFrameNr = (m_CurrentFrameNr + 1) % m_MaxNrFramesInFlight;
 }
 
+vkUtil::FrameStatistics const& ave::VulkanEngine::GetFrameStatistics() const
+{
+	return m_FrameStatistics;
+}
+
 void ave::VulkanEngine::CreateInstance()
 {
 	m_Instance = vkInit::CreateInstance(m_WindowName);
@@ -164,13 +225,18 @@ void ave::VulkanEngine::CreateDevice()
 
 	m_Device = vkInit::CreateLogicalDevice(m_PhysicalDevice, m_Surface);
 
-	std::array<vk::Queue, 2> queues = vkInit::GetQueuesFromGPU(m_PhysicalDevice, m_Device, m_Surface);
+	//every buffer and image takes its memory from here, so it has to exist before the first one
+	vkUtil::MemoryAllocator::GetInstance().Initialize(m_Device, m_PhysicalDevice);
+
+	//every pipeline is created through it, so it has to exist before the first one
+	vkInit::PipelineCache::GetInstance().Initialize(m_Device, m_PhysicalDevice, "pipeline_cache.bin");
+
+	std::array<vk::Queue, 3> queues = vkInit::GetQueuesFromGPU(m_PhysicalDevice, m_Device, m_Surface);
 	m_GraphicsQueue = queues[0];
 	m_PresentQueue = queues[1];
+	m_TransferQueue = queues[2];
 
 	CreateSwapchain();
-
-	m_CurrentFrameNr = 0;
 }
 
 void ave::VulkanEngine::CreateSwapchain()
@@ -181,8 +247,6 @@ void ave::VulkanEngine::CreateSwapchain()
 	m_SwapchainExtent = tempBunlde.Extent;
 	m_SwapchainFormat = tempBunlde.Format;
 
-	m_MaxNrFramesInFlight = static_cast<int>(m_SwapchainFrameVec.size());
-
 	for (auto& frame : m_SwapchainFrameVec)
 	{
 		frame.Device = m_Device;
@@ -190,11 +254,14 @@ void ave::VulkanEngine::CreateSwapchain()
 		frame.DepthExtent = m_SwapchainExtent;
 
 		frame.CreateDepthResources();
+		frame.SemaphoreRenderingFinished = vkInit::CreateSemaphore(m_Device);
 	}
 }
 
 void ave::VulkanEngine::CreatePipelines()
 {
+	auto const startTimePoint{ std::chrono::high_resolution_clock::now() };
+
 	vkInit::RenderPassInBundle inRenderPass{};
 	inRenderPass.Device = m_Device;
 	inRenderPass.DepthFormat = m_SwapchainFrameVec[0].DepthFormat;
@@ -206,17 +273,43 @@ void ave::VulkanEngine::CreatePipelines()
 	specification3D.Device = m_Device;
 	specification3D.SwapchainExtent = m_SwapchainExtent;
 	specification3D.DescriptorSetLayoutVec.emplace_back(m_DescriptorSetLayoutFrame);
-	specification3D.DescriptorSetLayoutVec.emplace_back(m_DescriptorSetLayoutMesh);
+	specification3D.DescriptorSetLayoutVec.emplace_back(m_TextureSetUPtr->GetDescriptorSetLayout());
 	specification3D.VertexFilePath = "shaders/Shader3D.vert.spv";
 	specification3D.FragmentFilePath = "shaders/Shader3D.frag.spv";
 	specification3D.RenderPass = m_RenderPassUPtr->GetRenderPass();
+	specification3D.PushConstantSize = sizeof(vkUtil::DrawPushConstants);
 
 	m_Pipeline3DUPtr = std::make_unique<vkInit::Pipeline<vkUtil::Vertex3D>>(specification3D);
+
+	//same layout as the 3d pipeline, only the vertex input and the vertex shader differ
+	vkInit::Pipeline<vkUtil::CompressedVertex3D>::GraphicsPipelineInBundle specificationCompressed3D{};
+	specificationCompressed3D.Device = specification3D.Device;
+	specificationCompressed3D.SwapchainExtent = specification3D.SwapchainExtent;
+	specificationCompressed3D.DescriptorSetLayoutVec = specification3D.DescriptorSetLayoutVec;
+	specificationCompressed3D.VertexFilePath = "shaders/Shader3DCompressed.vert.spv";
+	specificationCompressed3D.FragmentFilePath = specification3D.FragmentFilePath;
+	specificationCompressed3D.RenderPass = specification3D.RenderPass;
+	specificationCompressed3D.PushConstantSize = specification3D.PushConstantSize;
+
+	m_PipelineCompressed3DUPtr = std::make_unique<vkInit::Pipeline<vkUtil::CompressedVertex3D>>(specificationCompressed3D);
+
+	vkInit::ComputePipelineInBundle specificationCull{};
+	specificationCull.Device = m_Device;
+	specificationCull.ComputeFilePath = "shaders/Cull.comp.spv";
+	specificationCull.DescriptorSetLayoutVec.emplace_back(m_DescriptorSetLayoutFrame);
+	specificationCull.PushConstantSize = sizeof(vkUtil::CullPushConstants);
+
+	m_CullPipelineUPtr = std::make_unique<vkInit::ComputePipeline>(specificationCull);
+
+	std::chrono::duration<double, std::milli> const creationTime{ std::chrono::high_resolution_clock::now() - startTimePoint };
+	std::cout << "\nPipelines created in " << creationTime.count() << " ms with a "
+		<< (vkInit::PipelineCache::GetInstance().IsWarm() ? "warm" : "cold") << " pipeline cache\n";
 }
 
 void ave::VulkanEngine::SetUpRendering()
 {
 	CreateFrameBuffers();
+	CreateFrameResources();
 
 	m_CommandPool = vkInit::CreateCommandPool(m_Device, m_PhysicalDevice, m_Surface);
 
@@ -224,20 +317,52 @@ void ave::VulkanEngine::SetUpRendering()
 	{
 		m_Device,
 		m_CommandPool,
-		m_SwapchainFrameVec
+		m_FrameContextVec
 	};
 
-	m_MainCommandBuffer = vkInit::CreateMainCommandBuffer(commandBufferIn);
-
 	vkInit::CreateFrameCommandBuffers(commandBufferIn);
 
-	CreateFrameResources();
-
-	vkInit::DescriptorSetLayoutData descriptorSetLayoutData{};
-	descriptorSetLayoutData.Count = 1;
-	descriptorSetLayoutData.TypeVec.emplace_back(vk::DescriptorType::eCombinedImageSampler);
-	//allow for 10 textures
-	m_DescriptorPoolMesh = vkInit::CreateDescriptorPool(m_Device, m_NumberOfTextures, descriptorSetLayoutData);
+	//a batch per thread, recording starts out on every thread
+	m_MaxRecordingThreadCount = ave::ThreadPool::GetInstance().GetThreadCount();
+	m_RecordingThreadCount = m_MaxRecordingThreadCount;
+	vkInit::SecondaryCommandBufferInBundle secondaryCommandBufferIn
+	{
+		m_Device,
+		m_PhysicalDevice,
+		m_Surface,
+		m_FrameContextVec,
+		m_MaxRecordingThreadCount
+	};
+	vkInit::CreateFrameSecondaryCommandBuffers(secondaryCommandBufferIn);
+
+	CreateTimestampQueries();
+
+	vkUtil::QueueFamilyIndices const queueFamilyIndices{ vkUtil::FindQueueFamilies(m_PhysicalDevice, m_Surface) };
+
+	vkUtil::UploadContextInBundle uploadContextIn{};
+	uploadContextIn.Device = m_Device;
+	uploadContextIn.PhysicalDevice = m_PhysicalDevice;
+	uploadContextIn.Queue = m_TransferQueue;
+	uploadContextIn.QueueFamilyIdx = queueFamilyIndices.GetUploadFamily();
+	uploadContextIn.DstQueueFamilyIdx = queueFamilyIndices.GraphicsFamily.value();
+	m_UploadContextUPtr = std::make_unique<vkUtil::UploadContext>(uploadContextIn);
+
+	vkInit::TextureLoaderInBundle textureLoaderIn{};
+	textureLoaderIn.Device = m_Device;
+	textureLoaderIn.PhysicalDevice = m_PhysicalDevice;
+	textureLoaderIn.UploadContextPtr = m_UploadContextUPtr.get();
+	textureLoaderIn.TextureSetPtr = m_TextureSetUPtr.get();
+	textureLoaderIn.MemoryBudget = m_TextureMemoryBudget;
+	m_TextureLoaderUPtr = std::make_unique<vkInit::TextureLoader>(textureLoaderIn);
+	m_TextureLoaderUPtr->SetFramesInFlight(m_MaxNrFramesInFlight);
+
+	ave::GeometryPoolInBundle geometryPoolIn{};
+	geometryPoolIn.Device = m_Device;
+	geometryPoolIn.PhysicalDevice = m_PhysicalDevice;
+	geometryPoolIn.VertexCapacity = m_GeometryPoolVertexCapacity;
+	geometryPoolIn.IndexCapacity = m_GeometryPoolIndexCapacity;
+	m_GeometryPool3DUPtr = std::make_unique<ave::GeometryPool<vkUtil::Vertex3D>>(geometryPoolIn);
+	m_GeometryPoolCompressed3DUPtr = std::make_unique<ave::GeometryPool<vkUtil::CompressedVertex3D>>(geometryPoolIn);
 
 	m_CameraUPtr = std::make_unique<Camera>(m_WindowPtr, glm::vec3{ 0, 0, -300 }, 20, m_SwapchainExtent.width, m_SwapchainExtent.height);
 
@@ -247,20 +372,28 @@ void ave::VulkanEngine::SetUpRendering()
 void ave::VulkanEngine::Create3DScene()
 {
 	using V3D = vkUtil::Vertex3D;
-	m_InstancedScene3DUPtr = std::make_unique<InstancedScene<V3D>>();
+	using CV3D = vkUtil::CompressedVertex3D;
+	m_InstancedScene3DUPtr = std::make_unique<InstancedScene<V3D>>(*m_GeometryPool3DUPtr, *m_TextureLoaderUPtr);
+	m_InstancedScene3DUPtr->SetFrameCount(m_MaxNrFramesInFlight);
+	m_GeometryPool3DUPtr->SetFramesInFlight(m_MaxNrFramesInFlight);
+	m_InstancedSceneCompressed3DUPtr = std::make_unique<InstancedScene<CV3D>>(*m_GeometryPoolCompressed3DUPtr, *m_TextureLoaderUPtr);
+	m_InstancedSceneCompressed3DUPtr->SetFrameCount(m_MaxNrFramesInFlight);
+	m_GeometryPoolCompressed3DUPtr->SetFramesInFlight(m_MaxNrFramesInFlight);
 
 	vkUtil::MeshInBundle meshIn
 	{
-		m_GraphicsQueue,
-		m_MainCommandBuffer,
+		m_UploadContextUPtr.get(),
 		m_Device,
 		m_PhysicalDevice
 	};
 
-	std::vector<V3D> ferrariVertexVec{};
-	std::vector<uint32_t> ferrariIndexVec{};
+	//the texture decodes on the thread pool while the rest of the scene is built, the mesh shows the placeholder until it is resident
+	vkInit::TextureHandle const ferrariTexture{ m_TextureLoaderUPtr->Load("Resources/ferrari_diffuse.jpg") };
 
-	vkUtil::ParseOBJ<V3D>("Resources/ferrari.obj", ferrariVertexVec, ferrariIndexVec, false);
+	//mapped from the cooked file when the asset cooker has run with --compress, parsed from the obj otherwise
+	//thousands of ferraris are drawn, so they are worth the compressed vertices
+	vkUtil::MeshData<CV3D> ferrariMeshData{};
+	vkUtil::LoadMesh<CV3D>("Resources/ferrari.obj", ferrariMeshData, false);
 
 	std::vector<glm::mat4> ferrariPositionVec{};
 	int numRows = 100;  
@@ -284,22 +417,15 @@ void ave::VulkanEngine::Create3DScene()
 		}
 	}
 
-	vkInit::TextureInBundle textureIn{};
-	textureIn.CommandBuffer = m_MainCommandBuffer;
-	textureIn.Queue = m_GraphicsQueue;
-	textureIn.Device = m_Device;
-	textureIn.PhysicalDevice = m_PhysicalDevice;
-	textureIn.DescriptorSetLayout = m_DescriptorSetLayoutMesh;
-	textureIn.DescriptorPool = m_DescriptorPoolMesh;
-
-	textureIn.FileName = "Resources/ferrari_diffuse.jpg";
-	m_InstancedScene3DUPtr->AddMesh(std::move(std::make_unique<ave::InstancedMesh<V3D>>(meshIn, ferrariVertexVec, ferrariIndexVec, ferrariPositionVec, textureIn)));
+	if (not m_InstancedSceneCompressed3DUPtr->AddMesh(std::move(std::make_unique<ave::InstancedMesh<CV3D>>(meshIn, *m_GeometryPoolCompressed3DUPtr, ferrariMeshData.Vertices, ferrariMeshData.Indices, ferrariMeshData.Lods, ferrariMeshData.Bounds,
+		ferrariMeshData.Quantization, ferrariPositionVec, ferrariTexture))))
+	{
+		std::cout << "Ferrari mesh does not fit in the geometry pool\n";
+	}
 
 	//////////////////////////
-	//std::vector<V3D> vehicleVertexVec{};
-	//std::vector<uint32_t> vehicleIndexVec{};
-	//
-	//vkUtil::ParseOBJ<V3D>("Resources/vehicle.obj", vehicleVertexVec, vehicleIndexVec, true);
+	//vkUtil::MeshData<V3D> vehicleMeshData{};
+	//vkUtil::LoadMesh<V3D>("Resources/vehicle.obj", vehicleMeshData, true);
 	//std::vector<glm::mat4> vehiclePositionVec{};
 	//
 	//for (int rowIdx = 0; rowIdx < numRows; ++rowIdx) 
@@ -319,81 +445,320 @@ void ave::VulkanEngine::Create3DScene()
 	//	}
 	//}
 	//
-	//textureIn.FileName = "Resources/vehicle_diffuse.png";
-	//m_InstancedScene3DUPtr->AddMesh(std::move(std::make_unique<ave::InstancedMesh<V3D>>(meshIn, vehicleVertexVec, vehicleIndexVec, vehiclePositionVec, textureIn)));
+	//vkInit::TextureHandle const vehicleTexture{ m_TextureLoaderUPtr->Load("Resources/vehicle_diffuse.png") };
+	//if (not m_InstancedScene3DUPtr->AddMesh(std::move(std::make_unique<ave::InstancedMesh<V3D>>(meshIn, *m_GeometryPool3DUPtr, vehicleMeshData.Vertices, vehicleMeshData.Indices, vehicleMeshData.Lods, vehicleMeshData.Bounds, vehicleMeshData.Quantization, vehiclePositionVec, vehicleTexture))))
+	//{
+	//	std::cout << "Vehicle mesh does not fit in the geometry pool\n";
+	//}
+
+	//every mesh of the scene and the placeholder texture go out in one submission, the first frame waits on it
+	m_UploadContextUPtr->Submit();
 }
 
-void ave::VulkanEngine::PrepareFrame(uint32_t imgIdx)
+void ave::VulkanEngine::CreateTimestampQueries()
 {
-	auto& swapchainFrame = m_SwapchainFrameVec[imgIdx];
+	m_Device.destroyQueryPool(m_TimestampQueryPool);
+	m_TimestampQueryPool = nullptr;
+	m_TimestampsWrittenVec.assign(m_MaxNrFramesInFlight, false);
+
+	vkUtil::QueueFamilyIndices const queueFamilyIndices{ vkUtil::FindQueueFamilies(m_PhysicalDevice, m_Surface) };
+	std::vector<vk::QueueFamilyProperties> const queueFamilyVec{ m_PhysicalDevice.getQueueFamilyProperties() };
+	if (queueFamilyVec[queueFamilyIndices.GraphicsFamily.value()].timestampValidBits == 0)
+	{
+		std::cout << "The graphics queue can not write timestamps, gpu times are not measured\n";
+		return;
+	}
+
+	m_TimestampPeriod = m_PhysicalDevice.getProperties().limits.timestampPeriod;
+
+	vk::QueryPoolCreateInfo queryPoolCreateInfo{};
+	queryPoolCreateInfo.flags = vk::QueryPoolCreateFlags{};
+	queryPoolCreateInfo.queryType = vk::QueryType::eTimestamp;
+	queryPoolCreateInfo.queryCount = TimestampsPerFrame * static_cast<uint32_t>(m_MaxNrFramesInFlight);
+
+	try
+	{
+		m_TimestampQueryPool = m_Device.createQueryPool(queryPoolCreateInfo);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+	}
+}
+
+void ave::VulkanEngine::ReadTimestamps(int frameNr)
+{
+	if (not m_TimestampQueryPool or not m_TimestampsWrittenVec[frameNr])
+	{
+		return;
+	}
+
+	std::array<uint64_t, TimestampsPerFrame> timestampArr{};
+	vk::Result const result{ m_Device.getQueryPoolResults(m_TimestampQueryPool, TimestampsPerFrame * static_cast<uint32_t>(frameNr), TimestampsPerFrame,
+		sizeof(timestampArr), timestampArr.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64) };
+	if (result != vk::Result::eSuccess)
+	{
+		return;
+	}
+
+	double const millisecondsPerTick{ m_TimestampPeriod / 1'000'000.0 };
+	m_FrameStatistics.GpuCullMilliseconds = static_cast<double>(timestampArr[1] - timestampArr[0]) * millisecondsPerTick;
+	m_FrameStatistics.GpuRenderPassMilliseconds = static_cast<double>(timestampArr[2] - timestampArr[1]) * millisecondsPerTick;
+}
+
+std::int64_t ave::VulkanEngine::GetInstanceCount() const
+{
+	return m_InstancedScene3DUPtr->GetInstanceCount() + m_InstancedSceneCompressed3DUPtr->GetInstanceCount();
+}
+
+std::int64_t ave::VulkanEngine::GetDrawCommandCount() const
+{
+	return m_InstancedScene3DUPtr->GetDrawCommandCount() + m_InstancedSceneCompressed3DUPtr->GetDrawCommandCount();
+}
+
+void ave::VulkanEngine::PrepareFrame()
+{
+	auto& frameContext = m_FrameContextVec[m_CurrentFrameNr];
 
 	m_CameraUPtr->Update();
 
-	swapchainFrame.VPMatrix.ViewMatrix = m_CameraUPtr->GetViewMatrix();
-	swapchainFrame.VPMatrix.ProjectionMatrix = m_CameraUPtr->GetProjectionMatrix();
-	memcpy(swapchainFrame.VPWriteLocationPtr, &swapchainFrame.VPMatrix, sizeof(vkUtil::UBO));
+	frameContext.VPMatrix.ViewMatrix = m_CameraUPtr->GetViewMatrix();
+	frameContext.VPMatrix.ProjectionMatrix = m_CameraUPtr->GetProjectionMatrix();
+	std::array<glm::vec4, 6> const frustumPlaneArr{ m_CameraUPtr->GetFrustumPlanes() };
+	std::copy(frustumPlaneArr.begin(), frustumPlaneArr.end(), frameContext.VPMatrix.FrustumPlaneArr);
+	frameContext.VPMatrix.CameraPosition = glm::vec4{ m_CameraUPtr->GetCameraPosition(), 1.f };
+	memcpy(frameContext.VPWriteLocationPtr, &frameContext.VPMatrix, sizeof(vkUtil::UBO));
 
 	static bool pressedFThisFrame{ false };
-	static bool pressedVThisFrame{ false };
 	static bool pressedRThisFrame{ false };
-	static bool pressedTThisFrame{ false };
+	static bool pressedCThisFrame{ false };
+	static bool pressedMThisFrame{ false };
+	static bool pressedHThisFrame{ false };
+	static bool pressedLThisFrame{ false };
+	static bool pressedGThisFrame{ false };
+	static bool pressedKThisFrame{ false };
 	if (glfwGetKey(m_WindowPtr, GLFW_KEY_F) == GLFW_PRESS)
 	{
 		if (not pressedFThisFrame)
 		{
 			pressedFThisFrame = true;
-			m_InstancedScene3DUPtr->AddInstanceToMesh(0);
+			m_InstancedSceneCompressed3DUPtr->AddInstance(0);
 		}
 	}
 	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_F) == GLFW_RELEASE)
 	{
 		pressedFThisFrame = false;
 	}
-	if (glfwGetKey(m_WindowPtr, GLFW_KEY_V) == GLFW_PRESS)
+	if (glfwGetKey(m_WindowPtr, GLFW_KEY_R) == GLFW_PRESS)
 	{
-		if (not pressedVThisFrame)
+		if (not pressedRThisFrame)
 		{
-			pressedVThisFrame = true;
-			m_InstancedScene3DUPtr->AddInstanceToMesh(1);
+			pressedRThisFrame = true;
+			m_InstancedSceneCompressed3DUPtr->RemoveInstance(m_InstancedSceneCompressed3DUPtr->GetInstanceHandle(0, 0));
 		}
 	}
-	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_V) == GLFW_RELEASE)
+	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_R) == GLFW_RELEASE)
 	{
-		pressedVThisFrame = false;
+		pressedRThisFrame = false;
 	}
-	if (glfwGetKey(m_WindowPtr, GLFW_KEY_R) == GLFW_PRESS)
+	if (glfwGetKey(m_WindowPtr, GLFW_KEY_H) == GLFW_PRESS)
 	{
-		if (not pressedRThisFrame)
+		if (not pressedHThisFrame)
 		{
-			pressedRThisFrame = true;
-			m_InstancedScene3DUPtr->RemoveInstanceFromMesh(0, 0);
+			pressedHThisFrame = true;
+			//shows the instance hidden last time, or hides the first ferrari
+			if (m_InstancedSceneCompressed3DUPtr->IsInstanceHidden(m_HiddenInstanceHandle))
+			{
+				m_InstancedSceneCompressed3DUPtr->SetInstanceHidden(m_HiddenInstanceHandle, false);
+			}
+			else
+			{
+				m_HiddenInstanceHandle = m_InstancedSceneCompressed3DUPtr->GetInstanceHandle(0, 0);
+				m_InstancedSceneCompressed3DUPtr->SetInstanceHidden(m_HiddenInstanceHandle, true);
+			}
 		}
 	}
-	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_R) == GLFW_RELEASE)
+	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_H) == GLFW_RELEASE)
 	{
-		pressedRThisFrame = false;
+		pressedHThisFrame = false;
+	}
+	if (glfwGetKey(m_WindowPtr, GLFW_KEY_C) == GLFW_PRESS)
+	{
+		if (not pressedCThisFrame)
+		{
+			pressedCThisFrame = true;
+			switch (m_CullingMode)
+			{
+			case vkUtil::CullingMode::Gpu:
+				m_CullingMode = vkUtil::CullingMode::Cpu;
+				std::cout << "Frustum culling on the cpu (" << vkUtil::InstanceCuller::GetInstructionSetName() << ", " << ave::ThreadPool::GetInstance().GetThreadCount() << " threads)\n";
+				break;
+			case vkUtil::CullingMode::Cpu:
+				m_CullingMode = vkUtil::CullingMode::Disabled;
+				std::cout << "Frustum culling disabled\n";
+				break;
+			case vkUtil::CullingMode::Disabled:
+				m_CullingMode = vkUtil::CullingMode::Gpu;
+				std::cout << "Frustum culling on the gpu\n";
+				break;
+			}
+		}
+	}
+	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_C) == GLFW_RELEASE)
+	{
+		pressedCThisFrame = false;
 	}
-	if (glfwGetKey(m_WindowPtr, GLFW_KEY_T) == GLFW_PRESS)
+	if (glfwGetKey(m_WindowPtr, GLFW_KEY_M) == GLFW_PRESS)
 	{
-		if (not pressedTThisFrame)
+		if (not pressedMThisFrame)
 		{
-			pressedTThisFrame = true;
-			m_InstancedScene3DUPtr->RemoveInstanceFromMesh(1, 0);
+			pressedMThisFrame = true;
+			m_MultiDrawEnabled = not m_MultiDrawEnabled;
+			m_InstancedScene3DUPtr->SetMultiDrawEnabled(m_MultiDrawEnabled);
+			m_InstancedSceneCompressed3DUPtr->SetMultiDrawEnabled(m_MultiDrawEnabled);
+			std::cout << (m_MultiDrawEnabled ? "One multi draw for the whole scene\n" : "One draw per mesh\n");
 		}
 	}
-	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_T) == GLFW_RELEASE)
+	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_M) == GLFW_RELEASE)
+	{
+		pressedMThisFrame = false;
+	}
+	if (glfwGetKey(m_WindowPtr, GLFW_KEY_L) == GLFW_PRESS)
 	{
-		pressedTThisFrame = false;
+		if (not pressedLThisFrame)
+		{
+			pressedLThisFrame = true;
+			m_LodSettings.Enabled = not m_LodSettings.Enabled;
+			std::cout << (m_LodSettings.Enabled ? "Level of detail enabled\n" : "Level of detail disabled, every instance uses the full mesh\n");
+		}
 	}
+	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_L) == GLFW_RELEASE)
+	{
+		pressedLThisFrame = false;
+	}
+	if (glfwGetKey(m_WindowPtr, GLFW_KEY_G) == GLFW_PRESS)
+	{
+		if (not pressedGThisFrame)
+		{
+			pressedGThisFrame = true;
+			switch (m_TextureLoaderUPtr->GetFiltering())
+			{
+			case vkInit::TextureFiltering::Nearest:
+				m_TextureLoaderUPtr->SetFiltering(vkInit::TextureFiltering::Trilinear);
+				std::cout << "Trilinear texture filtering\n";
+				break;
+			case vkInit::TextureFiltering::Trilinear:
+				m_TextureLoaderUPtr->SetFiltering(vkInit::TextureFiltering::Anisotropic);
+				std::cout << "Anisotropic texture filtering\n";
+				break;
+			case vkInit::TextureFiltering::Anisotropic:
+				m_TextureLoaderUPtr->SetFiltering(vkInit::TextureFiltering::Nearest);
+				std::cout << "Nearest texture filtering on the full resolution level\n";
+				break;
+			}
+		}
+	}
+	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_G) == GLFW_RELEASE)
+	{
+		pressedGThisFrame = false;
+	}
+	if (glfwGetKey(m_WindowPtr, GLFW_KEY_K) == GLFW_PRESS)
+	{
+		if (not pressedKThisFrame)
+		{
+			pressedKThisFrame = true;
+			//primary only, then doubling the threads up to every thread of the pool
+			if (m_RecordingThreadCount == m_MaxRecordingThreadCount)
+			{
+				m_RecordingThreadCount = 0;
+				std::cout << "Draws recorded into the primary command buffer\n";
+			}
+			else
+			{
+				m_RecordingThreadCount = std::min(std::max(m_RecordingThreadCount * 2, 1), m_MaxRecordingThreadCount);
+				std::cout << "Draws recorded into secondary command buffers on " << m_RecordingThreadCount << " threads\n";
+			}
+		}
+	}
+	else if (glfwGetKey(m_WindowPtr, GLFW_KEY_K) == GLFW_RELEASE)
+	{
+		pressedKThisFrame = false;
+	}
+
+	//a lod is used from the distance on where its error covers about m_LodPixelError pixels
+	float const projectionScale{ m_CameraUPtr->GetProjectionScale(static_cast<float>(m_SwapchainExtent.height)) };
+	m_LodSettings.CameraPosition = m_CameraUPtr->GetCameraPosition();
+	m_LodSettings.DistanceScale = projectionScale / m_LodPixelError;
+
+	//the texture loader streams the levels in or out the next time it is updated
+	m_InstancedScene3DUPtr->RequestTextureResolutions(m_LodSettings.CameraPosition, projectionScale);
+	m_InstancedSceneCompressed3DUPtr->RequestTextureResolutions(m_LodSettings.CameraPosition, projectionScale);
+
+	//a reallocated buffer starts out empty and has to be bound again
+	if (frameContext.ResizeInstanceResources(GetInstanceCount(), m_MaxNrFramesInFlight))
+	{
+		m_InstancedScene3DUPtr->InvalidateFrame(m_CurrentFrameNr);
+		m_InstancedSceneCompressed3DUPtr->InvalidateFrame(m_CurrentFrameNr);
+	}
+	//the commands are written again below, a reallocated buffer has nothing to read back for the statistics
+	frameContext.ResizeDrawCommandResources(GetDrawCommandCount(), m_MaxNrFramesInFlight);
+
+	std::int64_t const firstCompressedInstance{ m_InstancedScene3DUPtr->GetInstanceCount() };
+	frameContext.UploadedInstanceBytes = m_InstancedScene3DUPtr->WriteWorldMatrices(m_CurrentFrameNr, frameContext.WBufferWriteLocationPtr, 0);
+	frameContext.UploadedInstanceBytes += m_InstancedSceneCompressed3DUPtr->WriteWorldMatrices(m_CurrentFrameNr, frameContext.WBufferWriteLocationPtr, firstCompressedInstance);
+	m_FrameStatistics.UploadedInstanceBytes = frameContext.UploadedInstanceBytes;
+
+	//the commands still hold what the culling pass wrote the last time this frame was rendered
+	m_FrameStatistics.VisibleInstances = frameContext.ReadVisibleInstanceCount();
+	m_FrameStatistics.TotalInstances = frameContext.CulledInstanceCount;
+	m_FrameStatistics.VisibleTriangles = frameContext.ReadVisibleTriangleCount();
+
+	m_FrameStatistics.InstanceCapacity = frameContext.InstanceCapacity;
+	m_FrameStatistics.InstanceBufferBytes = 0;
+	for (auto const& frame : m_FrameContextVec)
+	{
+		m_FrameStatistics.InstanceBufferBytes += frame.GetInstanceBufferBytes();
+	}
+	m_FrameStatistics.HostInstanceBytes = m_InstancedScene3DUPtr->GetHostInstanceBytes() + m_InstancedSceneCompressed3DUPtr->GetHostInstanceBytes();
+	m_FrameStatistics.TextureResidentBytes = m_TextureLoaderUPtr->GetResidentBytes();
+	m_FrameStatistics.TextureBudgetBytes = m_TextureLoaderUPtr->GetMemoryBudget();
+
+	m_FrameStatistics.DeviceLocalUsedBytes = 0;
+	m_FrameStatistics.DeviceLocalAllocatedBytes = 0;
+	for (auto const& heapStatistics : vkUtil::MemoryAllocator::GetInstance().GetHeapStatistics())
+	{
+		if (heapStatistics.Flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+		{
+			m_FrameStatistics.DeviceLocalUsedBytes += heapStatistics.UsedBytes;
+			m_FrameStatistics.DeviceLocalAllocatedBytes += heapStatistics.AllocatedBytes;
+		}
+	}
+
+	std::int64_t const firstCompressedDrawCommand{ m_InstancedScene3DUPtr->WriteDrawCommands(frameContext.DrawCommandWriteLocationPtr, frameContext.DrawDataWriteLocationPtr, 0, frameContext.InstanceCapacity) };
+	frameContext.DrawCommandCount = firstCompressedDrawCommand + m_InstancedSceneCompressed3DUPtr->WriteDrawCommands(frameContext.DrawCommandWriteLocationPtr + firstCompressedDrawCommand,
+		frameContext.DrawDataWriteLocationPtr + firstCompressedDrawCommand, firstCompressedInstance, frameContext.InstanceCapacity);
+	frameContext.CulledInstanceCount = GetInstanceCount();
 
-	int idx{};
-	for (auto const& worldMatrix : m_InstancedScene3DUPtr->GetWorldMatrices())
+	bool const cpuCulling{ m_CullingMode == vkUtil::CullingMode::Cpu };
+	if (frameContext.CpuCulling != cpuCulling)
+	{
+		frameContext.CpuCulling = cpuCulling;
+		frameContext.DescriptorSetDirty = true;
+	}
+	if (frameContext.CpuCulling)
 	{
-		swapchainFrame.WMatrixVec[idx++] = worldMatrix;
+		auto const cullStart{ std::chrono::high_resolution_clock::now() };
+		m_InstancedScene3DUPtr->CullInstances(frustumPlaneArr, m_LodSettings, frameContext.LodWriteLocationPtr, frameContext.InstanceCapacity,
+			frameContext.CpuVisibleWriteLocationPtr, frameContext.DrawCommandWriteLocationPtr, 0);
+		m_InstancedSceneCompressed3DUPtr->CullInstances(frustumPlaneArr, m_LodSettings, frameContext.LodWriteLocationPtr, frameContext.InstanceCapacity,
+			frameContext.CpuVisibleWriteLocationPtr, frameContext.DrawCommandWriteLocationPtr + firstCompressedDrawCommand, firstCompressedInstance);
+		m_FrameStatistics.CpuCullMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - cullStart).count();
 	}
-	memcpy(swapchainFrame.WBufferWriteLocationPtr, swapchainFrame.WMatrixVec.data(), idx * sizeof(glm::mat4));
 
-	swapchainFrame.WriteDescriptorSet();
+	if (frameContext.DescriptorSetDirty)
+	{
+		frameContext.WriteDescriptorSet();
+	}
 }
 
 void ave::VulkanEngine::CreateFrameBuffers()
@@ -409,17 +774,27 @@ void ave::VulkanEngine::CreateFrameBuffers()
 void ave::VulkanEngine::CreateFrameResources()
 {
 	vkInit::DescriptorSetLayoutData setLayoutData;
-	setLayoutData.Count = 1;
+	setLayoutData.Count = 6;
 	setLayoutData.TypeVec.emplace_back(vk::DescriptorType::eUniformBuffer);
-	m_DescriptorPoolFrame = vkInit::CreateDescriptorPool(m_Device, static_cast<uint32_t>(m_SwapchainFrameVec.size()), setLayoutData);
-
-	for (auto& frame : m_SwapchainFrameVec)
+	setLayoutData.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutData.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutData.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutData.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutData.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	m_DescriptorPoolFrame = vkInit::CreateDescriptorPool(m_Device, static_cast<uint32_t>(m_MaxNrFramesInFlight), setLayoutData);
+
+	m_FrameContextVec.resize(m_MaxNrFramesInFlight);
+	for (auto& frame : m_FrameContextVec)
 	{
+		frame.Device = m_Device;
+		frame.PhysicalDevice = m_PhysicalDevice;
 		frame.InFlightFence = vkInit::CreateFence(m_Device);
 		frame.SemaphoreImageAvailable = vkInit::CreateSemaphore(m_Device);
-		frame.SemaphoreRenderingFinished = vkInit::CreateSemaphore(m_Device);
 
-		frame.CreateDescriptorResources(100'000);
+		//the instance and draw command buffers start out at the size of the scene and grow with it
+		std::int64_t const nrInstances{ m_InstancedScene3DUPtr ? GetInstanceCount() : 0 };
+		std::int64_t const nrDrawCommands{ m_InstancedScene3DUPtr ? GetDrawCommandCount() : 0 };
+		frame.CreateDescriptorResources(nrInstances, nrDrawCommands);
 		frame.DescriptorSet = vkInit::CreateDescriptorSet(m_Device, m_DescriptorPoolFrame, m_DescriptorSetLayoutFrame);
 	}
 }
@@ -427,27 +802,48 @@ void ave::VulkanEngine::CreateFrameResources()
 void ave::VulkanEngine::CreateDescriptorSetLayouts()
 {
 	vkInit::DescriptorSetLayoutData setLayoutDataFrame;
-	setLayoutDataFrame.Count = 2;
+	setLayoutDataFrame.Count = 6;
 	setLayoutDataFrame.IndexVec.emplace_back(0);
 	setLayoutDataFrame.TypeVec.emplace_back(vk::DescriptorType::eUniformBuffer);
 	setLayoutDataFrame.CountVec.emplace_back(1);
-	setLayoutDataFrame.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eVertex);
+	setLayoutDataFrame.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eCompute);
 
 	setLayoutDataFrame.IndexVec.emplace_back(1);
 	setLayoutDataFrame.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
 	setLayoutDataFrame.CountVec.emplace_back(1);
+	setLayoutDataFrame.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eCompute);
+
+	//visible instance indices written by the culling pass
+	setLayoutDataFrame.IndexVec.emplace_back(2);
+	setLayoutDataFrame.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutDataFrame.CountVec.emplace_back(1);
+	setLayoutDataFrame.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eCompute);
+
+	//indirect draw commands, the culling pass fills in the instance counts
+	setLayoutDataFrame.IndexVec.emplace_back(3);
+	setLayoutDataFrame.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutDataFrame.CountVec.emplace_back(1);
+	setLayoutDataFrame.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eCompute);
+
+	//per draw data, indexed with gl_DrawID
+	setLayoutDataFrame.IndexVec.emplace_back(4);
+	setLayoutDataFrame.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutDataFrame.CountVec.emplace_back(1);
 	setLayoutDataFrame.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eVertex);
 
-	m_DescriptorSetLayoutFrame = vkInit::CreateDescriptorSetLayout(m_Device, setLayoutDataFrame);
+	//lod every instance was selected for, the culling pass starts its hysteresis from it
+	setLayoutDataFrame.IndexVec.emplace_back(5);
+	setLayoutDataFrame.TypeVec.emplace_back(vk::DescriptorType::eStorageBuffer);
+	setLayoutDataFrame.CountVec.emplace_back(1);
+	setLayoutDataFrame.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eCompute);
 
-	vkInit::DescriptorSetLayoutData setLayoutDataMesh;
-	setLayoutDataMesh.Count = 1;
-	setLayoutDataMesh.IndexVec.emplace_back(0);
-	setLayoutDataMesh.TypeVec.emplace_back(vk::DescriptorType::eCombinedImageSampler);
-	setLayoutDataMesh.CountVec.emplace_back(1);
-	setLayoutDataMesh.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eFragment);
+	m_DescriptorSetLayoutFrame = vkInit::CreateDescriptorSetLayout(m_Device, setLayoutDataFrame);
 
-	m_DescriptorSetLayoutMesh = vkInit::CreateDescriptorSetLayout(m_Device, setLayoutDataMesh);
+	vkInit::BindlessTextureSetInBundle textureSetIn{};
+	textureSetIn.Device = m_Device;
+	textureSetIn.PhysicalDevice = m_PhysicalDevice;
+	textureSetIn.RequestedCapacity = m_MaxNrTextures;
+	m_TextureSetUPtr = std::make_unique<vkInit::BindlessTextureSet>(textureSetIn);
 }
 
 void ave::VulkanEngine::RecordDrawCommands(const vk::CommandBuffer& commandBuffer, uint32_t imageIndex)
@@ -462,16 +858,80 @@ void ave::VulkanEngine::RecordDrawCommands(const vk::CommandBuffer& commandBuffe
 		std::cout << systemError.what() << "\n";
 	}
 
-	m_RenderPassUPtr->BeginRenderPass(commandBuffer, m_SwapchainFrameVec[imageIndex].Framebuffer, m_SwapchainExtent);
-	
-	std::int64_t drawnInstances{};
+	uint32_t const firstTimestamp{ TimestampsPerFrame * static_cast<uint32_t>(m_CurrentFrameNr) };
+	if (m_TimestampQueryPool)
+	{
+		commandBuffer.resetQueryPool(m_TimestampQueryPool, firstTimestamp, TimestampsPerFrame);
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_TimestampQueryPool, firstTimestamp);
+		m_TimestampsWrittenVec[m_CurrentFrameNr] = true;
+	}
+
+	//uploads that finished on the transfer queue are handed over to this queue before anything reads them
+	m_UploadWaitTicket = m_UploadContextUPtr->RecordAcquireBarriers(commandBuffer);
+
+	auto const& frameContext{ m_FrameContextVec[m_CurrentFrameNr] };
+	//the frame renders into the image it acquired, only the framebuffer depends on it
+	vk::Framebuffer const& framebuffer{ m_SwapchainFrameVec[imageIndex].Framebuffer };
+
+	//same layout of the frame buffers as PrepareFrame wrote
+	std::int64_t const firstCompressedInstance{ m_InstancedScene3DUPtr->GetInstanceCount() };
+	std::int64_t const firstCompressedDrawCommand{ m_InstancedScene3DUPtr->GetDrawCommandCount() };
+
+	//the cpu culler already filled the visible indices and the instance counts while preparing the frame
+	if (not frameContext.CpuCulling)
+	{
+		bool const cullingEnabled{ m_CullingMode == vkUtil::CullingMode::Gpu };
+		m_CullPipelineUPtr->Record(commandBuffer, frameContext.DescriptorSet);
+		m_InstancedScene3DUPtr->RecordCulling(commandBuffer, m_CullPipelineUPtr->GetPipelineLayout(), 0, 0, frameContext.InstanceCapacity,
+			cullingEnabled, m_LodSettings);
+		m_InstancedSceneCompressed3DUPtr->RecordCulling(commandBuffer, m_CullPipelineUPtr->GetPipelineLayout(), firstCompressedInstance, firstCompressedDrawCommand, frameContext.InstanceCapacity,
+			cullingEnabled, m_LodSettings);
+
+		//the draws read what culling wrote, the host reads the instance counts back once the frame fence is signaled
+		vk::MemoryBarrier cullBarrier{};
+		cullBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+		cullBarrier.dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead;
+		commandBuffer.pipelineBarrier
+		(
+			vk::PipelineStageFlagBits::eComputeShader,
+			vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eHost,
+			vk::DependencyFlags{},
+			cullBarrier,
+			nullptr,
+			nullptr
+		);
+	}
+
+	if (m_TimestampQueryPool)
+	{
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_TimestampQueryPool, firstTimestamp + 1);
+	}
+
+	std::chrono::high_resolution_clock::time_point const recordStartTimePoint{ std::chrono::high_resolution_clock::now() };
 
-	m_Pipeline3DUPtr->Record(commandBuffer, m_SwapchainFrameVec[imageIndex].Framebuffer, m_SwapchainExtent, m_SwapchainFrameVec[imageIndex].DescriptorSet);
+	int recordingThreads{};
+	if (m_RecordingThreadCount == 0)
+	{
+		m_RenderPassUPtr->BeginRenderPass(commandBuffer, framebuffer, m_SwapchainExtent);
+		RecordDraws(commandBuffer, frameContext, framebuffer, 0, m_InstancedScene3DUPtr->GetMeshCount() + m_InstancedSceneCompressed3DUPtr->GetMeshCount());
+	}
+	else
+	{
+		m_RenderPassUPtr->BeginRenderPass(commandBuffer, framebuffer, m_SwapchainExtent, vk::SubpassContents::eSecondaryCommandBuffers);
+		recordingThreads = RecordSecondaryDraws(commandBuffer, frameContext, framebuffer);
+	}
 
-	drawnInstances += m_InstancedScene3DUPtr->Draw(commandBuffer, m_Pipeline3DUPtr->GetPipelineLayout(), drawnInstances);
+	std::chrono::duration<double, std::milli> const recordTime{ std::chrono::high_resolution_clock::now() - recordStartTimePoint };
+	m_FrameStatistics.RecordMilliseconds = recordTime.count();
+	m_FrameStatistics.RecordingThreads = recordingThreads;
 
 	m_RenderPassUPtr->EndRenderPass(commandBuffer);
 
+	if (m_TimestampQueryPool)
+	{
+		commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_TimestampQueryPool, firstTimestamp + 2);
+	}
+
 	try
 	{
 		commandBuffer.end();
@@ -482,6 +942,65 @@ void ave::VulkanEngine::RecordDrawCommands(const vk::CommandBuffer& commandBuffe
 	}
 }
 
+void ave::VulkanEngine::RecordDraws(const vk::CommandBuffer& commandBuffer, vkUtil::FrameContext const& frameContext, vk::Framebuffer const& framebuffer, int firstMesh, int endMesh)
+{
+	int const meshCount3D{ m_InstancedScene3DUPtr->GetMeshCount() };
+	if (firstMesh < std::min(endMesh, meshCount3D))
+	{
+		m_Pipeline3DUPtr->Record(commandBuffer, framebuffer, m_SwapchainExtent, frameContext.DescriptorSet);
+		commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_Pipeline3DUPtr->GetPipelineLayout(), 1, m_TextureSetUPtr->GetDescriptorSet(), nullptr);
+
+		m_InstancedScene3DUPtr->DrawMeshes(commandBuffer, m_Pipeline3DUPtr->GetPipelineLayout(), frameContext.DrawCommandBuffer.Buffer, 0, firstMesh, std::min(endMesh, meshCount3D));
+	}
+
+	if (std::max(firstMesh, meshCount3D) < endMesh)
+	{
+		m_PipelineCompressed3DUPtr->Record(commandBuffer, framebuffer, m_SwapchainExtent, frameContext.DescriptorSet);
+		commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_PipelineCompressed3DUPtr->GetPipelineLayout(), 1, m_TextureSetUPtr->GetDescriptorSet(), nullptr);
+
+		m_InstancedSceneCompressed3DUPtr->DrawMeshes(commandBuffer, m_PipelineCompressed3DUPtr->GetPipelineLayout(), frameContext.DrawCommandBuffer.Buffer, m_InstancedScene3DUPtr->GetDrawCommandCount(),
+			std::max(firstMesh - meshCount3D, 0), endMesh - meshCount3D);
+	}
+}
+
+int ave::VulkanEngine::RecordSecondaryDraws(const vk::CommandBuffer& commandBuffer, vkUtil::FrameContext const& frameContext, vk::Framebuffer const& framebuffer)
+{
+	int const meshCount{ m_InstancedScene3DUPtr->GetMeshCount() + m_InstancedSceneCompressed3DUPtr->GetMeshCount() };
+	int const batchCount{ std::min({ m_RecordingThreadCount, std::max(meshCount, 1), static_cast<int>(frameContext.SecondaryCommandBufferVec.size()) }) };
+
+	vk::CommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.renderPass = m_RenderPassUPtr->GetRenderPass();
+	inheritanceInfo.subpass = 0;
+	inheritanceInfo.framebuffer = framebuffer;
+
+	vk::CommandBufferBeginInfo bufferBeginInfo{};
+	bufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+	bufferBeginInfo.pInheritanceInfo = &inheritanceInfo;
+
+	//a chunk is one batch, the batch index picks the pool so no pool is ever recorded from by two threads at once
+	ave::ThreadPool::GetInstance().ParallelFor(batchCount, 1,
+		[&](std::int64_t begin, std::int64_t end)
+		{
+			for (std::int64_t batchIdx{ begin }; batchIdx < end; ++batchIdx)
+			{
+				vk::CommandBuffer const& secondaryCommandBuffer{ frameContext.SecondaryCommandBufferVec[batchIdx] };
+				try
+				{
+					secondaryCommandBuffer.begin(bufferBeginInfo);
+					RecordDraws(secondaryCommandBuffer, frameContext, framebuffer, static_cast<int>(meshCount * batchIdx / batchCount), static_cast<int>(meshCount * (batchIdx + 1) / batchCount));
+					secondaryCommandBuffer.end();
+				}
+				catch (const vk::SystemError& systemError)
+				{
+					std::cout << systemError.what() << "\n";
+				}
+			}
+		});
+
+	commandBuffer.executeCommands(static_cast<uint32_t>(batchCount), frameContext.SecondaryCommandBufferVec.data());
+	return batchCount;
+}
+
 void ave::VulkanEngine::RecreateSwapchain()
 {
 	m_Width = 0;
@@ -494,18 +1013,10 @@ void ave::VulkanEngine::RecreateSwapchain()
 
 	m_Device.waitIdle();
 
+	//the frames in flight do not depend on the swapchain, their buffers, command buffers and timestamps are kept
 	DestroySwapchain();
 	CreateSwapchain();
 	CreateFrameBuffers();
-	CreateFrameResources();
-
-	vkInit::CommandBufferInBundle commandBufferIn
-	{
-		m_Device,
-		m_CommandPool,
-		m_SwapchainFrameVec
-	};
-	vkInit::CreateFrameCommandBuffers(commandBufferIn);
 }
 
 void ave::VulkanEngine::DestroySwapchain()
@@ -514,7 +1025,6 @@ void ave::VulkanEngine::DestroySwapchain()
 	{
 		frame.Destroy();
 	}
-	m_Device.destroyDescriptorPool(m_DescriptorPoolFrame);	
 
 	m_Device.destroySwapchainKHR(m_Swapchain);
 }
@@ -528,12 +1038,19 @@ void ave::VulkanEngine::PrintKeyBindings()
 	std::cout << "-------------------------------------------------------" << std::endl;
 	std::cout << "| F                    | Add an instance to the       |" << std::endl;
 	std::cout << "|                      | ferrari mesh                 |" << std::endl;
-	std::cout << "| V                    | Add an instance to the       |" << std::endl;
-	std::cout << "|                      | spaceship mesh               |" << std::endl;
 	std::cout << "| R                    | Remove an instance from the  |" << std::endl;
 	std::cout << "|                      | ferrari mesh                 |" << std::endl;
-	std::cout << "| T                    | Remove an instance from the  |" << std::endl;
-	std::cout << "|                      | spaceship mesh               |" << std::endl;
+	std::cout << "| H                    | Hide / show an instance of   |" << std::endl;
+	std::cout << "|                      | the ferrari mesh             |" << std::endl;
+	std::cout << "| C                    | Cycle frustum culling: gpu,  |" << std::endl;
+	std::cout << "|                      | cpu, disabled                |" << std::endl;
+	std::cout << "| M                    | Toggle one multi draw for    |" << std::endl;
+	std::cout << "|                      | the scene / draw per mesh    |" << std::endl;
+	std::cout << "| L                    | Toggle level of detail       |" << std::endl;
+	std::cout << "| G                    | Cycle texture filtering:     |" << std::endl;
+	std::cout << "|                      | nearest, trilinear, aniso    |" << std::endl;
+	std::cout << "| K                    | Cycle draw recording: one    |" << std::endl;
+	std::cout << "|                      | buffer, 1, 2, 4... threads   |" << std::endl;
 	std::cout << "| LEFT SHIFT           | Increase translation speed   |" << std::endl;
 	std::cout << "|                      | by 5x                        |" << std::endl;
 	std::cout << "| W or UP              | Move forward                 |" << std::endl;
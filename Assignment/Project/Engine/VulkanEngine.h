@@ -6,9 +6,13 @@
 #include "Utils/Camera.h"
 #include "Pipeline/Pipeline.h"
 #include "Pipeline/RenderPass.h"
+#include "Pipeline/ComputePipeline.h"
 #include "Rendering/InstancedMesh.h"
 #include "Utils/FileReader.h"
 #include "Rendering/InstancedScene.h"
+#include "Rendering/UploadContext.h"
+#include "Pipeline/BindlessTextureSet.h"
+#include "Rendering/TextureLoader.h"
 
 namespace ave
 {
@@ -25,6 +29,8 @@ namespace ave
 		VulkanEngine& operator=(VulkanEngine&& other) = delete;
 	
 		void Render();
+
+		vkUtil::FrameStatistics const& GetFrameStatistics() const;
 	private:
 	
 		const std::string m_WindowName{ "GP2 Assignment" };
@@ -41,7 +47,10 @@ namespace ave
 		vk::Device m_Device{ nullptr };
 		vk::Queue m_GraphicsQueue{ nullptr };
 		vk::Queue m_PresentQueue{ nullptr };
+		//the graphics queue when the device has no separate transfer family
+		vk::Queue m_TransferQueue{ nullptr };
 		vk::SwapchainKHR m_Swapchain{ nullptr };
+		//indexed by the image index of the swapchain
 		std::vector<vkUtil::SwapchainFrame> m_SwapchainFrameVec; 
 		vk::Extent2D m_SwapchainExtent;
 		vk::Format m_SwapchainFormat;
@@ -49,23 +58,67 @@ namespace ave
 		vk::DescriptorSetLayout m_DescriptorSetLayoutFrame;
 		vk::DescriptorPool m_DescriptorPoolFrame;
 	
-		vk::DescriptorSetLayout m_DescriptorSetLayoutMesh;
-		vk::DescriptorPool m_DescriptorPoolMesh;
-		uint32_t m_NumberOfTextures{ 10 };
+		//the textures of every mesh in one bindless sampler array, set 1 of the 3d pipeline
+		std::unique_ptr<vkInit::BindlessTextureSet> m_TextureSetUPtr{ nullptr };
+		uint32_t m_MaxNrTextures{ 4096 };
+		//texture levels nobody is close enough to see are dropped before this is exceeded, the smallest levels always stay
+		vk::DeviceSize m_TextureMemoryBudget{ 256ull * 1024 * 1024 };
 
 		std::unique_ptr<vkInit::RenderPass> m_RenderPassUPtr;
 		std::unique_ptr<vkInit::Pipeline<vkUtil::Vertex3D>> m_Pipeline3DUPtr;
+		std::unique_ptr<vkInit::Pipeline<vkUtil::CompressedVertex3D>> m_PipelineCompressed3DUPtr;
+		std::unique_ptr<vkInit::ComputePipeline> m_CullPipelineUPtr;
+		vkUtil::CullingMode m_CullingMode{ vkUtil::CullingMode::Gpu };
+		bool m_MultiDrawEnabled{ true };
+		//toggled by the l key, the camera and the distance scale are updated every frame
+		vkUtil::LodSettings m_LodSettings{};
+		//how many pixels the error of a lod may cover on screen before a finer lod is used
+		float m_LodPixelError{ 4.f };
+
+		//vertices and indices of every 3d mesh, one pool per vertex format
+		std::unique_ptr<ave::GeometryPool<vkUtil::Vertex3D>> m_GeometryPool3DUPtr{ nullptr };
+		std::unique_ptr<ave::GeometryPool<vkUtil::CompressedVertex3D>> m_GeometryPoolCompressed3DUPtr{ nullptr };
+		uint32_t m_GeometryPoolVertexCapacity{ 1 << 20 };
+		uint32_t m_GeometryPoolIndexCapacity{ 1 << 22 };
 
+		//the vertex format is picked per mesh, each format has its own scene that is drawn with its own pipeline
+		//the instances and draw commands of the compressed scene follow those of the other one in the frame buffers
 		std::unique_ptr <ave::InstancedScene<vkUtil::Vertex3D>> m_InstancedScene3DUPtr{ nullptr };
+		std::unique_ptr <ave::InstancedScene<vkUtil::CompressedVertex3D>> m_InstancedSceneCompressed3DUPtr{ nullptr };
+		//toggled by the h key
+		ave::InstanceHandle m_HiddenInstanceHandle{};
 
 		vk::CommandPool m_CommandPool;
-		vk::CommandBuffer m_MainCommandBuffer;
+		//the draws of the render pass are split in this many batches of meshes, each recorded into a secondary command buffer on the thread pool
+		//0 records them into the primary command buffer, cycled by the k key up to the thread count of the pool
+		int m_RecordingThreadCount{};
+		int m_MaxRecordingThreadCount{ 1 };
+
+		//geometry and texture uploads are batched here and submitted once per scene load
+		std::unique_ptr<vkUtil::UploadContext> m_UploadContextUPtr{ nullptr };
+		//the upload ticket the frame being recorded acquired its resources from
+		vkUtil::UploadTicket m_UploadWaitTicket{ 0 };
+		//textures are decoded in the background and uploaded once per frame, meshes show a placeholder until then
+		std::unique_ptr<vkInit::TextureLoader> m_TextureLoaderUPtr{ nullptr };
 
-		int m_MaxNrFramesInFlight;
-		int m_CurrentFrameNr;
+		//the frame the cpu prepares while the gpu renders the ones before it, indexed by the frame number
+		//every buffer the cpu writes per frame exists this many times, no matter how many images the swapchain has
+		std::vector<vkUtil::FrameContext> m_FrameContextVec;
+		int m_MaxNrFramesInFlight{ 2 };
+		int m_CurrentFrameNr{};
+
+		//start, end of culling and end of the render pass of every frame in flight, indexed by the frame number like the fences
+		static constexpr uint32_t TimestampsPerFrame{ 3 };
+		//null when the graphics queue can not write timestamps
+		vk::QueryPool m_TimestampQueryPool{ nullptr };
+		//nanoseconds per timestamp tick
+		float m_TimestampPeriod{};
+		std::vector<bool> m_TimestampsWrittenVec;
 
 		std::unique_ptr<ave::Camera> m_CameraUPtr;
 
+		vkUtil::FrameStatistics m_FrameStatistics{};
+
 		void CreateInstance();
 		void CreateDevice();
 		void CreateSwapchain();
@@ -75,9 +128,24 @@ namespace ave
 		void CreatePipelines();
 		void SetUpRendering();
 		void Create3DScene();
+		//instances of both scenes together
+		std::int64_t GetInstanceCount() const;
+		//one indirect draw command per lod of every mesh of both scenes
+		std::int64_t GetDrawCommandCount() const;
+
+		//one set of timestamps per frame in flight, has to be called again when that count changes
+		void CreateTimestampQueries();
+		//has to be called after waiting for the fence of the frame
+		void ReadTimestamps(int frameNr);
 
-		void PrepareFrame(uint32_t imgIdx);
+		void PrepareFrame();
 		void RecordDrawCommands(const vk::CommandBuffer& commandBuffer, uint32_t imageIndex);
+		//the meshes of both scenes are numbered one after the other, the compressed ones follow the others
+		//binds everything it draws with, so it can start a secondary command buffer
+		void RecordDraws(const vk::CommandBuffer& commandBuffer, vkUtil::FrameContext const& frameContext, vk::Framebuffer const& framebuffer, int firstMesh, int endMesh);
+		//records the batches into the secondary command buffers of the frame in parallel and executes them from the primary one
+		//returns the number of batches, fewer than the recording threads when there are fewer meshes
+		int RecordSecondaryDraws(const vk::CommandBuffer& commandBuffer, vkUtil::FrameContext const& frameContext, vk::Framebuffer const& framebuffer);
 
 		void RecreateSwapchain();
 		void DestroySwapchain();
@@ -0,0 +1,98 @@
+#include "BindlessTextureSet.h"
+#include "Descriptor.h"
+
+vkInit::BindlessTextureSet::BindlessTextureSet(BindlessTextureSetInBundle const& in)
+	: m_Device{ in.Device }
+{
+	vk::PhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+	vk::PhysicalDeviceProperties2 properties{};
+	properties.pNext = &indexingProperties;
+	in.PhysicalDevice.getProperties2(&properties);
+
+	m_Capacity = std::min({ in.RequestedCapacity,
+		indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+		indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers });
+
+	DescriptorSetLayoutData layoutData{};
+	layoutData.Count = 1;
+	layoutData.IndexVec.emplace_back(0);
+	layoutData.TypeVec.emplace_back(vk::DescriptorType::eCombinedImageSampler);
+	layoutData.CountVec.emplace_back(static_cast<int>(m_Capacity));
+	layoutData.StageFlagVec.emplace_back(vk::ShaderStageFlagBits::eFragment);
+	//textures can be added while frames using the set are in flight, unused slots never have to be written
+	layoutData.BindingFlagVec.emplace_back(vk::DescriptorBindingFlagBits::ePartiallyBound
+		| vk::DescriptorBindingFlagBits::eUpdateAfterBind
+		| vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending
+		| vk::DescriptorBindingFlagBits::eVariableDescriptorCount);
+	layoutData.LayoutFlags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+
+	m_DescriptorSetLayout = CreateDescriptorSetLayout(m_Device, layoutData);
+	m_DescriptorPool = CreateDescriptorPool(m_Device, m_Capacity, layoutData, vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
+	m_DescriptorSet = CreateDescriptorSet(m_Device, m_DescriptorPool, m_DescriptorSetLayout, m_Capacity);
+
+	//lowest slots are handed out first
+	m_FreeSlotVec.resize(m_Capacity);
+	for (uint32_t slot{}; slot < m_Capacity; ++slot)
+	{
+		m_FreeSlotVec[slot] = m_Capacity - 1 - slot;
+	}
+
+	std::cout << "Bindless texture set with " << m_Capacity << " slots\n";
+}
+
+vkInit::BindlessTextureSet::~BindlessTextureSet()
+{
+	m_Device.destroyDescriptorPool(m_DescriptorPool);
+	m_Device.destroyDescriptorSetLayout(m_DescriptorSetLayout);
+}
+
+std::optional<uint32_t> vkInit::BindlessTextureSet::Register(vk::DescriptorImageInfo const& imageInfo)
+{
+	if (m_FreeSlotVec.empty())
+	{
+		std::cout << "Bindless texture set is full\n";
+		return std::nullopt;
+	}
+
+	uint32_t const slot{ m_FreeSlotVec.back() };
+	m_FreeSlotVec.pop_back();
+
+	vk::WriteDescriptorSet writeInfo{};
+	writeInfo.dstSet = m_DescriptorSet;
+	writeInfo.dstBinding = 0;
+	writeInfo.dstArrayElement = slot;
+	writeInfo.descriptorCount = 1;
+	writeInfo.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+	writeInfo.pImageInfo = &imageInfo;
+
+	m_Device.updateDescriptorSets(writeInfo, nullptr);
+
+	return slot;
+}
+
+void vkInit::BindlessTextureSet::Release(uint32_t slot)
+{
+	m_FreeSlotVec.emplace_back(slot);
+}
+
+vk::DescriptorSetLayout const& vkInit::BindlessTextureSet::GetDescriptorSetLayout() const
+{
+	return m_DescriptorSetLayout;
+}
+
+vk::DescriptorSet const& vkInit::BindlessTextureSet::GetDescriptorSet() const
+{
+	return m_DescriptorSet;
+}
+
+uint32_t vkInit::BindlessTextureSet::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+uint32_t vkInit::BindlessTextureSet::GetRegisteredCount() const
+{
+	return m_Capacity - static_cast<uint32_t>(m_FreeSlotVec.size());
+}
@@ -0,0 +1,52 @@
+#ifndef VK_BINDLESS_TEXTURE_SET_H
+#define VK_BINDLESS_TEXTURE_SET_H
+#include "Engine/Configuration.h"
+
+namespace vkInit
+{
+
+	struct BindlessTextureSetInBundle
+	{
+		vk::Device Device;
+		vk::PhysicalDevice PhysicalDevice;
+		//clamped to what the device supports for update after bind samplers
+		uint32_t RequestedCapacity{ 4096 };
+	};
+
+	//one descriptor set with a single sampler2D[] that stays bound for the whole frame, every texture gets a slot in it
+	//the set is partially bound, so only slots that are handed out have to hold a valid texture
+	class BindlessTextureSet final
+	{
+	public:
+		BindlessTextureSet(BindlessTextureSetInBundle const& in);
+		~BindlessTextureSet();
+
+		BindlessTextureSet(BindlessTextureSet const& other) = delete;
+		BindlessTextureSet(BindlessTextureSet&& other) = delete;
+		BindlessTextureSet& operator=(BindlessTextureSet const& other) = delete;
+		BindlessTextureSet& operator=(BindlessTextureSet&& other) = delete;
+
+		//writes the texture into a free slot and returns the slot, nullopt when every slot is taken
+		std::optional<uint32_t> Register(vk::DescriptorImageInfo const& imageInfo);
+
+		//the slot keeps its descriptor until it is handed out again
+		void Release(uint32_t slot);
+
+		vk::DescriptorSetLayout const& GetDescriptorSetLayout() const;
+		vk::DescriptorSet const& GetDescriptorSet() const;
+		uint32_t GetCapacity() const;
+		uint32_t GetRegisteredCount() const;
+	private:
+		vk::Device m_Device;
+
+		uint32_t m_Capacity;
+		vk::DescriptorSetLayout m_DescriptorSetLayout;
+		vk::DescriptorPool m_DescriptorPool;
+		vk::DescriptorSet m_DescriptorSet;
+
+		std::vector<uint32_t> m_FreeSlotVec;
+	};
+
+}
+
+#endif
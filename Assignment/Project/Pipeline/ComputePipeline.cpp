@@ -0,0 +1,105 @@
+#include "ComputePipeline.h"
+#include "PipelineCache.h"
+#include "Utils/Hash.h"
+
+vkInit::ComputePipeline::ComputePipeline(ComputePipelineInBundle const& in)
+	: m_Device{ in.Device }
+	, m_StateHash{ HashState(in) }
+{
+	if (std::optional<CachedPipeline> const cachedPipeline{ PipelineCache::GetInstance().Acquire(m_StateHash) })
+	{
+		m_PipelineLayout = cachedPipeline->Layout;
+		m_Pipeline = cachedPipeline->Pipeline;
+		return;
+	}
+
+	m_PipelineLayout = CreatePipelineLayout(in);
+	m_Pipeline = CreatePipeline(in);
+
+	PipelineCache::GetInstance().Insert(m_StateHash, CachedPipeline{ m_PipelineLayout, m_Pipeline });
+}
+
+vkInit::ComputePipeline::~ComputePipeline()
+{
+	PipelineCache::GetInstance().Release(m_StateHash);
+}
+
+void vkInit::ComputePipeline::Record(vk::CommandBuffer const& commandBuffer, vk::DescriptorSet const& descriptorSet)
+{
+	commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, m_Pipeline);
+
+	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_PipelineLayout, 0, descriptorSet, nullptr);
+}
+
+vk::PipelineLayout const& vkInit::ComputePipeline::GetPipelineLayout() const
+{
+	return m_PipelineLayout;
+}
+
+std::uint64_t vkInit::ComputePipeline::HashState(ComputePipelineInBundle const& in)
+{
+	std::uint64_t hash{ vkUtil::HashString(in.ComputeFilePath) };
+	hash = vkUtil::HashBytes(in.DescriptorSetLayoutVec.data(), in.DescriptorSetLayoutVec.size() * sizeof(vk::DescriptorSetLayout), hash);
+	return vkUtil::HashBytes(&in.PushConstantSize, sizeof(uint32_t), hash);
+}
+
+vk::PipelineLayout vkInit::ComputePipeline::CreatePipelineLayout(ComputePipelineInBundle const& in)
+{
+	vk::PushConstantRange pushConstantRange{};
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = in.PushConstantSize;
+	pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+
+	vk::PipelineLayoutCreateInfo layoutCreateInfo{};
+	layoutCreateInfo.flags = vk::PipelineLayoutCreateFlags{};
+	layoutCreateInfo.setLayoutCount = static_cast<uint32_t>(in.DescriptorSetLayoutVec.size());
+	layoutCreateInfo.pSetLayouts = in.DescriptorSetLayoutVec.data();
+	layoutCreateInfo.pushConstantRangeCount = in.PushConstantSize > 0 ? 1 : 0;
+	layoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+	try
+	{
+		return in.Device.createPipelineLayout(layoutCreateInfo);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+
+		return nullptr;
+	}
+}
+
+vk::Pipeline vkInit::ComputePipeline::CreatePipeline(ComputePipelineInBundle const& in)
+{
+	std::cout << "\nCompute pipeline creation started\n";
+
+	vk::ShaderModule computeShaderModule{ vkUtil::CreateModule(in.Device, in.ComputeFilePath) };
+
+	vk::PipelineShaderStageCreateInfo shaderStageCreateInfo{};
+	shaderStageCreateInfo.flags = vk::PipelineShaderStageCreateFlags{};
+	shaderStageCreateInfo.stage = vk::ShaderStageFlagBits::eCompute;
+	shaderStageCreateInfo.module = computeShaderModule;
+	shaderStageCreateInfo.pName = "main";
+
+	vk::ComputePipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.flags = vk::PipelineCreateFlags{};
+	pipelineCreateInfo.stage = shaderStageCreateInfo;
+	pipelineCreateInfo.layout = m_PipelineLayout;
+	pipelineCreateInfo.basePipelineHandle = nullptr;
+
+	vk::Pipeline pipeline{};
+
+	try
+	{
+		pipeline = in.Device.createComputePipeline(PipelineCache::GetInstance().GetCache(), pipelineCreateInfo).value;
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+	}
+
+	std::cout << "Compute pipeline creation ended\n";
+
+	in.Device.destroyShaderModule(computeShaderModule);
+	return pipeline;
+}
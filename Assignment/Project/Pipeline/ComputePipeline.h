@@ -0,0 +1,45 @@
+#ifndef VK_COMPUTE_PIPELINE_H
+#define VK_COMPUTE_PIPELINE_H
+#include "Engine/Configuration.h"
+#include "Shader.h"
+
+namespace vkInit
+{
+
+	struct ComputePipelineInBundle
+	{
+		vk::Device Device;
+		std::string ComputeFilePath;
+		std::vector<vk::DescriptorSetLayout> DescriptorSetLayoutVec;
+		uint32_t PushConstantSize{ 0 };
+	};
+
+	class ComputePipeline final
+	{
+	public:
+		ComputePipeline(ComputePipelineInBundle const& in);
+		~ComputePipeline();
+
+		ComputePipeline(ComputePipeline const& other) = delete;
+		ComputePipeline(ComputePipeline&& other) = delete;
+		ComputePipeline& operator=(ComputePipeline const& other) = delete;
+		ComputePipeline& operator=(ComputePipeline&& other) = delete;
+
+		void Record(vk::CommandBuffer const& commandBuffer, vk::DescriptorSet const& descriptorSet);
+
+		vk::PipelineLayout const& GetPipelineLayout() const;
+	private:
+		vk::PipelineLayout m_PipelineLayout;
+		vk::Pipeline m_Pipeline;
+
+		vk::Device m_Device;
+		std::uint64_t m_StateHash;
+
+		static std::uint64_t HashState(ComputePipelineInBundle const& in);
+		vk::PipelineLayout CreatePipelineLayout(ComputePipelineInBundle const& in);
+		vk::Pipeline CreatePipeline(ComputePipelineInBundle const& in);
+	};
+
+}
+
+#endif
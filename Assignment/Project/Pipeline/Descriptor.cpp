@@ -17,10 +17,18 @@ vk::DescriptorSetLayout vkInit::CreateDescriptorSetLayout(const vk::Device& devi
 	}
 
 	vk::DescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
-	setLayoutCreateInfo.flags = vk::DescriptorSetLayoutCreateFlags{};
+	setLayoutCreateInfo.flags = layoutData.LayoutFlags;
 	setLayoutCreateInfo.bindingCount = layoutData.Count;
 	setLayoutCreateInfo.pBindings = layoutBindingVec.data();
 
+	vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo{};
+	if (not layoutData.BindingFlagVec.empty())
+	{
+		bindingFlagsCreateInfo.bindingCount = static_cast<uint32_t>(layoutData.BindingFlagVec.size());
+		bindingFlagsCreateInfo.pBindingFlags = layoutData.BindingFlagVec.data();
+		setLayoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+	}
+
 	try
 	{
 		return device.createDescriptorSetLayout(setLayoutCreateInfo);
@@ -33,7 +41,7 @@ vk::DescriptorSetLayout vkInit::CreateDescriptorSetLayout(const vk::Device& devi
 	}
 }
 
-vk::DescriptorPool vkInit::CreateDescriptorPool(const vk::Device& device, uint32_t size, const DescriptorSetLayoutData& layoutData)
+vk::DescriptorPool vkInit::CreateDescriptorPool(const vk::Device& device, uint32_t size, const DescriptorSetLayoutData& layoutData, vk::DescriptorPoolCreateFlags poolFlags)
 {
 	std::vector<vk::DescriptorPoolSize> poolSizeVec;
 
@@ -46,7 +54,7 @@ vk::DescriptorPool vkInit::CreateDescriptorPool(const vk::Device& device, uint32
 	}
 
 	vk::DescriptorPoolCreateInfo poolCreateInfo{};
-	poolCreateInfo.flags = vk::DescriptorPoolCreateFlags{};
+	poolCreateInfo.flags = poolFlags;
 	poolCreateInfo.maxSets = size;
 	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizeVec.size());
 	poolCreateInfo.pPoolSizes = poolSizeVec.data();
@@ -63,13 +71,21 @@ vk::DescriptorPool vkInit::CreateDescriptorPool(const vk::Device& device, uint32
 	}
 }
 
-vk::DescriptorSet vkInit::CreateDescriptorSet(const vk::Device& device, const vk::DescriptorPool& descriptorPool, const vk::DescriptorSetLayout& setLayout)
+vk::DescriptorSet vkInit::CreateDescriptorSet(const vk::Device& device, const vk::DescriptorPool& descriptorPool, const vk::DescriptorSetLayout& setLayout, uint32_t variableDescriptorCount)
 {
 	vk::DescriptorSetAllocateInfo setAllocateInfo{};
 	setAllocateInfo.descriptorPool = descriptorPool;
 	setAllocateInfo.descriptorSetCount = 1;
 	setAllocateInfo.pSetLayouts = &setLayout;
 
+	vk::DescriptorSetVariableDescriptorCountAllocateInfo variableCountAllocateInfo{};
+	if (variableDescriptorCount > 0)
+	{
+		variableCountAllocateInfo.descriptorSetCount = 1;
+		variableCountAllocateInfo.pDescriptorCounts = &variableDescriptorCount;
+		setAllocateInfo.pNext = &variableCountAllocateInfo;
+	}
+
 	try
 	{
 		return device.allocateDescriptorSets(setAllocateInfo)[0];
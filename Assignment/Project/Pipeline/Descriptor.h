@@ -11,13 +11,18 @@ namespace vkInit
 		std::vector<vk::DescriptorType> TypeVec;
 		std::vector<int> CountVec;
 		std::vector<vk::ShaderStageFlags> StageFlagVec;
+		//either empty or one entry per binding, descriptor indexing flags like partially bound
+		std::vector<vk::DescriptorBindingFlags> BindingFlagVec;
+		vk::DescriptorSetLayoutCreateFlags LayoutFlags{};
 	};
 
 	vk::DescriptorSetLayout CreateDescriptorSetLayout(const vk::Device& device, const DescriptorSetLayoutData& layoutData);
 
-	vk::DescriptorPool CreateDescriptorPool(const vk::Device& device, uint32_t size, const DescriptorSetLayoutData& layoutData);
+	//a layout with update after bind bindings needs a pool with the update after bind flag
+	vk::DescriptorPool CreateDescriptorPool(const vk::Device& device, uint32_t size, const DescriptorSetLayoutData& layoutData, vk::DescriptorPoolCreateFlags poolFlags = vk::DescriptorPoolCreateFlags{});
 
-	vk::DescriptorSet CreateDescriptorSet(const vk::Device& device, const vk::DescriptorPool& descriptorPool, const vk::DescriptorSetLayout& setLayout);;
+	//variableDescriptorCount is the size of the last binding when it has the variable descriptor count flag
+	vk::DescriptorSet CreateDescriptorSet(const vk::Device& device, const vk::DescriptorPool& descriptorPool, const vk::DescriptorSetLayout& setLayout, uint32_t variableDescriptorCount = 0);
 
 }
 
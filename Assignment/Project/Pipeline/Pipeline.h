@@ -4,6 +4,8 @@
 #include "Shader.h"
 #include "Utils/RenderStructs.h"
 #include "RenderPass.h"
+#include "PipelineCache.h"
+#include "Utils/Hash.h"
 #include "functional"
 
 namespace vkInit
@@ -22,6 +24,8 @@ namespace vkInit
 			vk::Extent2D SwapchainExtent;
 			vk::RenderPass RenderPass;
 			std::vector<vk::DescriptorSetLayout> DescriptorSetLayoutVec;
+			//vertex stage push constants
+			uint32_t PushConstantSize{ sizeof(glm::mat4) };
 		};
 
 		struct GraphicsPipelineOutBundle
@@ -32,15 +36,25 @@ namespace vkInit
 
 		Pipeline(GraphicsPipelineInBundle const& in)
 			: m_Device{ in.Device }
+			, m_StateHash{ HashState(in) }
 		{
+			//a pipeline with the same state is shared, the shaders are only read when there is none yet
+			if (std::optional<CachedPipeline> const cachedPipeline{ PipelineCache::GetInstance().Acquire(m_StateHash) })
+			{
+				m_PipelineLayout = cachedPipeline->Layout;
+				m_Pipeline = cachedPipeline->Pipeline;
+				return;
+			}
+
 			GraphicsPipelineOutBundle out = CreateGraphicsPipeline(in);
 			m_PipelineLayout = out.Layout;
 			m_Pipeline = out.Pipeline;
+
+			PipelineCache::GetInstance().Insert(m_StateHash, CachedPipeline{ m_PipelineLayout, m_Pipeline });
 		}
 		~Pipeline()
 		{
-			m_Device.destroyPipeline(m_Pipeline);
-			m_Device.destroyPipelineLayout(m_PipelineLayout);
+			PipelineCache::GetInstance().Release(m_StateHash);
 		}
 
 		Pipeline(Pipeline const& other) = delete;
@@ -64,12 +78,30 @@ namespace vkInit
 		vk::Pipeline m_Pipeline;
 
 		vk::Device m_Device;
+		std::uint64_t m_StateHash;
+
+		//everything the pipeline is created from, the shaders by their path
+		static std::uint64_t HashState(GraphicsPipelineInBundle const& in)
+		{
+			std::vector<vk::VertexInputBindingDescription> const bindingDescription{ VertexStruct::GetBindingDescription() };
+			std::vector const attributeDescriptionArr{ VertexStruct::GetAttributeDescription() };
+			VkRenderPass const renderPass{ static_cast<VkRenderPass>(in.RenderPass) };
+
+			std::uint64_t hash{ vkUtil::HashString(in.VertexFilePath) };
+			hash = vkUtil::HashString(in.FragmentFilePath, hash);
+			hash = vkUtil::HashBytes(bindingDescription.data(), bindingDescription.size() * sizeof(vk::VertexInputBindingDescription), hash);
+			hash = vkUtil::HashBytes(attributeDescriptionArr.data(), attributeDescriptionArr.size() * sizeof(vk::VertexInputAttributeDescription), hash);
+			hash = vkUtil::HashBytes(&in.SwapchainExtent, sizeof(vk::Extent2D), hash);
+			hash = vkUtil::HashBytes(&renderPass, sizeof(VkRenderPass), hash);
+			hash = vkUtil::HashBytes(in.DescriptorSetLayoutVec.data(), in.DescriptorSetLayoutVec.size() * sizeof(vk::DescriptorSetLayout), hash);
+			return vkUtil::HashBytes(&in.PushConstantSize, sizeof(uint32_t), hash);
+		}
 
-		vk::PipelineLayout CreatePipelineLayout(vk::Device const& device, std::vector<vk::DescriptorSetLayout> const& descriptorSetLayout)
+		vk::PipelineLayout CreatePipelineLayout(vk::Device const& device, std::vector<vk::DescriptorSetLayout> const& descriptorSetLayout, uint32_t pushConstantSize)
 		{
 			vk::PushConstantRange pushConstantRange{};
 			pushConstantRange.offset = 0;
-			pushConstantRange.size = sizeof(glm::mat4);
+			pushConstantRange.size = pushConstantSize;
 			pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eVertex;
 
 			vk::PipelineLayoutCreateInfo layoutCreateInfo{};
@@ -282,7 +314,7 @@ namespace vkInit
 
 			std::cout << "\tPipeline layout creation started\n";
 
-			vk::PipelineLayout pipelineLayout{ CreatePipelineLayout(in.Device, in.DescriptorSetLayoutVec) };
+			vk::PipelineLayout pipelineLayout{ CreatePipelineLayout(in.Device, in.DescriptorSetLayoutVec, in.PushConstantSize) };
 			pipelineCreateInfo.layout = pipelineLayout;
 
 			std::cout << "\tRenderpass creation started\n";
@@ -297,7 +329,7 @@ namespace vkInit
 
 			try
 			{
-				pipeline = in.Device.createGraphicsPipeline(nullptr, pipelineCreateInfo).value;
+				pipeline = in.Device.createGraphicsPipeline(PipelineCache::GetInstance().GetCache(), pipelineCreateInfo).value;
 			}
 			catch (const vk::SystemError& systemError)
 			{
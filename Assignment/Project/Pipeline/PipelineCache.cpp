@@ -0,0 +1,255 @@
+#include "PipelineCache.h"
+#include "Utils/Hash.h"
+#include "Utils/MappedFile.h"
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+
+	constexpr uint32_t CacheFileMagic{ 0x43504B56 };
+	constexpr uint32_t CacheFileVersion{ 1 };
+
+	//written in front of the vk::PipelineCache data
+	struct CacheFileHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint32_t DriverVersion;
+		uint8_t DeviceUUID[VK_UUID_SIZE];
+		uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t DataSize;
+		uint64_t DataHash;
+	};
+
+}
+
+void vkInit::PipelineCache::Initialize(vk::Device const& device, vk::PhysicalDevice const& physicalDevice, std::string const& fileName)
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	m_Device = device;
+	m_FileName = fileName;
+
+	auto const propertiesChain{ physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>() };
+	vk::PhysicalDeviceProperties const& properties{ propertiesChain.get<vk::PhysicalDeviceProperties2>().properties };
+	vk::PhysicalDeviceIDProperties const& idProperties{ propertiesChain.get<vk::PhysicalDeviceIDProperties>() };
+
+	m_VendorID = properties.vendorID;
+	m_DeviceID = properties.deviceID;
+	m_DriverVersion = properties.driverVersion;
+	std::copy_n(idProperties.deviceUUID.data(), VK_UUID_SIZE, m_DeviceUUID.begin());
+	std::copy_n(properties.pipelineCacheUUID.data(), VK_UUID_SIZE, m_PipelineCacheUUID.begin());
+
+	std::vector<std::byte> const cacheData{ LoadCacheData() };
+	m_IsWarm = not cacheData.empty();
+
+	vk::PipelineCacheCreateInfo cacheCreateInfo{};
+	cacheCreateInfo.flags = vk::PipelineCacheCreateFlags{};
+	cacheCreateInfo.initialDataSize = cacheData.size();
+	cacheCreateInfo.pInitialData = cacheData.data();
+
+	try
+	{
+		m_Cache = m_Device.createPipelineCache(cacheCreateInfo);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+
+		//the driver refused the data after all, an empty cache still works
+		m_IsWarm = false;
+		cacheCreateInfo.initialDataSize = 0;
+		cacheCreateInfo.pInitialData = nullptr;
+		m_Cache = m_Device.createPipelineCache(cacheCreateInfo);
+	}
+
+	if (m_IsWarm)
+	{
+		std::cout << "Pipeline cache loaded from " << m_FileName << " (" << cacheData.size() / 1024 << " KB)\n";
+	}
+	else
+	{
+		std::cout << "Pipeline cache starts empty\n";
+	}
+}
+
+void vkInit::PipelineCache::Destroy()
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	if (not m_PipelineMap.empty())
+	{
+		std::cout << "Pipeline cache destroyed with " << m_PipelineMap.size() << " live pipelines\n";
+	}
+
+	for (auto const& [stateHash, entry] : m_PipelineMap)
+	{
+		m_Device.destroyPipeline(entry.Pipeline.Pipeline);
+		m_Device.destroyPipelineLayout(entry.Pipeline.Layout);
+	}
+	m_PipelineMap.clear();
+
+	if (SaveCacheData())
+	{
+		std::cout << "Pipeline cache saved to " << m_FileName << "\n";
+	}
+
+	m_Device.destroyPipelineCache(m_Cache);
+	m_Cache = nullptr;
+	m_Device = nullptr;
+}
+
+vk::PipelineCache const& vkInit::PipelineCache::GetCache() const
+{
+	return m_Cache;
+}
+
+bool vkInit::PipelineCache::IsWarm() const
+{
+	return m_IsWarm;
+}
+
+std::optional<vkInit::CachedPipeline> vkInit::PipelineCache::Acquire(std::uint64_t stateHash)
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	auto const entryIt{ m_PipelineMap.find(stateHash) };
+	if (entryIt == m_PipelineMap.end())
+	{
+		return std::nullopt;
+	}
+
+	++entryIt->second.UseCount;
+	return entryIt->second.Pipeline;
+}
+
+void vkInit::PipelineCache::Insert(std::uint64_t stateHash, CachedPipeline const& pipeline)
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	m_PipelineMap[stateHash] = CacheEntry{ pipeline, 1 };
+}
+
+void vkInit::PipelineCache::Release(std::uint64_t stateHash)
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	auto const entryIt{ m_PipelineMap.find(stateHash) };
+	if (entryIt == m_PipelineMap.end())
+	{
+		return;
+	}
+
+	if (--entryIt->second.UseCount > 0)
+	{
+		return;
+	}
+
+	m_Device.destroyPipeline(entryIt->second.Pipeline.Pipeline);
+	m_Device.destroyPipelineLayout(entryIt->second.Pipeline.Layout);
+	m_PipelineMap.erase(entryIt);
+}
+
+std::vector<std::byte> vkInit::PipelineCache::LoadCacheData() const
+{
+	vkUtil::MappedFile const file{ m_FileName };
+	if (not file.IsOpen())
+	{
+		return {};
+	}
+
+	std::span<std::byte const> const fileData{ file.GetData() };
+	if (fileData.size() < sizeof(CacheFileHeader))
+	{
+		std::cout << m_FileName << " is too small to be a pipeline cache\n";
+		return {};
+	}
+
+	CacheFileHeader header{};
+	std::memcpy(&header, fileData.data(), sizeof(CacheFileHeader));
+
+	if (header.Magic != CacheFileMagic or header.Version != CacheFileVersion)
+	{
+		std::cout << m_FileName << " is not a pipeline cache of this version\n";
+		return {};
+	}
+
+	//a cache of another gpu or driver is at best useless, some drivers crash on it
+	bool const sameDevice{ header.VendorID == m_VendorID and header.DeviceID == m_DeviceID and
+		std::equal(m_DeviceUUID.begin(), m_DeviceUUID.end(), header.DeviceUUID) };
+	bool const sameDriver{ header.DriverVersion == m_DriverVersion and
+		std::equal(m_PipelineCacheUUID.begin(), m_PipelineCacheUUID.end(), header.PipelineCacheUUID) };
+	if (not sameDevice or not sameDriver)
+	{
+		std::cout << m_FileName << " was written for another device or driver\n";
+		return {};
+	}
+
+	std::span<std::byte const> const cacheData{ fileData.subspan(sizeof(CacheFileHeader)) };
+	if (cacheData.size() != header.DataSize or vkUtil::HashBytes(cacheData.data(), cacheData.size()) != header.DataHash)
+	{
+		std::cout << m_FileName << " is damaged\n";
+		return {};
+	}
+
+	return { cacheData.begin(), cacheData.end() };
+}
+
+bool vkInit::PipelineCache::SaveCacheData() const
+{
+	std::vector<uint8_t> cacheData{};
+
+	try
+	{
+		cacheData = m_Device.getPipelineCacheData(m_Cache);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+
+		return false;
+	}
+
+	CacheFileHeader header{};
+	header.Magic = CacheFileMagic;
+	header.Version = CacheFileVersion;
+	header.VendorID = m_VendorID;
+	header.DeviceID = m_DeviceID;
+	header.DriverVersion = m_DriverVersion;
+	std::copy(m_DeviceUUID.begin(), m_DeviceUUID.end(), header.DeviceUUID);
+	std::copy(m_PipelineCacheUUID.begin(), m_PipelineCacheUUID.end(), header.PipelineCacheUUID);
+	header.DataSize = cacheData.size();
+	header.DataHash = vkUtil::HashBytes(cacheData.data(), cacheData.size());
+
+	//written next to the old file and renamed over it, a crash halfway through never leaves a damaged cache behind
+	std::string const tempFileName{ m_FileName + ".tmp" };
+	{
+		std::ofstream file{ tempFileName, std::ios::binary | std::ios::trunc };
+		if (not file.is_open())
+		{
+			std::cout << "Failed to write " << tempFileName << "\n";
+			return false;
+		}
+
+		file.write(reinterpret_cast<char const*>(&header), sizeof(CacheFileHeader));
+		file.write(reinterpret_cast<char const*>(cacheData.data()), static_cast<std::streamsize>(cacheData.size()));
+		if (not file.good())
+		{
+			std::cout << "Failed to write " << tempFileName << "\n";
+			return false;
+		}
+	}
+
+	std::error_code errorCode{};
+	std::filesystem::rename(tempFileName, m_FileName, errorCode);
+	if (errorCode)
+	{
+		std::cout << "Failed to replace " << m_FileName << ": " << errorCode.message() << "\n";
+		return false;
+	}
+
+	return true;
+}
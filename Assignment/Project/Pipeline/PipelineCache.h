@@ -0,0 +1,71 @@
+#ifndef VK_PIPELINE_CACHE_H
+#define VK_PIPELINE_CACHE_H
+#include "Engine/Configuration.h"
+#include "Engine/Singleton.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace vkInit
+{
+
+	struct CachedPipeline
+	{
+		vk::PipelineLayout Layout;
+		vk::Pipeline Pipeline;
+	};
+
+	//the vk::PipelineCache every graphics and compute pipeline is created with, kept on disk between runs
+	//on top of it the pipelines themselves are shared, a pipeline requested with the same state again gets the existing one
+	class PipelineCache final : public ave::Singleton<PipelineCache>
+	{
+	public:
+		//the file is only used when it was written for the same device and driver, the cache starts empty otherwise
+		void Initialize(vk::Device const& device, vk::PhysicalDevice const& physicalDevice, std::string const& fileName);
+
+		//writes the cache to the file, every pipeline has to be released before
+		void Destroy();
+
+		vk::PipelineCache const& GetCache() const;
+
+		//true when the cache was loaded from the file, pipelines created from it skip most of the shader compilation
+		bool IsWarm() const;
+
+		//the pipeline created with this state hash before, its use count goes up
+		std::optional<CachedPipeline> Acquire(std::uint64_t stateHash);
+		//the pipeline starts out with one use
+		void Insert(std::uint64_t stateHash, CachedPipeline const& pipeline);
+		//destroys the pipeline and its layout once nothing uses it anymore
+		void Release(std::uint64_t stateHash);
+	private:
+		friend class ave::Singleton<PipelineCache>;
+		PipelineCache() = default;
+
+		struct CacheEntry
+		{
+			CachedPipeline Pipeline;
+			int UseCount;
+		};
+
+		vk::Device m_Device;
+		vk::PipelineCache m_Cache;
+		std::string m_FileName;
+		bool m_IsWarm{ false };
+
+		//identify the device and driver the file was written for
+		uint32_t m_VendorID{};
+		uint32_t m_DeviceID{};
+		uint32_t m_DriverVersion{};
+		std::array<uint8_t, VK_UUID_SIZE> m_DeviceUUID{};
+		std::array<uint8_t, VK_UUID_SIZE> m_PipelineCacheUUID{};
+
+		std::mutex m_Mutex;
+		std::unordered_map<std::uint64_t, CacheEntry> m_PipelineMap;
+
+		//empty when the file is missing, damaged or was written for another device or driver
+		std::vector<std::byte> LoadCacheData() const;
+		bool SaveCacheData() const;
+	};
+
+}
+
+#endif
@@ -10,7 +10,7 @@ vkInit::RenderPass::~RenderPass()
 	m_Device.destroyRenderPass(m_RenderPass);
 }
 
-void vkInit::RenderPass::BeginRenderPass(const vk::CommandBuffer& commandBuffer, const vk::Framebuffer& frameBuffer, const vk::Extent2D& swapchainExtent)
+void vkInit::RenderPass::BeginRenderPass(const vk::CommandBuffer& commandBuffer, const vk::Framebuffer& frameBuffer, const vk::Extent2D& swapchainExtent, vk::SubpassContents contents)
 {
 	vk::RenderPassBeginInfo renderPassBeginInfo{};
 	renderPassBeginInfo.renderPass = m_RenderPass;
@@ -31,7 +31,7 @@ void vkInit::RenderPass::BeginRenderPass(const vk::CommandBuffer& commandBuffer,
 	renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValueVec.size());
 	renderPassBeginInfo.pClearValues = clearValueVec.data();
 
-	commandBuffer.beginRenderPass(&renderPassBeginInfo, vk::SubpassContents::eInline);
+	commandBuffer.beginRenderPass(&renderPassBeginInfo, contents);
 }
 
 void vkInit::RenderPass::EndRenderPass(const vk::CommandBuffer& commandBuffer)
@@ -24,7 +24,9 @@ namespace vkInit
 		RenderPass& operator=(const RenderPass& other) = delete;
 		RenderPass& operator=(RenderPass&& other) = delete;
 
-		void BeginRenderPass(const vk::CommandBuffer& commandBuffer, const vk::Framebuffer& frameBuffer, const vk::Extent2D& swapchainExtent);
+		//with secondary command buffer contents every draw of the pass has to be recorded into secondary command buffers
+		void BeginRenderPass(const vk::CommandBuffer& commandBuffer, const vk::Framebuffer& frameBuffer, const vk::Extent2D& swapchainExtent,
+			vk::SubpassContents contents = vk::SubpassContents::eInline);
 		void EndRenderPass(const vk::CommandBuffer& commandBuffer);
 
 		vk::RenderPass const& GetRenderPass() const;
@@ -42,26 +42,36 @@ void vkInit::CreateFrameCommandBuffers(const CommandBufferInBundle& in)
 	}
 }
 
-vk::CommandBuffer vkInit::CreateMainCommandBuffer(const CommandBufferInBundle& in)
+void vkInit::CreateFrameSecondaryCommandBuffers(const SecondaryCommandBufferInBundle& in)
 {
-	vk::CommandBufferAllocateInfo bufferAllocInfo{};
-	bufferAllocInfo.commandPool = in.CommandPool;
-	bufferAllocInfo.level = vk::CommandBufferLevel::ePrimary;
-	bufferAllocInfo.commandBufferCount = 1;
+	vkUtil::QueueFamilyIndices queueFamilyIndices{ vkUtil::FindQueueFamilies(in.PhysicalDevice, in.Surface) };
 
-	try
-	{
-		vk::CommandBuffer commandBuffer{ in.Device.allocateCommandBuffers(bufferAllocInfo)[0] };
+	vk::CommandPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.flags = vk::CommandPoolCreateFlags{} | vk::CommandPoolCreateFlagBits::eTransient;
+	poolCreateInfo.queueFamilyIndex = queueFamilyIndices.GraphicsFamily.value();
 
-		std::cout << "\nMain command buffer allocation successful\n";
+	vk::CommandBufferAllocateInfo bufferAllocInfo{};
+	bufferAllocInfo.level = vk::CommandBufferLevel::eSecondary;
+	bufferAllocInfo.commandBufferCount = 1;
 
-		return commandBuffer;
-	}
-	catch (const vk::SystemError& systemError)
+	for (int idx{}; idx < in.FrameVec.size(); ++idx)
 	{
-		std::cout << systemError.what() << "\n";
-
-		return nullptr;
+		try
+		{
+			for (int batchIdx{}; batchIdx < in.BatchCount; ++batchIdx)
+			{
+				in.FrameVec[idx].RecordingCommandPoolVec.emplace_back(in.Device.createCommandPool(poolCreateInfo));
+
+				bufferAllocInfo.commandPool = in.FrameVec[idx].RecordingCommandPoolVec.back();
+				in.FrameVec[idx].SecondaryCommandBufferVec.emplace_back(in.Device.allocateCommandBuffers(bufferAllocInfo)[0]);
+			}
+			std::cout << in.BatchCount << " secondary command buffers allocated for frame " << idx << "\n";
+		}
+		catch (const vk::SystemError& systemError)
+		{
+			std::cout << "Secondary command buffer allocation for frame " << idx << " failed\n";
+			std::cout << systemError.what() << "\n";
+		}
 	}
 }
 
@@ -73,20 +83,3 @@ void vkInit::BeginSingleCommand(const vk::CommandBuffer& commandBuffer)
 	bufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
 	commandBuffer.begin(bufferBeginInfo);
 }
-
-void vkInit::EndSingleCommand(const vk::CommandBuffer& commandBuffer, const vk::Queue& queue)
-{
-	commandBuffer.end();
-
-	vk::SubmitInfo submitInfo;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
-
-	vk::Result result{ queue.submit(1, &submitInfo, nullptr) };
-	if (result != vk::Result::eSuccess)
-	{
-		std::cout << "Commandbuffer submission failure\n";
-	}
-
-	queue.waitIdle();
-}
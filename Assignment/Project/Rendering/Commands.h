@@ -10,19 +10,27 @@ namespace vkInit
 	{
 		vk::Device Device;
 		vk::CommandPool CommandPool;
-		std::vector<vkUtil::SwapchainFrame>& FrameVec;
+		std::vector<vkUtil::FrameContext>& FrameVec;
+	};
+
+	struct SecondaryCommandBufferInBundle
+	{
+		vk::Device Device;
+		vk::PhysicalDevice PhysicalDevice;
+		vk::SurfaceKHR Surface;
+		std::vector<vkUtil::FrameContext>& FrameVec;
+		int BatchCount;
 	};
 
 	vk::CommandPool CreateCommandPool(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const vk::SurfaceKHR& surface);
 
 	void CreateFrameCommandBuffers(const CommandBufferInBundle& in);
 
-	vk::CommandBuffer CreateMainCommandBuffer(const CommandBufferInBundle& in);
+	//every frame gets its own transient pool per batch, so worker threads never record from the same pool and a pool is reset in one call
+	void CreateFrameSecondaryCommandBuffers(const SecondaryCommandBufferInBundle& in);
 
 	void BeginSingleCommand(const vk::CommandBuffer& commandBuffer);
 
-	void EndSingleCommand(const vk::CommandBuffer& commandBuffer, const vk::Queue& queue);
-
 }
 
 #endif
\ No newline at end of file
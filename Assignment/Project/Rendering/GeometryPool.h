@@ -0,0 +1,160 @@
+#ifndef VK_GEOMETRY_POOL_H
+#define VK_GEOMETRY_POOL_H
+#include "Engine/Configuration.h"
+#include "Utils/RenderStructs.h"
+#include "Utils/Buffer.h"
+#include "Utils/FreeListAllocator.h"
+#include "Rendering/UploadContext.h"
+#include <span>
+
+namespace ave
+{
+	//where a mesh lives in the pool, in vertices and indices so it maps straight onto a draw command
+	struct GeometryAllocation
+	{
+		uint32_t FirstIndex{};
+		uint32_t IndexCount{};
+		int32_t VertexOffset{};
+		uint32_t VertexCount{};
+	};
+
+	struct GeometryPoolInBundle
+	{
+		vk::Device Device;
+		vk::PhysicalDevice PhysicalDevice;
+		uint32_t VertexCapacity{};
+		uint32_t IndexCapacity{};
+	};
+
+	//one vertex buffer and one index buffer shared by every mesh of a vertex type, ranges are handed out by free list allocators
+	//freed ranges are only reused once every frame that could still draw them has finished
+	template<vkUtil::Vertex VertexStruct>
+	class GeometryPool final
+	{
+	public:
+		GeometryPool(GeometryPoolInBundle const& in)
+			: m_Device{ in.Device }
+			, m_VertexAllocator{ static_cast<std::uint64_t>(in.VertexCapacity) * sizeof(VertexStruct) }
+			, m_IndexAllocator{ static_cast<std::uint64_t>(in.IndexCapacity) * sizeof(uint32_t) }
+		{
+			vkUtil::BufferInBundle inBundle{};
+			inBundle.Device = in.Device;
+			inBundle.PhysicalDevice = in.PhysicalDevice;
+			inBundle.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+			inBundle.Size = m_VertexAllocator.GetCapacity();
+			inBundle.UsageFlags = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+			m_VertexBuffer = vkUtil::CreateBuffer(inBundle);
+
+			inBundle.Size = m_IndexAllocator.GetCapacity();
+			inBundle.UsageFlags = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+			m_IndexBuffer = vkUtil::CreateBuffer(inBundle);
+		}
+
+		~GeometryPool()
+		{
+			vkUtil::DestroyBuffer(m_Device, m_VertexBuffer);
+			vkUtil::DestroyBuffer(m_Device, m_IndexBuffer);
+		}
+
+		GeometryPool(GeometryPool const& other) = delete;
+		GeometryPool(GeometryPool&& other) = delete;
+		GeometryPool& operator=(GeometryPool const& other) = delete;
+		GeometryPool& operator=(GeometryPool&& other) = delete;
+
+		//allocates room for the mesh and records the copy into the upload context, nullopt when the pool is full
+		//the range can only be drawn once the upload context has signaled the batch
+		std::optional<GeometryAllocation> Upload(vkUtil::MeshInBundle const& in, std::span<VertexStruct const> vertexSpan, std::span<uint32_t const> indexSpan)
+		{
+			std::uint64_t const vertexSize{ sizeof(VertexStruct) * vertexSpan.size() };
+			std::uint64_t const indexSize{ sizeof(uint32_t) * indexSpan.size() };
+
+			//byte offsets have to be a multiple of the element size to be usable as vertex offset and first index
+			std::optional<std::uint64_t> const vertexByteOffset{ m_VertexAllocator.Allocate(vertexSize, sizeof(VertexStruct)) };
+			if (not vertexByteOffset)
+			{
+				std::cout << "Geometry pool is out of vertex space\n";
+				return std::nullopt;
+			}
+
+			std::optional<std::uint64_t> const indexByteOffset{ m_IndexAllocator.Allocate(indexSize, sizeof(uint32_t)) };
+			if (not indexByteOffset)
+			{
+				std::cout << "Geometry pool is out of index space\n";
+				m_VertexAllocator.Free(*vertexByteOffset, vertexSize);
+				return std::nullopt;
+			}
+
+			in.UploadContextPtr->UploadBuffer(m_VertexBuffer.Buffer, *vertexByteOffset, vertexSpan.data(), vertexSize);
+			in.UploadContextPtr->UploadBuffer(m_IndexBuffer.Buffer, *indexByteOffset, indexSpan.data(), indexSize);
+
+			GeometryAllocation allocation{};
+			allocation.FirstIndex = static_cast<uint32_t>(*indexByteOffset / sizeof(uint32_t));
+			allocation.IndexCount = static_cast<uint32_t>(indexSpan.size());
+			allocation.VertexOffset = static_cast<int32_t>(*vertexByteOffset / sizeof(VertexStruct));
+			allocation.VertexCount = static_cast<uint32_t>(vertexSpan.size());
+			return allocation;
+		}
+
+		//the range stays reserved until AdvanceFrame was called once for every frame in flight
+		void Free(GeometryAllocation const& allocation)
+		{
+			m_RetiredVec.emplace_back(RetiredAllocation{ allocation, m_FramesInFlight });
+		}
+
+		void SetFramesInFlight(int framesInFlight)
+		{
+			m_FramesInFlight = framesInFlight;
+		}
+
+		//has to be called once per frame after waiting for the fence of the frame
+		void AdvanceFrame()
+		{
+			for (auto& retired : m_RetiredVec)
+			{
+				--retired.FramesLeft;
+			}
+
+			auto const releaseIt{ std::partition(m_RetiredVec.begin(), m_RetiredVec.end(),
+				[](RetiredAllocation const& retired)
+				{
+					return retired.FramesLeft > 0;
+				}) };
+
+			for (auto retiredIt{ releaseIt }; retiredIt != m_RetiredVec.end(); ++retiredIt)
+			{
+				GeometryAllocation const& allocation{ retiredIt->Allocation };
+				m_VertexAllocator.Free(static_cast<std::uint64_t>(allocation.VertexOffset) * sizeof(VertexStruct), static_cast<std::uint64_t>(allocation.VertexCount) * sizeof(VertexStruct));
+				m_IndexAllocator.Free(static_cast<std::uint64_t>(allocation.FirstIndex) * sizeof(uint32_t), static_cast<std::uint64_t>(allocation.IndexCount) * sizeof(uint32_t));
+			}
+			m_RetiredVec.erase(releaseIt, m_RetiredVec.end());
+		}
+
+		void Bind(vk::CommandBuffer const& commandBuffer) const
+		{
+			vk::Buffer vertexBufferArr[]{ m_VertexBuffer.Buffer };
+			vk::DeviceSize offsetArr[]{ 0 };
+			commandBuffer.bindVertexBuffers(0, 1, vertexBufferArr, offsetArr);
+			commandBuffer.bindIndexBuffer(m_IndexBuffer.Buffer, 0, vk::IndexType::eUint32);
+		}
+	private:
+		struct RetiredAllocation
+		{
+			GeometryAllocation Allocation;
+			int FramesLeft;
+		};
+
+		vk::Device m_Device;
+
+		vkUtil::DataBuffer m_VertexBuffer;
+		vkUtil::DataBuffer m_IndexBuffer;
+
+		vkUtil::FreeListAllocator m_VertexAllocator;
+		vkUtil::FreeListAllocator m_IndexAllocator;
+
+		int m_FramesInFlight{ 1 };
+		std::vector<RetiredAllocation> m_RetiredVec;
+	};
+}
+
+#endif
@@ -1,20 +1,21 @@
 #include "Image.h"
-#include "Utils/Buffer.h"
-#include "Pipeline/Descriptor.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "Utils/STBI.h"
-
-vkInit::Texture::Texture(const TextureInBundle& texIn)
-	: m_Device{ texIn.Device }
+#include "Utils/CookedAsset.h"
+#include "Utils/Ktx2.h"
+#include "Utils/BlockCompression.h"
+
+vkInit::Texture::Texture(const TextureInBundle& texIn, const DecodedTexture& decodedTexture)
+	: m_Width{ static_cast<int>(std::max(decodedTexture.Width >> texIn.BaseMip, 1u)) }
+	, m_Height{ static_cast<int>(std::max(decodedTexture.Height >> texIn.BaseMip, 1u)) }
+	, m_MipLevels{ decodedTexture.MipLevels - texIn.BaseMip }
+	, m_BaseMip{ texIn.BaseMip }
+	, m_Format{ decodedTexture.Format }
+	, m_Device{ texIn.Device }
 	, m_PhysicalDevice{ texIn.PhysicalDevice }
 	, m_FileName{ texIn.FileName }
-	, m_CommandBuffer{ texIn.CommandBuffer }
-	, m_Queue{ texIn.Queue }
-	, m_DescriptorSetLayout{ texIn.DescriptorSetLayout }
-	, m_DescriptorPool{ texIn.DescriptorPool }
+	, m_UploadContextPtr{ texIn.UploadContextPtr }
 {
-	m_Pixels = stbi_load(m_FileName.c_str(), &m_Width, &m_Height, &m_Channels, STBI_rgb_alpha);
-	
 	ImageInBundle imageInBundle{};
 	imageInBundle.Device = m_Device;
 	imageInBundle.PhysicalDevice = m_PhysicalDevice;
@@ -22,125 +23,155 @@ vkInit::Texture::Texture(const TextureInBundle& texIn)
 	imageInBundle.Tiling = vk::ImageTiling::eOptimal;
 	imageInBundle.UsageFlags = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
 	imageInBundle.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
-	imageInBundle.Format = vk::Format::eR8G8B8A8Unorm;
+	imageInBundle.Format = m_Format;
+	imageInBundle.MipLevels = m_MipLevels;
 	
 	m_Image = CreateImage(imageInBundle);
 	
-	m_ImageMemory = CreateImageMemory(imageInBundle, m_Image);
-	
-	Populate();
-	
-	//stbi function
-	free(m_Pixels);
-	
-	m_ImageView = CreateImageView(m_Device, m_Image, vk::Format::eR8G8B8A8Unorm, vk::ImageAspectFlagBits::eColor);
-	
-	CreateSampler();
+	m_ImageAllocation = CreateImageMemory(imageInBundle, m_Image);
+
+	//the levels of the decoded texture the image leaves out come first in its pixels
+	vkUtil::FormatBlock const block{ vkUtil::GetFormatBlock(m_Format).value_or(vkUtil::FormatBlock{}) };
+	std::size_t const baseOffset{ static_cast<std::size_t>(vkUtil::GetMipChainSize(block, decodedTexture.Width, decodedTexture.Height, m_BaseMip)) };
+	Populate(std::span<unsigned char const>{ decodedTexture.PixelVec }.subspan(baseOffset));
 	
-	CreateDescriptorSet();
+	m_ImageView = CreateImageView(m_Device, m_Image, m_Format, vk::ImageAspectFlagBits::eColor, m_MipLevels);
 }
 
 vkInit::Texture::~Texture()
 {
-	m_Device.freeMemory(m_ImageMemory);
 	m_Device.destroyImage(m_Image);
+	vkUtil::MemoryAllocator::GetInstance().Free(m_ImageAllocation);
 	m_Device.destroyImageView(m_ImageView);
-	m_Device.destroySampler(m_Sampler);
 }
 
-void vkInit::Texture::Apply(const vk::CommandBuffer& commandBuffer, const vk::PipelineLayout& pipelineLayout)
+vk::DescriptorImageInfo vkInit::Texture::GetDescriptorImageInfo(vk::Sampler const& sampler) const
 {
-	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, m_DescriptorSet, nullptr);
+	vk::DescriptorImageInfo descriptorImageInfo{};
+	descriptorImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	descriptorImageInfo.imageView = m_ImageView;
+	descriptorImageInfo.sampler = sampler;
+
+	return descriptorImageInfo;
 }
 
-void vkInit::Texture::Populate()
+uint32_t vkInit::Texture::GetBaseMip() const
 {
-	vkUtil::BufferInBundle bufferInBundle{};
-	bufferInBundle.Device = m_Device;
-	bufferInBundle.PhysicalDevice = m_PhysicalDevice;
-	bufferInBundle.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostCoherent | vk::MemoryPropertyFlagBits::eHostVisible;
-	bufferInBundle.UsageFlags = vk::BufferUsageFlagBits::eTransferSrc;
-	bufferInBundle.Size = m_Width * m_Height * 4; //multiply by the size of the bites per pixel (uint32 -> 4 bytes)
-
-	vkUtil::DataBuffer stagingBuffer = vkUtil::CreateBuffer(bufferInBundle);
-
-	void* writeLocationPtr{ m_Device.mapMemory(stagingBuffer.BufferMemory, 0, bufferInBundle.Size) };
-	memcpy(writeLocationPtr, m_Pixels, bufferInBundle.Size);
-	m_Device.unmapMemory(stagingBuffer.BufferMemory);
-
-	ImageLayoutTransitionInBundle transitionInBundle{};
-	transitionInBundle.CommandBuffer = m_CommandBuffer;
-	transitionInBundle.Queue = m_Queue;
-	transitionInBundle.Image = m_Image;
-	transitionInBundle.OldLayout = vk::ImageLayout::eUndefined;
-	transitionInBundle.NewLayout = vk::ImageLayout::eTransferDstOptimal;
-	TransitionImageLayout(transitionInBundle);
-
-	BufferCopyImageInBundle copyInBundle{};
-	copyInBundle.CommandBuffer = m_CommandBuffer;
-	copyInBundle.Queue = m_Queue;
-	copyInBundle.SourceBuffer = stagingBuffer.Buffer;
-	copyInBundle.DestinationImage = m_Image;
-	copyInBundle.Extent = vk::Extent2D{ static_cast<uint32_t>(m_Width), static_cast<uint32_t>(m_Height) };
-	CopyBufferToImage(copyInBundle);
-
+	return m_BaseMip;
+}
 
-	transitionInBundle.OldLayout = vk::ImageLayout::eTransferDstOptimal;
-	transitionInBundle.NewLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-	TransitionImageLayout(transitionInBundle);
+vk::DeviceSize vkInit::Texture::GetMemorySize() const
+{
+	return m_ImageAllocation.Size;
+}
 
-	m_Device.freeMemory(stagingBuffer.BufferMemory);
-	m_Device.destroyBuffer(stagingBuffer.Buffer);
+void vkInit::Texture::Populate(std::span<unsigned char const> pixelSpan)
+{
+	m_UploadContextPtr->UploadImage(m_Image, vk::Extent2D{ static_cast<uint32_t>(m_Width), static_cast<uint32_t>(m_Height) }, pixelSpan.data(), pixelSpan.size(), m_MipLevels, m_Format);
 }
 
-void vkInit::Texture::CreateSampler()
+vk::Sampler vkInit::CreateSampler(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, TextureFiltering filtering)
 {
+	vk::PhysicalDeviceFeatures const features{ physicalDevice.getFeatures() };
+	float const maxAnisotropy{ physicalDevice.getProperties().limits.maxSamplerAnisotropy };
+
 	vk::SamplerCreateInfo samplerCreateInfo{};
 	samplerCreateInfo.flags = vk::SamplerCreateFlags{};
-	samplerCreateInfo.minFilter = vk::Filter::eNearest;
+	samplerCreateInfo.minFilter = filtering == TextureFiltering::Nearest ? vk::Filter::eNearest : vk::Filter::eLinear;
 	samplerCreateInfo.magFilter = vk::Filter::eLinear;
 	samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
 	samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
 	samplerCreateInfo.addressModeW = vk::SamplerAddressMode::eRepeat;
-	samplerCreateInfo.anisotropyEnable = vk::False;
-	samplerCreateInfo.maxAnisotropy = 1.0f;
+	//only enabled on the device when it supports it
+	samplerCreateInfo.anisotropyEnable = filtering == TextureFiltering::Anisotropic and features.samplerAnisotropy ? vk::True : vk::False;
+	samplerCreateInfo.maxAnisotropy = samplerCreateInfo.anisotropyEnable ? std::min(16.f, maxAnisotropy) : 1.f;
 	samplerCreateInfo.borderColor = vk::BorderColor::eIntOpaqueBlack;
 	samplerCreateInfo.unnormalizedCoordinates = vk::False;
 	samplerCreateInfo.compareEnable = vk::False;
 	samplerCreateInfo.compareOp = vk::CompareOp::eAlways;
-	samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+	samplerCreateInfo.mipmapMode = filtering == TextureFiltering::Nearest ? vk::SamplerMipmapMode::eNearest : vk::SamplerMipmapMode::eLinear;
 	samplerCreateInfo.mipLodBias = 0.0f;
 	samplerCreateInfo.minLod = 0.0f;
-	samplerCreateInfo.maxLod = 0.0f;
+	//nearest never leaves the full resolution level, the others use whatever levels the image has
+	samplerCreateInfo.maxLod = filtering == TextureFiltering::Nearest ? 0.f : VK_LOD_CLAMP_NONE;
 
 	try
 	{
-		m_Sampler = m_Device.createSampler(samplerCreateInfo);
+		return device.createSampler(samplerCreateInfo);
 	}
 	catch (const vk::SystemError& systemError)
 	{
 		std::cout << systemError.what() << "\n";
+
+		return nullptr;
 	}
 }
 
-void vkInit::Texture::CreateDescriptorSet()
+vkInit::DecodedTexture vkInit::DecodeTexture(const std::string& fileName, const std::vector<vk::Format>& supportedFormatVec)
 {
-	m_DescriptorSet = vkInit::CreateDescriptorSet(m_Device, m_DescriptorPool, m_DescriptorSetLayout);
+	DecodedTexture decodedTexture{};
 
-	vk::DescriptorImageInfo descriptorImageInfo{};
-	descriptorImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-	descriptorImageInfo.imageView = m_ImageView;
-	descriptorImageInfo.sampler = m_Sampler;
+	//a ktx2 file is used as is, any other image prefers the block compressed version the asset cooker wrote next to it
+	bool const isKtx2{ fileName.ends_with(".ktx2") };
+	std::string const ktx2FileName{ isKtx2 ? fileName : vkUtil::GetKtx2FileName(fileName) };
+	if (isKtx2 or vkUtil::IsKtx2Current(ktx2FileName, fileName))
+	{
+		std::optional<vkUtil::Ktx2Texture> ktx2Texture{ vkUtil::ReadKtx2(ktx2FileName) };
+		if (ktx2Texture and std::find(supportedFormatVec.begin(), supportedFormatVec.end(), ktx2Texture->Format) != supportedFormatVec.end())
+		{
+			decodedTexture.Width = ktx2Texture->Width;
+			decodedTexture.Height = ktx2Texture->Height;
+			decodedTexture.MipLevels = ktx2Texture->MipLevels;
+			decodedTexture.Format = ktx2Texture->Format;
+			decodedTexture.PixelVec = std::move(ktx2Texture->LevelVec);
+			return decodedTexture;
+		}
+
+		//the device can not sample the blocks, only the source image can stand in for them
+		if (ktx2Texture)
+		{
+			std::cout << "Texture " << ktx2FileName << " has format " << vk::to_string(ktx2Texture->Format) << " which the device can not sample\n";
+		}
+		if (isKtx2)
+		{
+			return decodedTexture;
+		}
+	}
+
+	//the cooked file already holds the decoded pixels and every mip level
+	vkUtil::CookedAsset const cookedAsset{ vkUtil::GetCookedFileName(fileName), fileName, vkUtil::CookedFlags::None };
+	std::span<vkUtil::CookedTextureHeader const> const cookedHeaderSpan{ cookedAsset.GetChunk<vkUtil::CookedTextureHeader>(vkUtil::CookedChunkType::TextureHeader) };
+	std::span<unsigned char const> const cookedPixelSpan{ cookedAsset.GetChunk<unsigned char>(vkUtil::CookedChunkType::TextureLevels) };
 
-	vk::WriteDescriptorSet des{};
-	des.dstSet = m_DescriptorSet;
-	des.dstBinding = 0;
-	des.dstArrayElement = 0;
-	des.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-	des.descriptorCount = 1;
-	des.pImageInfo = &descriptorImageInfo;
+	if (cookedHeaderSpan.size() == 1
+		and cookedPixelSpan.size() == vkUtil::GetMipChainSize(cookedHeaderSpan[0].Width, cookedHeaderSpan[0].Height, cookedHeaderSpan[0].MipLevels, 4))
+	{
+		decodedTexture.Width = cookedHeaderSpan[0].Width;
+		decodedTexture.Height = cookedHeaderSpan[0].Height;
+		decodedTexture.MipLevels = cookedHeaderSpan[0].MipLevels;
+		//copied so the pages are read here and not while the upload is recorded
+		decodedTexture.PixelVec.assign(cookedPixelSpan.begin(), cookedPixelSpan.end());
+		return decodedTexture;
+	}
 
-	m_Device.updateDescriptorSets(des, nullptr);
+	int width{};
+	int height{};
+	int channels{};
+	unsigned char* pixelPtr{ stbi_load(fileName.c_str(), &width, &height, &channels, STBI_rgb_alpha) };
+	if (pixelPtr == nullptr)
+	{
+		std::cout << "Failed to load texture " << fileName << "\n";
+		return decodedTexture;
+	}
+
+	//an uncooked texture gets the same box filtered chain the asset cooker would have written
+	decodedTexture.Width = static_cast<uint32_t>(width);
+	decodedTexture.Height = static_cast<uint32_t>(height);
+	decodedTexture.MipLevels = vkUtil::GetMipLevelCount(decodedTexture.Width, decodedTexture.Height);
+	decodedTexture.PixelVec = vkUtil::GenerateMipChain(pixelPtr, decodedTexture.Width, decodedTexture.Height, decodedTexture.MipLevels);
+
+	stbi_image_free(pixelPtr);
+	return decodedTexture;
 }
 
 vk::Image vkInit::CreateImage(const ImageInBundle& in)
@@ -149,7 +180,7 @@ vk::Image vkInit::CreateImage(const ImageInBundle& in)
 	imgCreateInfo.flags = vk::ImageCreateFlags{};
 	imgCreateInfo.imageType = vk::ImageType::e2D;
 	imgCreateInfo.extent = vk::Extent3D{ in.Extent, 1 };
-	imgCreateInfo.mipLevels = 1;
+	imgCreateInfo.mipLevels = in.MipLevels;
 	imgCreateInfo.arrayLayers = 1;
 	imgCreateInfo.format = in.Format;
 	imgCreateInfo.tiling = in.Tiling;
@@ -171,116 +202,12 @@ vk::Image vkInit::CreateImage(const ImageInBundle& in)
 	}
 }
 
-vk::DeviceMemory vkInit::CreateImageMemory(const ImageInBundle& in, const vk::Image& image)
+vkUtil::MemoryAllocation vkInit::CreateImageMemory(const ImageInBundle& in, const vk::Image& image)
 {
-	vk::MemoryRequirements memoryRequirements{ in.Device.getImageMemoryRequirements(image) };
-
-	vk::MemoryAllocateInfo memAllocateInfo{};
-	memAllocateInfo.allocationSize = memoryRequirements.size;
-	memAllocateInfo.memoryTypeIndex = vkUtil::FindMemoryTypeIndex(in.PhysicalDevice, memoryRequirements.memoryTypeBits, in.MemoryPropertyFlags);
-
-	try
-	{
-		vk::DeviceMemory imgMemory{ in.Device.allocateMemory(memAllocateInfo) };
-		in.Device.bindImageMemory(image, imgMemory, 0);
-		return imgMemory;
-	}
-	catch (const vk::SystemError& systemError)
-	{
-		
-		std::cout << systemError.what() << "\n";
-		
-		return nullptr;
-	}
-
+	return vkUtil::MemoryAllocator::GetInstance().AllocateForImage(image, in.MemoryPropertyFlags, in.Tiling);
 }
 
-void vkInit::TransitionImageLayout(const ImageLayoutTransitionInBundle& in)
-{
-	vkInit::BeginSingleCommand(in.CommandBuffer);
-
-	vk::ImageSubresourceRange imgSubRange{};
-	imgSubRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-	imgSubRange.baseMipLevel = 0;
-	imgSubRange.levelCount = 1;
-	imgSubRange.baseArrayLayer = 0;
-	imgSubRange.layerCount = 1;
-
-	vk::ImageMemoryBarrier barrier;
-	barrier.oldLayout = in.OldLayout;
-	barrier.newLayout = in.NewLayout;
-	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.image = in.Image;
-	barrier.subresourceRange = imgSubRange;
-
-	vk::PipelineStageFlags sourceStageFlags;
-	vk::PipelineStageFlags destinationStageFlags;
-	if (in.OldLayout == vk::ImageLayout::eUndefined
-		and in.NewLayout == vk::ImageLayout::eTransferDstOptimal)
-	{
-		barrier.srcAccessMask = vk::AccessFlagBits::eNoneKHR;
-		barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-
-		//flag is before the pipeline starts
-		sourceStageFlags = vk::PipelineStageFlagBits::eTopOfPipe;
-		destinationStageFlags = vk::PipelineStageFlagBits::eTransfer;
-	}
-	else
-	{
-		barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-		barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-		//flag is before the pipeline starts
-		sourceStageFlags = vk::PipelineStageFlagBits::eTransfer;
-		destinationStageFlags = vk::PipelineStageFlagBits::eFragmentShader;
-	}
-
-	in.CommandBuffer.pipelineBarrier
-	(
-		sourceStageFlags,
-		destinationStageFlags,
-		vk::DependencyFlags{},
-		nullptr,
-		nullptr,
-		barrier
-	);
-
-	vkInit::EndSingleCommand(in.CommandBuffer, in.Queue);
-}
-
-void vkInit::CopyBufferToImage(const BufferCopyImageInBundle& in)
-{
-	vkInit::BeginSingleCommand(in.CommandBuffer);
-
-	vk::BufferImageCopy copy;
-	copy.bufferOffset = 0;
-	copy.bufferRowLength = 0;
-	copy.bufferImageHeight = 0;
-
-	vk::ImageSubresourceLayers imgSubLayers;
-	imgSubLayers.aspectMask = vk::ImageAspectFlagBits::eColor;
-	imgSubLayers.mipLevel = 0;
-	imgSubLayers.baseArrayLayer = 0;
-	imgSubLayers.layerCount = 1;
-	
-	copy.imageSubresource = imgSubLayers;
-
-	copy.imageOffset = vk::Offset3D{ 0, 0, 0 };
-	copy.imageExtent = vk::Extent3D{ in.Extent, 1 };
-
-	in.CommandBuffer.copyBufferToImage
-	(
-		in.SourceBuffer,
-		in.DestinationImage,
-		vk::ImageLayout::eTransferDstOptimal,
-		copy
-	);
-
-	vkInit::EndSingleCommand(in.CommandBuffer, in.Queue);
-}
-
-vk::ImageView vkInit::CreateImageView(const vk::Device& device, const vk::Image& image, const vk::Format& format, const vk::ImageAspectFlags& aspectFlags)
+vk::ImageView vkInit::CreateImageView(const vk::Device& device, const vk::Image& image, const vk::Format& format, const vk::ImageAspectFlags& aspectFlags, uint32_t mipLevels)
 {
 	vk::ImageViewCreateInfo imgViewCreateInfo{};
 	imgViewCreateInfo.image = image;
@@ -292,29 +219,32 @@ vk::ImageView vkInit::CreateImageView(const vk::Device& device, const vk::Image&
 	imgViewCreateInfo.components.a = vk::ComponentSwizzle::eIdentity;
 	imgViewCreateInfo.subresourceRange.aspectMask = aspectFlags;
 	imgViewCreateInfo.subresourceRange.baseMipLevel = 0;
-	imgViewCreateInfo.subresourceRange.levelCount = 1;
+	imgViewCreateInfo.subresourceRange.levelCount = mipLevels;
 	imgViewCreateInfo.subresourceRange.baseArrayLayer = 0;
 	imgViewCreateInfo.subresourceRange.layerCount = 1;
 
 	return device.createImageView(imgViewCreateInfo);
 }
 
+bool vkInit::IsFormatSupported(const vk::PhysicalDevice& physicalDevice, const vk::Format& format, const vk::ImageTiling& tiling, const vk::FormatFeatureFlags& featureFlags)
+{
+	vk::FormatProperties properties{ physicalDevice.getFormatProperties(format) };
+
+	if (tiling == vk::ImageTiling::eLinear)
+	{
+		return (properties.linearTilingFeatures & featureFlags) == featureFlags;
+	}
+	return (properties.optimalTilingFeatures & featureFlags) == featureFlags;
+}
+
 vk::Format vkInit::GetSupportedFormat(const vk::PhysicalDevice& physicalDevice, const std::vector<vk::Format>& formatVec, const vk::ImageTiling& tiling, const vk::FormatFeatureFlags& featureFlags)
 {
 	for (const auto& format : formatVec)
 	{
-		vk::FormatProperties properties{ physicalDevice.getFormatProperties(format) };
-
-		if (tiling == vk::ImageTiling::eLinear and
-			(properties.linearTilingFeatures & featureFlags) == featureFlags)
+		if (IsFormatSupported(physicalDevice, format, tiling, featureFlags))
 		{
 			return format;
 		}
-		else if (tiling == vk::ImageTiling::eOptimal and
-			(properties.optimalTilingFeatures & featureFlags) == featureFlags)
-		{
-			return format; 
-		}
 	}
 	return formatVec[0];
 }
@@ -3,7 +3,8 @@
 
 #include "Engine/Configuration.h"
 #include "Utils/Buffer.h"
-#include "Rendering/Commands.h"
+#include "Rendering/UploadContext.h"
+#include <span>
 
 namespace vkInit
 {
@@ -12,13 +13,33 @@ namespace vkInit
 		vk::Device Device;
 		vk::PhysicalDevice PhysicalDevice;
 		std::string FileName;
-		vk::CommandBuffer CommandBuffer;
-		vk::Queue Queue;
-		vk::DescriptorSetLayout DescriptorSetLayout;
-		vk::DescriptorPool DescriptorPool;
+		//the pixels are recorded into it, the texture can be sampled once its batch is done
+		vkUtil::UploadContext* UploadContextPtr{ nullptr };
+		//the levels before it are left out, the image starts at the resolution of this level of the decoded texture
+		uint32_t BaseMip{ 0 };
 	};
 
 
+	//how textures are minified, nearest samples the full resolution level only
+	enum class TextureFiltering
+	{
+		Nearest,
+		Trilinear,
+		Anisotropic
+	};
+
+	//every mip level of a texture, read from its ktx2 or cooked file or decoded from the image itself
+	struct DecodedTexture
+	{
+		uint32_t Width{};
+		uint32_t Height{};
+		uint32_t MipLevels{ 1 };
+		//block compressed when the texture came from a ktx2 file
+		vk::Format Format{ vk::Format::eR8G8B8A8Unorm };
+		//levels packed one after the other, empty when the file could not be read
+		std::vector<unsigned char> PixelVec;
+	};
+
 	struct ImageInBundle
 	{
 		vk::Device Device;
@@ -28,30 +49,14 @@ namespace vkInit
 		vk::ImageUsageFlags UsageFlags;
 		vk::MemoryPropertyFlags MemoryPropertyFlags;
 		vk::Format Format;
-	};
-
-	struct ImageLayoutTransitionInBundle
-	{
-		vk::CommandBuffer CommandBuffer;
-		vk::Queue Queue;
-		vk::Image Image;
-		vk::ImageLayout OldLayout;
-		vk::ImageLayout NewLayout;
-	};
-
-	struct BufferCopyImageInBundle
-	{
-		vk::CommandBuffer CommandBuffer;
-		vk::Queue Queue;
-		vk::Buffer SourceBuffer;
-		vk::Image DestinationImage;
-		vk::Extent2D Extent;
+		uint32_t MipLevels{ 1 };
 	};
 
 	class Texture final
 	{
 	public:
-		Texture(const TextureInBundle& texIn);
+		//the pixels are only read while the upload is recorded
+		Texture(const TextureInBundle& texIn, const DecodedTexture& decodedTexture);
 		~Texture();
 
 		Texture(const Texture& other) = delete;
@@ -59,43 +64,49 @@ namespace vkInit
 		Texture& operator=(const Texture& other) = delete;
 		Texture& operator=(Texture&& other) = delete;
 
-		void Apply(const vk::CommandBuffer& commandBuffer, const vk::PipelineLayout& pipelineLayout);
+		//the scene writes every texture into one sampler array, the draw data picks the element
+		//the samplers are shared by every texture, they do not depend on the size or the levels of the image
+		vk::DescriptorImageInfo GetDescriptorImageInfo(vk::Sampler const& sampler) const;
+
+		//the level of the decoded texture the image starts at
+		uint32_t GetBaseMip() const;
+		vk::DeviceSize GetMemorySize() const;
 	private:
 		int m_Width{ 0 };
 		int m_Height{ 0 };
-		int m_Channels{ 0 };
+		uint32_t m_MipLevels{ 1 };
+		uint32_t m_BaseMip{ 0 };
+		vk::Format m_Format;
 		vk::Device m_Device;
 		vk::PhysicalDevice m_PhysicalDevice;
 		std::string m_FileName;
-		unsigned char* m_Pixels;
 
 		vk::Image m_Image;
 		vk::ImageView m_ImageView;
-		vk::DeviceMemory m_ImageMemory;
-		vk::Sampler m_Sampler;
+		vkUtil::MemoryAllocation m_ImageAllocation;
 
-		vk::DescriptorSetLayout m_DescriptorSetLayout;
-		vk::DescriptorSet m_DescriptorSet;
-		vk::DescriptorPool m_DescriptorPool;
+		vkUtil::UploadContext* m_UploadContextPtr;
 
-		vk::CommandBuffer m_CommandBuffer;
-		vk::Queue m_Queue;
-
-		void Populate();
-		void CreateSampler();
-		void CreateDescriptorSet();
+		void Populate(std::span<unsigned char const> pixelSpan);
 	};
 
-	vk::Image CreateImage(const ImageInBundle& in);
+	//anisotropic falls back to trilinear when the device has no anisotropic filtering
+	vk::Sampler CreateSampler(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, TextureFiltering filtering);
 
-	vk::DeviceMemory CreateImageMemory(const ImageInBundle& in, const vk::Image& image);
+	//does no vulkan calls, so it can run on any thread
+	//a ktx2 file is only used when its format is one of the supported formats, otherwise the source image is decoded as rgba8
+	DecodedTexture DecodeTexture(const std::string& fileName, const std::vector<vk::Format>& supportedFormatVec);
+
+	vk::Image CreateImage(const ImageInBundle& in);
 
-	void TransitionImageLayout(const ImageLayoutTransitionInBundle& in);
+	//allocates from the memory allocator and binds the image to it
+	vkUtil::MemoryAllocation CreateImageMemory(const ImageInBundle& in, const vk::Image& image);
 
-	void CopyBufferToImage(const BufferCopyImageInBundle& in);
+	vk::ImageView CreateImageView(const vk::Device& device, const vk::Image& image, const vk::Format& format, const vk::ImageAspectFlags& aspectFlags, uint32_t mipLevels = 1);
 
-	vk::ImageView CreateImageView(const vk::Device& device, const vk::Image& image, const vk::Format& format, const vk::ImageAspectFlags& aspectFlags);
+	bool IsFormatSupported(const vk::PhysicalDevice& physicalDevice, const vk::Format& format, const vk::ImageTiling& tiling, const vk::FormatFeatureFlags& featureFlags);
 
+	//the first format of the vector that has every feature, the first format when none of them does
 	vk::Format GetSupportedFormat(const vk::PhysicalDevice& physicalDevice, const std::vector<vk::Format>& formatVec, const vk::ImageTiling& tiling, const vk::FormatFeatureFlags& featureFlags);
 }
 
@@ -3,32 +3,59 @@
 #include "Engine/Configuration.h"
 #include "Utils/RenderStructs.h"
 #include "Utils/Buffer.h"
-#include "Rendering/Image.h"
+#include "Rendering/TextureLoader.h"
+#include "Utils/DirtyRanges.h"
+#include "Utils/InstanceLayout.h"
+#include "Utils/Bounds.h"
+#include "Rendering/GeometryPool.h"
+#include "Utils/SlotMap.h"
+#include "Utils/MeshLod.h"
+#include <span>
 
 namespace ave
 {
-	template<vkUtil::Vertex VertexStruct>
+	template<vkUtil::Vertex VertexStruct, vkUtil::InstanceLayout LayoutPolicy = vkUtil::DefaultInstanceLayout>
 	class InstancedMesh final
 	{
 	public:
-		InstancedMesh(vkUtil::MeshInBundle const& in, std::vector<VertexStruct> const& vertexVec, std::vector<uint32_t> const& indexVec, std::vector<glm::mat4> const& positionVec, vkInit::TextureInBundle const& texIn)
-			: m_VertexVec{ vertexVec }
-			, m_IndexVec{ indexVec }
-			, m_Device{ in.Device }
-			, m_PhysicalDevice{ in.PhysicalDevice }
-			, m_TextureUPtr{ std::make_unique<vkInit::Texture>(texIn) }
-			, m_WorldMatrixVec{ positionVec }
+		//the vertices and indices are only read during the constructor, they can point into a mapped cooked file
+		//every lod is a range of the indices, without lods the whole index buffer is the only one
+		//the quantization only matters for compressed vertices, the vertex shader dequantizes their positions with it
+		InstancedMesh(vkUtil::MeshInBundle const& in, GeometryPool<VertexStruct>& geometryPool, std::span<VertexStruct const> vertexSpan, std::span<uint32_t const> indexSpan, std::span<vkUtil::MeshLod const> lodSpan,
+			vkUtil::MeshBounds const& bounds, vkUtil::VertexQuantization const& quantization, std::vector<glm::mat4> const& positionVec, vkInit::TextureHandle texture)
+			: m_GeometryPool{ geometryPool }
+			, m_Texture{ texture }
+			, m_LodVec{ lodSpan.begin(), lodSpan.end() }
+			, m_Bounds{ bounds }
+			, m_Quantization{ quantization }
 		{
-			InitializeVertexBuffer(in.GraphicsQueue, in.MainCommandBuffer);
-			InitializeIndexBuffer(in.GraphicsQueue, in.MainCommandBuffer);
+			if (m_LodVec.empty())
+			{
+				m_LodVec.emplace_back(vkUtil::MeshLod{ 0, static_cast<uint32_t>(indexSpan.size()), 0.f });
+			}
+			m_LodVec.resize(std::min<std::size_t>(m_LodVec.size(), vkUtil::MaxLodCount));
+
+			for (const auto& position : positionVec)
+			{
+				m_Instances.Insert(position);
+			}
+			m_VisibleCount = m_Instances.GetSize();
+
+			//a mesh that does not fit keeps an empty range and draws nothing, HasGeometry tells the owner
+			std::optional<GeometryAllocation> const geometry{ m_GeometryPool.Upload(in, vertexSpan, indexSpan) };
+			if (geometry)
+			{
+				m_Geometry = *geometry;
+				m_HasGeometry = true;
+			}
 		}
 
 		~InstancedMesh()
 		{
-			m_Device.destroyBuffer(m_VertexBuffer.Buffer);
-			m_Device.freeMemory(m_VertexBuffer.BufferMemory);
-			m_Device.destroyBuffer(m_IndexBuffer.Buffer);
-			m_Device.freeMemory(m_IndexBuffer.BufferMemory);
+			if (m_HasGeometry)
+			{
+				m_GeometryPool.Free(m_Geometry);
+			}
 		}
 
 		InstancedMesh(InstancedMesh const& other) = delete;
@@ -36,125 +63,319 @@ namespace ave
 		InstancedMesh& operator=(InstancedMesh const& other) = delete;
 		InstancedMesh& operator=(InstancedMesh&& other) = delete;
 
-		void InitializeVertexBuffer(vk::Queue const& graphicsQueue, vk::CommandBuffer const& mainCommandBuffer)
+		//one command per lod, the instances of lod n start n * lodStride after firstInstance
+		//the instance count of the command is filled in by the culling pass
+		vk::DrawIndexedIndirectCommand GetDrawCommand(uint32_t lodIdx, std::int64_t const& firstInstance, std::int64_t const& lodStride) const
 		{
-			vkUtil::BufferInBundle inBundle{};
-			inBundle.Device = m_Device;
-			inBundle.PhysicalDevice = m_PhysicalDevice;
-			inBundle.Size = sizeof(VertexStruct) * m_VertexVec.size();
-			inBundle.UsageFlags = vk::BufferUsageFlagBits::eTransferSrc;
-			inBundle.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+			vkUtil::MeshLod const& lod{ m_LodVec[lodIdx] };
 
-			vkUtil::DataBuffer stagingBuffer = vkUtil::CreateBuffer(inBundle);
+			vk::DrawIndexedIndirectCommand drawCommand{};
+			//a mesh the pool had no room for draws nothing
+			drawCommand.indexCount = m_Geometry.IndexCount == 0 ? 0 : lod.IndexCount;
+			drawCommand.instanceCount = 0;
+			drawCommand.firstIndex = m_Geometry.FirstIndex + lod.FirstIndex;
+			drawCommand.vertexOffset = m_Geometry.VertexOffset;
+			drawCommand.firstInstance = static_cast<uint32_t>(firstInstance + lodIdx * lodStride);
+			return drawCommand;
+		}
 
-			void* memoryLocation{ m_Device.mapMemory(stagingBuffer.BufferMemory, 0, inBundle.Size) };
-			memcpy(memoryLocation, m_VertexVec.data(), inBundle.Size);
-			m_Device.unmapMemory(stagingBuffer.BufferMemory);
+		uint32_t GetLodCount() const
+		{
+			return static_cast<uint32_t>(m_LodVec.size());
+		}
 
-			inBundle.UsageFlags = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer;
-			inBundle.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
-			m_VertexBuffer = vkUtil::CreateBuffer(inBundle);
+		//distance from which each lod is used, a disabled selection only keeps the full mesh
+		uint32_t GetLodDistances(vkUtil::LodSettings const& lodSettings, std::array<float, vkUtil::MaxLodCount>& lodDistanceArr) const
+		{
+			lodDistanceArr.fill(0.f);
+			if (not lodSettings.Enabled)
+			{
+				return 1;
+			}
+
+			for (uint32_t lodIdx{}; lodIdx < GetLodCount(); ++lodIdx)
+			{
+				lodDistanceArr[lodIdx] = m_LodVec[lodIdx].Error * lodSettings.DistanceScale;
+			}
+			return GetLodCount();
+		}
+
+		void RecordCulling(vk::CommandBuffer const& commandBuffer, vk::PipelineLayout const& cullPipelineLayout, std::int64_t const& firstInstance, std::int64_t const& drawCommandIdx, std::int64_t const& lodStride,
+			bool cullingEnabled, vkUtil::LodSettings const& lodSettings) const
+		{
+			if (m_VisibleCount == 0)
+			{
+				return;
+			}
 
-			vkUtil::CopyBuffer(stagingBuffer, m_VertexBuffer, inBundle.Size, graphicsQueue, mainCommandBuffer);
+			std::array<float, vkUtil::MaxLodCount> lodDistanceArr{};
 
-			m_Device.destroyBuffer(stagingBuffer.Buffer);
-			m_Device.freeMemory(stagingBuffer.BufferMemory);
+			vkUtil::CullPushConstants pushConstants{};
+			pushConstants.BoundingSphere = glm::vec4{ m_Bounds.Center, m_Bounds.Radius };
+			pushConstants.FirstInstance = static_cast<uint32_t>(firstInstance);
+			pushConstants.InstanceCount = static_cast<uint32_t>(m_VisibleCount);
+			pushConstants.DrawCommandIdx = static_cast<uint32_t>(drawCommandIdx);
+			pushConstants.CullingEnabled = cullingEnabled ? 1 : 0;
+			pushConstants.LodCount = GetLodDistances(lodSettings, lodDistanceArr);
+			std::copy(lodDistanceArr.begin(), lodDistanceArr.end(), pushConstants.LodDistanceArr);
+			pushConstants.LodStride = static_cast<uint32_t>(lodStride);
+			pushConstants.LodHysteresis = lodSettings.Hysteresis;
+
+			commandBuffer.pushConstants(cullPipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(vkUtil::CullPushConstants), &pushConstants);
+
+			//has to match local_size_x in Cull.comp
+			uint32_t const groupSize{ 64 };
+			commandBuffer.dispatch((pushConstants.InstanceCount + groupSize - 1) / groupSize, 1, 1);
 		}
-		void InitializeIndexBuffer(vk::Queue const& graphicsQueue, vk::CommandBuffer const& mainCommandBuffer)
+
+		//the geometry pool has to be bound already, draws every lod, the scene draws every mesh at once when multi draw is enabled
+		void Draw(vk::CommandBuffer const& commandBuffer, vk::PipelineLayout const& pipelineLayout, vk::Buffer const& drawCommandBuffer, std::int64_t const& drawCommandIdx) const
 		{
-			vkUtil::BufferInBundle inBundle{};
-			inBundle.Device = m_Device;
-			inBundle.PhysicalDevice = m_PhysicalDevice;
-			inBundle.Size = sizeof(uint32_t) * m_IndexVec.size();
-			inBundle.UsageFlags = vk::BufferUsageFlagBits::eTransferSrc;
-			inBundle.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+			vkUtil::DrawPushConstants pushConstants{};
+			pushConstants.FirstDraw = static_cast<uint32_t>(drawCommandIdx);
+			commandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(vkUtil::DrawPushConstants), &pushConstants);
 
-			vkUtil::DataBuffer stagingBuffer = vkUtil::CreateBuffer(inBundle);
+			vk::DeviceSize const commandOffset{ static_cast<vk::DeviceSize>(drawCommandIdx) * sizeof(vk::DrawIndexedIndirectCommand) };
+			commandBuffer.drawIndexedIndirect(drawCommandBuffer, commandOffset, GetLodCount(), sizeof(vk::DrawIndexedIndirectCommand));
+		}
 
-			void* memoryLocation{ m_Device.mapMemory(stagingBuffer.BufferMemory, 0, inBundle.Size) };
-			memcpy(memoryLocation, m_IndexVec.data(), inBundle.Size);
-			m_Device.unmapMemory(stagingBuffer.BufferMemory);
+		//the scene looks up the slot of the texture for the draw data and releases it with the mesh
+		vkInit::TextureHandle GetTexture() const
+		{
+			return m_Texture;
+		}
 
-			inBundle.UsageFlags = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer;
-			inBundle.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
-			m_IndexBuffer = vkUtil::CreateBuffer(inBundle);
+		GeometryAllocation const& GetGeometry() const
+		{
+			return m_Geometry;
+		}
 
-			vkUtil::CopyBuffer(stagingBuffer, m_IndexBuffer, inBundle.Size, graphicsQueue, mainCommandBuffer);
+		//false when the geometry pool was full
+		bool HasGeometry() const
+		{
+			return m_HasGeometry;
+		}
 
-			m_Device.destroyBuffer(stagingBuffer.Buffer);
-			m_Device.freeMemory(stagingBuffer.BufferMemory);
+		//only the visible instances
+		std::span<glm::mat4 const> GetWorldMatrices() const
+		{
+			return std::span<glm::mat4 const>{ m_Instances.GetDense().data(), static_cast<std::size_t>(m_VisibleCount) };
 		}
 
-		void Draw(vk::CommandBuffer const& commandBuffer, vk::PipelineLayout const& pipelineLayout, std::int64_t const& startOffset) const
+		vkUtil::MeshBounds const& GetBounds() const
 		{
-			vk::Buffer vertexBufferArr[]{ m_VertexBuffer.Buffer };
-			vk::DeviceSize offsetArr[]{ 0 };
-			commandBuffer.bindVertexBuffers(0, 1, vertexBufferArr, offsetArr);
-			commandBuffer.bindIndexBuffer(m_IndexBuffer.Buffer, 0, vk::IndexType::eUint32);
+			return m_Bounds;
+		}
 
-			if (m_TextureUPtr)
+		//diameter in pixels of the bounding sphere of the instance closest to the camera, 0 without visible instances
+		//projectionScale turns a size at a distance of 1 into pixels, a camera inside a sphere gets the full projection scale
+		float GetMaxProjectedDiameter(glm::vec3 const& cameraPosition, float projectionScale) const
+		{
+			float maxDiameter{};
+			for (const auto& worldMatrix : GetWorldMatrices())
 			{
-				m_TextureUPtr->Apply(commandBuffer, pipelineLayout);
-			}
+				//the sphere has to keep enclosing the mesh under non uniform scale, like in the culler
+				float const scaleSquared{ std::max({ glm::dot(glm::vec3{ worldMatrix[0] }, glm::vec3{ worldMatrix[0] }),
+					glm::dot(glm::vec3{ worldMatrix[1] }, glm::vec3{ worldMatrix[1] }),
+					glm::dot(glm::vec3{ worldMatrix[2] }, glm::vec3{ worldMatrix[2] }) }) };
+				float const radius{ m_Bounds.Radius * std::sqrt(scaleSquared) };
+				glm::vec3 const center{ worldMatrix * glm::vec4{ m_Bounds.Center, 1.f } };
 
-			commandBuffer.drawIndexed(std::ssize(m_IndexVec), std::ssize(m_WorldMatrixVec), 0, 0, startOffset);
+				float const distance{ std::max(glm::length(center - cameraPosition), radius) };
+				maxDiameter = std::max(maxDiameter, 2.f * radius * projectionScale / std::max(distance, 1e-6f));
+			}
+			return maxDiameter;
 		}
 
-		std::vector<glm::mat4> const& GetPositions()
+		vkUtil::VertexQuantization const& GetQuantization() const
 		{
-			return m_WorldMatrixVec;
+			return m_Quantization;
 		}
 
+		//instances that get rendered, hidden ones are not counted
 		std::int64_t GetInstanceCount() const
 		{
-			return std::ssize(m_WorldMatrixVec);
+			return m_VisibleCount;
 		}
 
-		void RotateInstance(std::int64_t const& idx, float angle, glm::vec3 const& axis)
+		void SetFrameCount(int frameCount)
 		{
-			if (std::ssize(m_WorldMatrixVec) == 0) return;
-			m_WorldMatrixVec[idx] = glm::rotate(m_WorldMatrixVec[idx], glm::radians(angle), axis);
+			m_DirtyRanges.SetFrameCount(frameCount, m_VisibleCount);
 		}
 
-		void ScaleInstance(std::int64_t const& idx, glm::vec3 const& scaleVec)
+		//encodes the instances the frame has not seen yet into its mapped segment of the instance buffer, returns the bytes written
+		std::size_t WriteWorldMatrices(int frameIdx, typename LayoutPolicy::GPUInstance* segmentWriteLocationPtr, bool writeAll)
 		{
-			if (std::ssize(m_WorldMatrixVec) == 0) return;
-			m_WorldMatrixVec[idx] = glm::scale(m_WorldMatrixVec[idx], scaleVec);
+			std::vector<vkUtil::InstanceRange> rangeVec{ m_DirtyRanges.ConsumeRanges(frameIdx) };
+			if (writeAll)
+			{
+				rangeVec.assign(1, vkUtil::InstanceRange{ 0, m_VisibleCount });
+			}
+
+			std::size_t writtenBytes{};
+			for (const auto& range : rangeVec)
+			{
+				std::int64_t const end{ std::min(range.End, m_VisibleCount) };
+				if (range.Begin >= end)
+				{
+					continue;
+				}
+
+				if constexpr (std::is_same_v<typename LayoutPolicy::GPUInstance, glm::mat4>)
+				{
+					memcpy(segmentWriteLocationPtr + range.Begin, m_Instances.GetDense().data() + range.Begin, static_cast<std::size_t>(end - range.Begin) * sizeof(glm::mat4));
+				}
+				else
+				{
+					std::transform(m_Instances.GetDense().begin() + range.Begin, m_Instances.GetDense().begin() + end, segmentWriteLocationPtr + range.Begin, &LayoutPolicy::Encode);
+				}
+				writtenBytes += static_cast<std::size_t>(end - range.Begin) * sizeof(typename LayoutPolicy::GPUInstance);
+			}
+			return writtenBytes;
 		}
 
-		void TranslateInstance(std::int64_t const& idx, glm::vec3 const& translateVec)
+		//a new instance is visible and written to the frames like any other changed instance
+		vkUtil::SlotHandle AddInstance(glm::mat4 const& worldMatrix)
 		{
-			if (std::ssize(m_WorldMatrixVec) == 0) return;
-			m_WorldMatrixVec[idx] = glm::translate(m_WorldMatrixVec[idx], translateVec);
+			vkUtil::SlotHandle const handle{ m_Instances.Insert(worldMatrix) };
+			ShowInstance(static_cast<uint32_t>(m_Instances.GetSize() - 1));
+			return handle;
 		}
 
-		void AddInstance(glm::mat4 const& worldMatrix)
+		//the last visible instance takes the place of the removed one, so only that one has to be written again
+		bool RemoveInstance(vkUtil::SlotHandle const& handle)
 		{
-			m_WorldMatrixVec.emplace_back(worldMatrix);
+			std::optional<uint32_t> const denseIdx{ m_Instances.GetDenseIdx(handle) };
+			if (not denseIdx.has_value())
+			{
+				return false;
+			}
+
+			if (denseIdx.value() < m_VisibleCount)
+			{
+				HideInstance(denseIdx.value());
+			}
+			return m_Instances.Erase(handle);
 		}
 
-		void RemoveInstance(int instanceIdx)
+		//a hidden instance keeps its handle and transform but is left out of the instance buffers
+		bool SetInstanceHidden(vkUtil::SlotHandle const& handle, bool hidden)
 		{
-			if (std::ssize(m_WorldMatrixVec) == 0)
+			std::optional<uint32_t> const denseIdx{ m_Instances.GetDenseIdx(handle) };
+			if (not denseIdx.has_value())
 			{
-				return;
+				return false;
+			}
+
+			bool const isHidden{ denseIdx.value() >= m_VisibleCount };
+			if (hidden and not isHidden)
+			{
+				HideInstance(denseIdx.value());
+			}
+			else if (not hidden and isHidden)
+			{
+				ShowInstance(denseIdx.value());
+			}
+			return true;
+		}
+
+		bool IsInstanceHidden(vkUtil::SlotHandle const& handle) const
+		{
+			std::optional<uint32_t> const denseIdx{ m_Instances.GetDenseIdx(handle) };
+			return denseIdx.has_value() and denseIdx.value() >= m_VisibleCount;
+		}
+
+		bool ContainsInstance(vkUtil::SlotHandle const& handle) const
+		{
+			return m_Instances.Contains(handle);
+		}
+
+		//handle of the instance at a position of the packed array, hidden instances come after the visible ones
+		vkUtil::SlotHandle GetInstanceHandle(std::int64_t const& idx) const
+		{
+			if (idx < 0 or idx >= m_Instances.GetSize())
+			{
+				return vkUtil::SlotHandle{};
 			}
+			return m_Instances.GetHandle(static_cast<uint32_t>(idx));
+		}
+
+		bool RotateInstance(vkUtil::SlotHandle const& handle, float angle, glm::vec3 const& axis)
+		{
+			return UpdateInstance(handle, [&](glm::mat4 const& worldMatrix) { return glm::rotate(worldMatrix, glm::radians(angle), axis); });
+		}
+
+		bool ScaleInstance(vkUtil::SlotHandle const& handle, glm::vec3 const& scaleVec)
+		{
+			return UpdateInstance(handle, [&](glm::mat4 const& worldMatrix) { return glm::scale(worldMatrix, scaleVec); });
+		}
+
+		bool TranslateInstance(vkUtil::SlotHandle const& handle, glm::vec3 const& translateVec)
+		{
+			return UpdateInstance(handle, [&](glm::mat4 const& worldMatrix) { return glm::translate(worldMatrix, translateVec); });
+		}
+
+		bool SetInstanceWorldMatrix(vkUtil::SlotHandle const& handle, glm::mat4 const& worldMatrix)
+		{
+			return UpdateInstance(handle, [&](glm::mat4 const&) { return worldMatrix; });
+		}
 
-			m_WorldMatrixVec.erase(m_WorldMatrixVec.begin() + instanceIdx);
+		std::size_t GetHostInstanceBytes() const
+		{
+			return m_Instances.GetHostBytes();
 		}
 	private:
-		std::vector<VertexStruct> m_VertexVec;
-		vkUtil::DataBuffer m_VertexBuffer;
+		GeometryPool<VertexStruct>& m_GeometryPool;
+		GeometryAllocation m_Geometry;
+		bool m_HasGeometry{ false };
+
+		vkInit::TextureHandle m_Texture;
+		//index ranges relative to the geometry allocation, the first one is the full mesh
+		std::vector<vkUtil::MeshLod> m_LodVec;
+		//world matrices of every instance, the first m_VisibleCount are the ones that get rendered
+		vkUtil::SlotMap<glm::mat4> m_Instances;
+		std::int64_t m_VisibleCount{};
+		vkUtil::DirtyRangeTracker m_DirtyRanges;
+
+		vkUtil::MeshBounds m_Bounds;
+		vkUtil::VertexQuantization m_Quantization;
+
+		template<typename Update>
+		bool UpdateInstance(vkUtil::SlotHandle const& handle, Update update)
+		{
+			std::optional<uint32_t> const denseIdx{ m_Instances.GetDenseIdx(handle) };
+			if (not denseIdx.has_value())
+			{
+				return false;
+			}
 
-		std::vector<uint32_t> m_IndexVec;
-		vkUtil::DataBuffer m_IndexBuffer;
+			m_Instances[denseIdx.value()] = update(m_Instances[denseIdx.value()]);
+			//a hidden instance is written when it is shown again
+			if (denseIdx.value() < m_VisibleCount)
+			{
+				m_DirtyRanges.MarkDirty(denseIdx.value(), denseIdx.value() + 1);
+			}
+			return true;
+		}
 
-		vk::Device m_Device;
-		vk::PhysicalDevice m_PhysicalDevice;
+		//swaps the instance with the first hidden one and grows the visible range over it
+		void ShowInstance(uint32_t denseIdx)
+		{
+			m_Instances.SwapDense(denseIdx, static_cast<uint32_t>(m_VisibleCount));
+			++m_VisibleCount;
+			m_DirtyRanges.MarkDirty(m_VisibleCount - 1, m_VisibleCount);
+		}
 
-		std::unique_ptr<vkInit::Texture> m_TextureUPtr{ nullptr };
-		//static position vector per vertex type
-		std::vector<glm::mat4> m_WorldMatrixVec;
+		//swaps the instance with the last visible one and shrinks the visible range
+		void HideInstance(uint32_t denseIdx)
+		{
+			--m_VisibleCount;
+			m_Instances.SwapDense(denseIdx, static_cast<uint32_t>(m_VisibleCount));
+			if (denseIdx < m_VisibleCount)
+			{
+				m_DirtyRanges.MarkDirty(denseIdx, denseIdx + 1);
+			}
+		}
 	};
 }
 
@@ -3,55 +3,284 @@
 #include "Engine/Configuration.h"
 #include "InstancedMesh.h"
 #include "Engine/Clock.h"
+#include "Utils/Culling.h"
+#include "Rendering/TextureLoader.h"
 
 namespace ave
 {
-	template<vkUtil::Vertex VertexStruct>
+	//an instance of one mesh of the scene, the mesh index shifts when a mesh in front of it is removed
+	struct InstanceHandle
+	{
+		int MeshIdx{ -1 };
+		vkUtil::SlotHandle Slot;
+	};
+
+	template<vkUtil::Vertex VertexStruct, vkUtil::InstanceLayout LayoutPolicy = vkUtil::DefaultInstanceLayout>
 	class InstancedScene final
 	{
 	public:
-		InstancedScene() = default;
-		~InstancedScene() = default;
+		//every mesh of the scene has to live in this pool, it is bound once for the whole scene
+		//the textures of the meshes come from the loader, the draw data picks up their slot once they are resident
+		InstancedScene(GeometryPool<VertexStruct> const& geometryPool, vkInit::TextureLoader& textureLoader)
+			: m_GeometryPool{ geometryPool }
+			, m_TextureLoader{ textureLoader }
+		{
+		}
+
+		~InstancedScene()
+		{
+			for (const auto& mesh : m_InstancedMeshUPtrVec)
+			{
+				m_TextureLoader.Release(mesh->GetTexture());
+			}
+		}
 
-		void AddMesh(std::unique_ptr<ave::InstancedMesh<VertexStruct>> meshUPtr)
+		//the scene takes over the texture handle of the mesh
+		//a mesh whose geometry did not fit in the pool is not added and its texture is released, returns false then
+		bool AddMesh(std::unique_ptr<ave::InstancedMesh<VertexStruct, LayoutPolicy>> meshUPtr)
 		{
+			if (not meshUPtr->HasGeometry())
+			{
+				m_TextureLoader.Release(meshUPtr->GetTexture());
+				return false;
+			}
+
+			meshUPtr->SetFrameCount(m_FrameCount);
+
 			m_InstancedMeshUPtrVec.emplace_back(std::move(meshUPtr));
+			return true;
 		}
 
 		void RemoveMesh(int idx)
 		{
-			m_WorldMatricesVec.erase(m_WorldMatricesVec.begin() + idx);
+			m_TextureLoader.Release(m_InstancedMeshUPtrVec[idx]->GetTexture());
+			m_InstancedMeshUPtrVec.erase(m_InstancedMeshUPtrVec.begin() + idx);
+
+			//meshes behind the removed one no longer match what any frame uploaded
+			for (auto& uploadedOffsetVec : m_FrameMeshOffsetVec)
+			{
+				uploadedOffsetVec.resize(std::min(uploadedOffsetVec.size(), static_cast<std::size_t>(idx)));
+			}
+		}
+
+		//has to be called whenever the frame instance buffers are (re)created, they start out empty
+		void SetFrameCount(int frameCount)
+		{
+			m_FrameCount = frameCount;
+			m_FrameMeshOffsetVec.assign(frameCount, std::vector<std::int64_t>{});
+
+			for (const auto& mesh : m_InstancedMeshUPtrVec)
+			{
+				mesh->SetFrameCount(frameCount);
+			}
+		}
+
+		//has to be called when the instance buffer of the frame was reallocated, the new buffer gets every mesh written again
+		void InvalidateFrame(int frameIdx)
+		{
+			m_FrameMeshOffsetVec[frameIdx].clear();
 		}
 
-		std::vector<glm::mat4> const& GetWorldMatrices()
+		//writes every instance range the frame has not seen yet straight into its mapped instance buffer, a mesh that moved inside the buffer is written completely
+		//the instances of the scene start at firstInstance, a scene behind another one moves along when the one in front of it grows
+		std::size_t WriteWorldMatrices(int frameIdx, void* writeLocationPtr, std::int64_t const& firstInstance)
 		{
-			if (m_DirtyFlagWorldMatrices)
+			using GPUInstance = typename LayoutPolicy::GPUInstance;
+			GPUInstance* instanceWriteLocationPtr{ static_cast<GPUInstance*>(writeLocationPtr) };
+			std::vector<std::int64_t>& uploadedOffsetVec{ m_FrameMeshOffsetVec[frameIdx] };
+			uploadedOffsetVec.resize(m_InstancedMeshUPtrVec.size(), -1);
+
+			std::size_t writtenBytes{};
+			std::int64_t offset{ firstInstance };
+			for (int meshIdx{}; meshIdx < std::ssize(m_InstancedMeshUPtrVec); ++meshIdx)
 			{
-				m_WorldMatricesVec.clear();
-				m_WorldMatricesVec.reserve(100'000);
+				const auto& mesh{ m_InstancedMeshUPtrVec[meshIdx] };
+
+				bool const meshMoved{ uploadedOffsetVec[meshIdx] != offset };
+				writtenBytes += mesh->WriteWorldMatrices(frameIdx, instanceWriteLocationPtr + offset, meshMoved);
+				uploadedOffsetVec[meshIdx] = offset;
+
+				offset += mesh->GetInstanceCount();
+			}
 
-				int idx{};
-				for (const auto& mesh : m_InstancedMeshUPtrVec)
+			return writtenBytes;
+		}
+
+		void SetMultiDrawEnabled(bool multiDrawEnabled)
+		{
+			m_MultiDrawEnabled = multiDrawEnabled;
+		}
+
+
+		//one command and one draw data entry per lod of every mesh, returns the amount of commands written
+		//the visible indices of lod n of every mesh start n * lodStride entries after those of its lod 0
+		std::int64_t WriteDrawCommands(vk::DrawIndexedIndirectCommand* commandWriteLocationPtr, vkUtil::DrawData* drawDataWriteLocationPtr, std::int64_t const& firstInstance, std::int64_t const& lodStride) const
+		{
+			std::int64_t offset{ firstInstance };
+			for (int meshIdx{}; meshIdx < std::ssize(m_InstancedMeshUPtrVec); ++meshIdx)
+			{
+				const auto& mesh{ m_InstancedMeshUPtrVec[meshIdx] };
+				for (uint32_t lodIdx{}; lodIdx < mesh->GetLodCount(); ++lodIdx)
 				{
-					for (const auto& worldMatrix : mesh->GetPositions())
-					{
-						m_WorldMatricesVec.emplace_back(worldMatrix);
-					}
+					*commandWriteLocationPtr++ = mesh->GetDrawCommand(lodIdx, offset, lodStride);
+
+					vkUtil::DrawData drawData{};
+					drawData.TextureIdx = m_TextureLoader.GetTextureIdx(mesh->GetTexture());
+					drawData.PositionOffset = mesh->GetQuantization().Offset;
+					drawData.PositionScale = mesh->GetQuantization().Scale;
+					*drawDataWriteLocationPtr++ = drawData;
 				}
-				m_DirtyFlagWorldMatrices = false;
+
+				offset += mesh->GetInstanceCount();
 			}
-			return m_WorldMatricesVec;
+			return GetDrawCommandCount();
 		}
 
-		std::int64_t Draw(vk::CommandBuffer const& commandBuffer, vk::PipelineLayout const& pipelineLayout, std::int64_t const& instancesDrawn)
+		//asks the loader for the texture levels the closest instance of every mesh needs
+		//assumes the texture is spread over the mesh once, so a texel per pixel across the bounding sphere
+		void RequestTextureResolutions(glm::vec3 const& cameraPosition, float projectionScale) const
 		{
-			std::int64_t offset{ instancesDrawn };
 			for (const auto& mesh : m_InstancedMeshUPtrVec)
 			{
-				mesh->Draw(commandBuffer, pipelineLayout, offset);
-				offset += std::ssize(mesh->GetPositions());
+				float const diameter{ mesh->GetMaxProjectedDiameter(cameraPosition, projectionScale) };
+				if (diameter > 0.f)
+				{
+					m_TextureLoader.RequestResolution(mesh->GetTexture(), diameter);
+				}
 			}
-			return offset;
+		}
+
+		std::int64_t GetDrawCommandCount() const
+		{
+			std::int64_t drawCommandCount{};
+			for (const auto& mesh : m_InstancedMeshUPtrVec)
+			{
+				drawCommandCount += mesh->GetLodCount();
+			}
+			return drawCommandCount;
+		}
+
+		std::int64_t GetInstanceCount() const
+		{
+			std::int64_t instanceCount{};
+			for (const auto& mesh : m_InstancedMeshUPtrVec)
+			{
+				instanceCount += mesh->GetInstanceCount();
+			}
+			return instanceCount;
+		}
+
+		//world matrices and slots kept on the host to write the instance buffers and cull from
+		std::size_t GetHostInstanceBytes() const
+		{
+			std::size_t hostBytes{};
+			for (const auto& mesh : m_InstancedMeshUPtrVec)
+			{
+				hostBytes += mesh->GetHostInstanceBytes();
+			}
+			return hostBytes;
+		}
+
+		//the cull pipeline and the frame descriptor set have to be bound already
+		void RecordCulling(vk::CommandBuffer const& commandBuffer, vk::PipelineLayout const& cullPipelineLayout, std::int64_t const& firstInstance, std::int64_t const& firstDrawCommand, std::int64_t const& lodStride,
+			bool cullingEnabled, vkUtil::LodSettings const& lodSettings) const
+		{
+			std::int64_t offset{ firstInstance };
+			std::int64_t drawCommandIdx{ firstDrawCommand };
+			for (const auto& mesh : m_InstancedMeshUPtrVec)
+			{
+				mesh->RecordCulling(commandBuffer, cullPipelineLayout, offset, drawCommandIdx, lodStride, cullingEnabled, lodSettings);
+				offset += mesh->GetInstanceCount();
+				drawCommandIdx += mesh->GetLodCount();
+			}
+		}
+
+		//cpu alternative to RecordCulling, selects the lods and writes the visible indices and the instance counts of the draw commands into the mapped frame buffers
+		//lodStatePtr is the lod of every instance from the last selection of the frame, indexed like the instance buffer
+		//returns the number of visible instances
+		std::int64_t CullInstances(std::array<glm::vec4, 6> const& frustumPlaneArr, vkUtil::LodSettings const& lodSettings, uint32_t* lodStatePtr, std::int64_t const& lodStride,
+			uint32_t* visibleIdxPtr, vk::DrawIndexedIndirectCommand* commandWriteLocationPtr, std::int64_t const& firstInstance)
+		{
+			std::int64_t offset{ firstInstance };
+			std::int64_t visibleInstances{};
+			for (const auto& mesh : m_InstancedMeshUPtrVec)
+			{
+				std::array<float, vkUtil::MaxLodCount> lodDistanceArr{};
+				uint32_t const lodCount{ mesh->GetLodDistances(lodSettings, lodDistanceArr) };
+
+				vkUtil::LodCullInBundle lodIn{};
+				lodIn.LodDistanceSpan = std::span<float const>{ lodDistanceArr.data(), lodCount };
+				lodIn.Hysteresis = lodSettings.Hysteresis;
+				lodIn.CameraPosition = lodSettings.CameraPosition;
+				lodIn.LodStatePtr = lodStatePtr + offset;
+				lodIn.LodStride = lodStride;
+
+				std::array<uint32_t, vkUtil::MaxLodCount> lodVisibleCountArr{};
+				visibleInstances += m_Culler.Cull(frustumPlaneArr, mesh->GetBounds(), mesh->GetWorldMatrices(), static_cast<uint32_t>(offset), lodIn, visibleIdxPtr + offset, lodVisibleCountArr);
+				for (uint32_t lodIdx{}; lodIdx < mesh->GetLodCount(); ++lodIdx)
+				{
+					(commandWriteLocationPtr++)->instanceCount = lodVisibleCountArr[lodIdx];
+				}
+
+				offset += mesh->GetInstanceCount();
+			}
+			return visibleInstances;
+		}
+
+		//the texture descriptor set has to be bound already, returns the draw command index after the last lod of the last mesh
+		std::int64_t Draw(vk::CommandBuffer const& commandBuffer, vk::PipelineLayout const& pipelineLayout, vk::Buffer const& drawCommandBuffer, std::int64_t const& firstDrawCommand) const
+		{
+			return DrawMeshes(commandBuffer, pipelineLayout, drawCommandBuffer, firstDrawCommand, 0, GetMeshCount());
+		}
+
+		//only the meshes in [firstMesh, endMesh), so several command buffers can each record a part of the scene
+		//firstDrawCommand is the one of the first mesh of the scene, returns the draw command index after the last lod of the last mesh of the range
+		std::int64_t DrawMeshes(vk::CommandBuffer const& commandBuffer, vk::PipelineLayout const& pipelineLayout, vk::Buffer const& drawCommandBuffer, std::int64_t const& firstDrawCommand,
+			int firstMesh, int endMesh) const
+		{
+			std::int64_t drawCommandIdx{ firstDrawCommand };
+			for (int meshIdx{}; meshIdx < firstMesh; ++meshIdx)
+			{
+				drawCommandIdx += m_InstancedMeshUPtrVec[meshIdx]->GetLodCount();
+			}
+
+			if (firstMesh >= endMesh)
+			{
+				return drawCommandIdx;
+			}
+
+			m_GeometryPool.Bind(commandBuffer);
+
+			if (not m_MultiDrawEnabled)
+			{
+				for (int meshIdx{ firstMesh }; meshIdx < endMesh; ++meshIdx)
+				{
+					m_InstancedMeshUPtrVec[meshIdx]->Draw(commandBuffer, pipelineLayout, drawCommandBuffer, drawCommandIdx);
+					drawCommandIdx += m_InstancedMeshUPtrVec[meshIdx]->GetLodCount();
+				}
+				return drawCommandIdx;
+			}
+
+			//the draw commands of the meshes are contiguous, the range is one multi draw
+			uint32_t drawCount{};
+			for (int meshIdx{ firstMesh }; meshIdx < endMesh; ++meshIdx)
+			{
+				drawCount += m_InstancedMeshUPtrVec[meshIdx]->GetLodCount();
+			}
+
+			vkUtil::DrawPushConstants pushConstants{};
+			pushConstants.FirstDraw = static_cast<uint32_t>(drawCommandIdx);
+			commandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(vkUtil::DrawPushConstants), &pushConstants);
+
+			vk::DeviceSize const commandOffset{ static_cast<vk::DeviceSize>(drawCommandIdx) * sizeof(vk::DrawIndexedIndirectCommand) };
+			commandBuffer.drawIndexedIndirect(drawCommandBuffer, commandOffset, drawCount, sizeof(vk::DrawIndexedIndirectCommand));
+
+			return drawCommandIdx + drawCount;
+		}
+
+		int GetMeshCount() const
+		{
+			return static_cast<int>(m_InstancedMeshUPtrVec.size());
 		}
 
 		InstancedScene(InstancedScene const& other) = delete;
@@ -59,45 +288,82 @@ namespace ave
 		InstancedScene& operator=(InstancedScene const& other) = delete;
 		InstancedScene& operator=(InstancedScene&& other) = delete;
 
-		void RotateMeshInstance(int meshIdx, float angle, glm::vec3 const& axis, int instanceIdx = 0)
+		//the handle stays valid while other instances are added, removed or hidden, it is invalid when the scene has no such mesh
+		InstanceHandle AddInstance(int meshIdx, glm::mat4 const& worldMatrix = glm::mat4{ 1.f })
 		{
-			m_InstancedMeshUPtrVec[meshIdx]->RotateInstance(instanceIdx, angle, axis);
-			
-			m_DirtyFlagWorldMatrices = true;
+			if (not IsValidMesh(InstanceHandle{ meshIdx }))
+			{
+				return InstanceHandle{};
+			}
+			return InstanceHandle{ meshIdx, m_InstancedMeshUPtrVec[meshIdx]->AddInstance(worldMatrix) };
 		}
 
-		void ScaleMeshInstance(int meshIdx, glm::vec3 const& scaleVec, int instanceIdx = 0)
+		bool RemoveInstance(InstanceHandle const& handle)
 		{
-			m_InstancedMeshUPtrVec[meshIdx]->ScaleInstance(instanceIdx, scaleVec);
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->RemoveInstance(handle.Slot);
+		}
 
-			m_DirtyFlagWorldMatrices = true;
+		bool SetInstanceHidden(InstanceHandle const& handle, bool hidden)
+		{
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->SetInstanceHidden(handle.Slot, hidden);
 		}
 
-		void TranslateMeshInstance(int meshIdx, glm::vec3 const& translationVec, int instanceIdx = 0)
+		bool IsInstanceHidden(InstanceHandle const& handle) const
 		{
-			m_InstancedMeshUPtrVec[meshIdx]->TranslateInstance(instanceIdx, translationVec);
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->IsInstanceHidden(handle.Slot);
+		}
 
-			m_DirtyFlagWorldMatrices = true;
+		bool ContainsInstance(InstanceHandle const& handle) const
+		{
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->ContainsInstance(handle.Slot);
 		}
 
-		void AddInstanceToMesh(int meshIdx)
+		//handle of the instance that currently sits at instanceIdx of the mesh, invalid when there is none
+		InstanceHandle GetInstanceHandle(int meshIdx, int instanceIdx) const
 		{
-			m_InstancedMeshUPtrVec[meshIdx]->AddInstance(glm::mat4(1.f));
+			if (not IsValidMesh(InstanceHandle{ meshIdx }))
+			{
+				return InstanceHandle{};
+			}
+			return InstanceHandle{ meshIdx, m_InstancedMeshUPtrVec[meshIdx]->GetInstanceHandle(instanceIdx) };
+		}
 
-			m_DirtyFlagWorldMatrices = true;
+		bool RotateInstance(InstanceHandle const& handle, float angle, glm::vec3 const& axis)
+		{
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->RotateInstance(handle.Slot, angle, axis);
 		}
 
-		void RemoveInstanceFromMesh(int meshIdx, int instanceIdx = 0)
+		bool ScaleInstance(InstanceHandle const& handle, glm::vec3 const& scaleVec)
 		{
-			m_InstancedMeshUPtrVec[meshIdx]->RemoveInstance(instanceIdx);
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->ScaleInstance(handle.Slot, scaleVec);
+		}
 
-			m_DirtyFlagWorldMatrices = true;
+		bool TranslateInstance(InstanceHandle const& handle, glm::vec3 const& translationVec)
+		{
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->TranslateInstance(handle.Slot, translationVec);
+		}
+
+		bool SetInstanceWorldMatrix(InstanceHandle const& handle, glm::mat4 const& worldMatrix)
+		{
+			return IsValidMesh(handle) and m_InstancedMeshUPtrVec[handle.MeshIdx]->SetInstanceWorldMatrix(handle.Slot, worldMatrix);
 		}
 	private:
-		std::vector<std::unique_ptr<ave::InstancedMesh<VertexStruct>>> m_InstancedMeshUPtrVec;
+		std::vector<std::unique_ptr<ave::InstancedMesh<VertexStruct, LayoutPolicy>>> m_InstancedMeshUPtrVec;
+
+		int m_FrameCount{};
+		//per frame, the offset each mesh had when it was last uploaded
+		std::vector<std::vector<std::int64_t>> m_FrameMeshOffsetVec;
+
+		vkUtil::InstanceCuller m_Culler;
 
-		std::vector<glm::mat4> m_WorldMatricesVec;
-		bool m_DirtyFlagWorldMatrices{ true };
+		GeometryPool<VertexStruct> const& m_GeometryPool;
+		vkInit::TextureLoader& m_TextureLoader;
+		bool m_MultiDrawEnabled{ true };
+
+		bool IsValidMesh(InstanceHandle const& handle) const
+		{
+			return handle.MeshIdx >= 0 and handle.MeshIdx < std::ssize(m_InstancedMeshUPtrVec);
+		}
 	};
 }
 
@@ -0,0 +1,475 @@
+#include "TextureLoader.h"
+#include "Engine/ThreadPool.h"
+#include "Utils/BlockCompression.h"
+
+vkInit::TextureLoader::TextureLoader(TextureLoaderInBundle const& in)
+	: m_Device{ in.Device }
+	, m_PhysicalDevice{ in.PhysicalDevice }
+	, m_UploadContextPtr{ in.UploadContextPtr }
+	, m_TextureSet{ *in.TextureSetPtr }
+	, m_Filtering{ in.Filtering }
+	, m_MemoryBudget{ in.MemoryBudget }
+{
+	for (std::size_t filteringIdx{}; filteringIdx < m_SamplerArr.size(); ++filteringIdx)
+	{
+		m_SamplerArr[filteringIdx] = CreateSampler(m_Device, m_PhysicalDevice, static_cast<TextureFiltering>(filteringIdx));
+	}
+
+	//bc is what desktop gpus sample, astc what mobile ones do, a device without either gets the rgba8 source images
+	std::vector<vk::Format> const candidateFormatVec
+	{
+		vk::Format::eBc7UnormBlock, vk::Format::eBc7SrgbBlock,
+		vk::Format::eBc1RgbUnormBlock, vk::Format::eBc1RgbSrgbBlock, vk::Format::eBc1RgbaUnormBlock, vk::Format::eBc1RgbaSrgbBlock,
+		vk::Format::eBc3UnormBlock, vk::Format::eBc3SrgbBlock, vk::Format::eBc5UnormBlock,
+		vk::Format::eAstc4x4UnormBlock, vk::Format::eAstc4x4SrgbBlock,
+		vk::Format::eAstc6x6UnormBlock, vk::Format::eAstc6x6SrgbBlock,
+		vk::Format::eAstc8x8UnormBlock, vk::Format::eAstc8x8SrgbBlock,
+		vk::Format::eR8G8B8A8Unorm, vk::Format::eR8G8B8A8Srgb
+	};
+	vk::FormatFeatureFlags const featureFlags{ vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear | vk::FormatFeatureFlagBits::eTransferDst };
+
+	std::cout << "Texture formats:";
+	for (const auto& format : candidateFormatVec)
+	{
+		if (IsFormatSupported(m_PhysicalDevice, format, vk::ImageTiling::eOptimal, featureFlags))
+		{
+			m_SupportedFormatVec.emplace_back(format);
+			std::cout << " " << vk::to_string(format);
+		}
+	}
+	std::cout << "\n";
+
+	TextureInBundle textureIn{};
+	textureIn.Device = m_Device;
+	textureIn.PhysicalDevice = m_PhysicalDevice;
+	textureIn.FileName = "placeholder";
+	textureIn.UploadContextPtr = m_UploadContextPtr;
+
+	//grey, so a mesh whose texture is missing still shows its shading
+	DecodedTexture placeholder{};
+	placeholder.Width = 1;
+	placeholder.Height = 1;
+	placeholder.PixelVec = { 160, 160, 160, 255 };
+
+	//goes out with the next submit of the upload context, like the geometry of the scene
+	m_PlaceholderUPtr = std::make_unique<Texture>(textureIn, placeholder);
+	m_PlaceholderIdx = m_TextureSet.Register(m_PlaceholderUPtr->GetDescriptorImageInfo(GetSampler())).value_or(0);
+}
+
+vkInit::TextureLoader::~TextureLoader()
+{
+	for (auto const& entry : m_TextureVec)
+	{
+		if (entry.TextureIdx)
+		{
+			m_TextureSet.Release(*entry.TextureIdx);
+		}
+	}
+
+	for (auto const& retired : m_RetiredVec)
+	{
+		if (retired.TextureIdx)
+		{
+			m_TextureSet.Release(*retired.TextureIdx);
+		}
+	}
+
+	m_TextureSet.Release(m_PlaceholderIdx);
+
+	for (auto const& sampler : m_SamplerArr)
+	{
+		m_Device.destroySampler(sampler);
+	}
+}
+
+vkInit::TextureHandle vkInit::TextureLoader::Load(std::string const& fileName)
+{
+	auto const handleIt{ m_HandleMap.find(fileName) };
+	if (handleIt != m_HandleMap.end())
+	{
+		++m_TextureVec[handleIt->second].UseCount;
+		return handleIt->second;
+	}
+
+	TextureHandle handle{};
+	if (m_FreeHandleVec.empty())
+	{
+		handle = static_cast<TextureHandle>(m_TextureVec.size());
+		m_TextureVec.emplace_back();
+	}
+	else
+	{
+		handle = m_FreeHandleVec.back();
+		m_FreeHandleVec.pop_back();
+	}
+
+	TextureEntry& entry{ m_TextureVec[handle] };
+	entry.FileName = fileName;
+	entry.UseCount = 1;
+	entry.State = TextureState::Decoding;
+	entry.DecodeFuture = ave::ThreadPool::GetInstance().Async([fileName, supportedFormatVec = m_SupportedFormatVec]() { return DecodeTexture(fileName, supportedFormatVec); });
+	entry.LoadTimePoint = std::chrono::high_resolution_clock::now();
+
+	m_HandleMap.emplace(fileName, handle);
+	return handle;
+}
+
+void vkInit::TextureLoader::Release(TextureHandle handle)
+{
+	TextureEntry& entry{ m_TextureVec[handle] };
+	if (--entry.UseCount > 0)
+	{
+		return;
+	}
+
+	//a texture that is still decoding is dropped with its future, the worker finishes it for nothing
+	if (entry.TextureUPtr or entry.TextureIdx)
+	{
+		m_RetiredVec.emplace_back(RetiredTexture{ std::move(entry.TextureUPtr), entry.TextureIdx, m_FramesInFlight });
+	}
+
+	if (entry.StreamingUPtr)
+	{
+		m_RetiredVec.emplace_back(RetiredTexture{ std::move(entry.StreamingUPtr), std::nullopt, m_FramesInFlight });
+	}
+
+	m_HandleMap.erase(entry.FileName);
+	entry = TextureEntry{};
+	m_FreeHandleVec.emplace_back(handle);
+}
+
+void vkInit::TextureLoader::Update()
+{
+	//batches of earlier updates were acquired by the frames recorded since, their textures can be sampled once they finished
+	for (auto& entry : m_TextureVec)
+	{
+		if (entry.State != TextureState::Uploading or not m_UploadContextPtr->IsComplete(entry.Ticket))
+		{
+			continue;
+		}
+
+		//a full set leaves the texture on the placeholder
+		entry.TextureIdx = m_TextureSet.Register(entry.TextureUPtr->GetDescriptorImageInfo(GetSampler()));
+		entry.State = TextureState::Resident;
+
+		std::chrono::duration<double, std::milli> const loadTime{ std::chrono::high_resolution_clock::now() - entry.LoadTimePoint };
+		std::cout << "Texture " << entry.FileName << " resident after " << loadTime.count() << " ms (" << vk::to_string(entry.Decoded.Format) << ", "
+			<< entry.TextureUPtr->GetMemorySize() / 1024 << " KB from level " << entry.TextureUPtr->GetBaseMip() << ")\n";
+	}
+	FinishStreaming();
+
+	bool uploadRecorded{ false };
+	for (auto& entry : m_TextureVec)
+	{
+		if (entry.State != TextureState::Decoding or not entry.DecodeFuture.valid()
+			or entry.DecodeFuture.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready)
+		{
+			continue;
+		}
+
+		entry.Decoded = entry.DecodeFuture.get();
+		if (entry.Decoded.PixelVec.empty())
+		{
+			entry.State = TextureState::Failed;
+			continue;
+		}
+
+		//only the tail goes up now, the finer levels stream in once the texture is requested
+		entry.TextureUPtr = std::make_unique<Texture>(GetTextureInBundle(entry, GetTailMip(entry)), entry.Decoded);
+		entry.Ticket = m_UploadContextPtr->GetPendingTicket();
+		entry.State = TextureState::Uploading;
+		uploadRecorded = true;
+	}
+
+	uploadRecorded = Stream() or uploadRecorded;
+
+	//every texture decoded and every level streamed since the last frame goes out in one submission
+	if (uploadRecorded)
+	{
+		m_UploadContextPtr->Submit();
+	}
+	++m_UpdateNr;
+}
+
+void vkInit::TextureLoader::RequestResolution(TextureHandle handle, float pixels)
+{
+	TextureEntry& entry{ m_TextureVec[handle] };
+	if (entry.LastRequestUpdate != m_UpdateNr)
+	{
+		entry.LastRequestUpdate = m_UpdateNr;
+		entry.RequestedPixels = 0.f;
+	}
+	entry.RequestedPixels = std::max(entry.RequestedPixels, pixels);
+}
+
+void vkInit::TextureLoader::SetFramesInFlight(int framesInFlight)
+{
+	m_FramesInFlight = framesInFlight;
+}
+
+void vkInit::TextureLoader::SetFiltering(TextureFiltering filtering)
+{
+	if (filtering == m_Filtering)
+	{
+		return;
+	}
+	m_Filtering = filtering;
+
+	//a slot a frame in flight might sample can not be written, so every texture moves to a new one
+	std::optional<uint32_t> const placeholderIdx{ m_TextureSet.Register(m_PlaceholderUPtr->GetDescriptorImageInfo(GetSampler())) };
+	if (placeholderIdx)
+	{
+		m_RetiredVec.emplace_back(RetiredTexture{ nullptr, m_PlaceholderIdx, m_FramesInFlight });
+		m_PlaceholderIdx = *placeholderIdx;
+	}
+
+	for (auto& entry : m_TextureVec)
+	{
+		if (not entry.TextureIdx)
+		{
+			continue;
+		}
+
+		std::optional<uint32_t> const textureIdx{ m_TextureSet.Register(entry.TextureUPtr->GetDescriptorImageInfo(GetSampler())) };
+		if (textureIdx)
+		{
+			m_RetiredVec.emplace_back(RetiredTexture{ nullptr, entry.TextureIdx, m_FramesInFlight });
+			entry.TextureIdx = textureIdx;
+		}
+	}
+}
+
+vkInit::TextureFiltering vkInit::TextureLoader::GetFiltering() const
+{
+	return m_Filtering;
+}
+
+void vkInit::TextureLoader::AdvanceFrame()
+{
+	for (auto& retired : m_RetiredVec)
+	{
+		--retired.FramesLeft;
+	}
+
+	auto const releaseIt{ std::partition(m_RetiredVec.begin(), m_RetiredVec.end(),
+		[](RetiredTexture const& retired)
+		{
+			return retired.FramesLeft > 0;
+		}) };
+
+	for (auto retiredIt{ releaseIt }; retiredIt != m_RetiredVec.end(); ++retiredIt)
+	{
+		if (retiredIt->TextureIdx)
+		{
+			m_TextureSet.Release(*retiredIt->TextureIdx);
+		}
+	}
+	m_RetiredVec.erase(releaseIt, m_RetiredVec.end());
+}
+
+uint32_t vkInit::TextureLoader::GetTextureIdx(TextureHandle handle) const
+{
+	TextureEntry const& entry{ m_TextureVec[handle] };
+	return entry.TextureIdx.value_or(m_PlaceholderIdx);
+}
+
+bool vkInit::TextureLoader::IsResident(TextureHandle handle) const
+{
+	return m_TextureVec[handle].State == TextureState::Resident;
+}
+
+int vkInit::TextureLoader::GetPendingCount() const
+{
+	return static_cast<int>(std::count_if(m_TextureVec.begin(), m_TextureVec.end(),
+		[](TextureEntry const& entry)
+		{
+			return entry.UseCount > 0 and (entry.State == TextureState::Decoding or entry.State == TextureState::Uploading);
+		}));
+}
+
+vk::DeviceSize vkInit::TextureLoader::GetResidentBytes() const
+{
+	vk::DeviceSize residentBytes{};
+	for (auto const& entry : m_TextureVec)
+	{
+		residentBytes += entry.TextureUPtr ? entry.TextureUPtr->GetMemorySize() : 0;
+		residentBytes += entry.StreamingUPtr ? entry.StreamingUPtr->GetMemorySize() : 0;
+	}
+	return residentBytes;
+}
+
+vk::DeviceSize vkInit::TextureLoader::GetMemoryBudget() const
+{
+	return m_MemoryBudget;
+}
+
+vk::Sampler const& vkInit::TextureLoader::GetSampler() const
+{
+	return m_SamplerArr[static_cast<std::size_t>(m_Filtering)];
+}
+
+vkInit::TextureInBundle vkInit::TextureLoader::GetTextureInBundle(TextureEntry const& entry, uint32_t baseMip) const
+{
+	TextureInBundle textureIn{};
+	textureIn.Device = m_Device;
+	textureIn.PhysicalDevice = m_PhysicalDevice;
+	textureIn.FileName = entry.FileName;
+	textureIn.UploadContextPtr = m_UploadContextPtr;
+	textureIn.BaseMip = baseMip;
+	return textureIn;
+}
+
+uint32_t vkInit::TextureLoader::GetTailMip(TextureEntry const& entry) const
+{
+	uint32_t tailMip{};
+	while (tailMip + 1 < entry.Decoded.MipLevels and std::max(entry.Decoded.Width >> tailMip, entry.Decoded.Height >> tailMip) > TailSize)
+	{
+		++tailMip;
+	}
+	return tailMip;
+}
+
+uint32_t vkInit::TextureLoader::GetWantedMip(TextureEntry const& entry) const
+{
+	uint32_t const tailMip{ GetTailMip(entry) };
+	if (entry.RequestedPixels <= 0.f or entry.LastRequestUpdate + UnusedUpdates < m_UpdateNr)
+	{
+		return tailMip;
+	}
+
+	//about a texel per pixel, a finer level would only be minified
+	float const texels{ static_cast<float>(std::max(entry.Decoded.Width, entry.Decoded.Height)) };
+	float const wantedMip{ std::floor(std::log2(texels / entry.RequestedPixels)) };
+	return std::min(static_cast<uint32_t>(std::max(wantedMip, 0.f)), tailMip);
+}
+
+vk::DeviceSize vkInit::TextureLoader::GetTextureBytes(TextureEntry const& entry, uint32_t baseMip) const
+{
+	vkUtil::FormatBlock const block{ vkUtil::GetFormatBlock(entry.Decoded.Format).value_or(vkUtil::FormatBlock{}) };
+	return vkUtil::GetMipChainSize(block, std::max(entry.Decoded.Width >> baseMip, 1u), std::max(entry.Decoded.Height >> baseMip, 1u), entry.Decoded.MipLevels - baseMip);
+}
+
+void vkInit::TextureLoader::FinishStreaming()
+{
+	for (auto& entry : m_TextureVec)
+	{
+		if (not entry.StreamingUPtr or not m_UploadContextPtr->IsComplete(entry.StreamingTicket))
+		{
+			continue;
+		}
+
+		//a full set keeps the texture on the levels it had
+		std::optional<uint32_t> const textureIdx{ m_TextureSet.Register(entry.StreamingUPtr->GetDescriptorImageInfo(GetSampler())) };
+		if (not textureIdx)
+		{
+			m_RetiredVec.emplace_back(RetiredTexture{ std::move(entry.StreamingUPtr), std::nullopt, m_FramesInFlight });
+			continue;
+		}
+
+		//frames in flight might still sample the old image through the old slot
+		m_RetiredVec.emplace_back(RetiredTexture{ std::move(entry.TextureUPtr), entry.TextureIdx, m_FramesInFlight });
+		entry.TextureUPtr = std::move(entry.StreamingUPtr);
+		entry.TextureIdx = textureIdx;
+	}
+}
+
+bool vkInit::TextureLoader::Stream()
+{
+	//the memory every texture takes once the streams in flight finished, a texture that is being replaced only counts with its new image
+	vk::DeviceSize committedBytes{};
+	std::vector<TextureHandle> streamInVec{};
+	std::vector<TextureHandle> evictVec{};
+	for (TextureHandle handle{}; handle < m_TextureVec.size(); ++handle)
+	{
+		TextureEntry const& entry{ m_TextureVec[handle] };
+		if (not entry.TextureUPtr)
+		{
+			continue;
+		}
+		committedBytes += entry.StreamingUPtr ? entry.StreamingUPtr->GetMemorySize() : entry.TextureUPtr->GetMemorySize();
+
+		if (entry.State != TextureState::Resident or entry.StreamingUPtr)
+		{
+			continue;
+		}
+
+		uint32_t const wantedMip{ GetWantedMip(entry) };
+		if (wantedMip < entry.TextureUPtr->GetBaseMip())
+		{
+			streamInVec.emplace_back(handle);
+		}
+		else if (wantedMip > entry.TextureUPtr->GetBaseMip())
+		{
+			evictVec.emplace_back(handle);
+		}
+	}
+
+	//the textures missing the most levels first, the ones requested longest ago are evicted first
+	std::sort(streamInVec.begin(), streamInVec.end(),
+		[this](TextureHandle lhs, TextureHandle rhs)
+		{
+			return m_TextureVec[lhs].TextureUPtr->GetBaseMip() - GetWantedMip(m_TextureVec[lhs]) > m_TextureVec[rhs].TextureUPtr->GetBaseMip() - GetWantedMip(m_TextureVec[rhs]);
+		});
+	std::sort(evictVec.begin(), evictVec.end(),
+		[this](TextureHandle lhs, TextureHandle rhs)
+		{
+			return m_TextureVec[lhs].LastRequestUpdate < m_TextureVec[rhs].LastRequestUpdate;
+		});
+
+	bool streamRecorded{ false };
+	vk::DeviceSize streamedBytes{};
+	auto evictIt{ evictVec.begin() };
+	auto const evict{ [&]()
+		{
+			TextureEntry& evicted{ m_TextureVec[*evictIt++] };
+			uint32_t const evictedMip{ GetWantedMip(evicted) };
+			committedBytes = committedBytes - evicted.TextureUPtr->GetMemorySize() + GetTextureBytes(evicted, evictedMip);
+			streamedBytes += GetTextureBytes(evicted, evictedMip);
+			StartStreaming(evicted, evictedMip);
+			streamRecorded = true;
+		} };
+
+	for (TextureHandle const handle : streamInVec)
+	{
+		if (streamedBytes >= StreamBytesPerUpdate)
+		{
+			break;
+		}
+
+		TextureEntry& entry{ m_TextureVec[handle] };
+		uint32_t const residentMip{ entry.TextureUPtr->GetBaseMip() };
+		uint32_t baseMip{ GetWantedMip(entry) };
+		while (committedBytes - entry.TextureUPtr->GetMemorySize() + GetTextureBytes(entry, baseMip) > m_MemoryBudget and evictIt != evictVec.end())
+		{
+			evict();
+		}
+
+		//what still does not fit streams in as far as it does
+		while (baseMip < residentMip and committedBytes - entry.TextureUPtr->GetMemorySize() + GetTextureBytes(entry, baseMip) > m_MemoryBudget)
+		{
+			++baseMip;
+		}
+		if (baseMip == residentMip)
+		{
+			continue;
+		}
+
+		committedBytes = committedBytes - entry.TextureUPtr->GetMemorySize() + GetTextureBytes(entry, baseMip);
+		streamedBytes += GetTextureBytes(entry, baseMip);
+		StartStreaming(entry, baseMip);
+		streamRecorded = true;
+	}
+
+	//textures loaded since can push the tails of every texture past the budget as well
+	while (committedBytes > m_MemoryBudget and evictIt != evictVec.end())
+	{
+		evict();
+	}
+	return streamRecorded;
+}
+
+void vkInit::TextureLoader::StartStreaming(TextureEntry& entry, uint32_t baseMip)
+{
+	entry.StreamingUPtr = std::make_unique<Texture>(GetTextureInBundle(entry, baseMip), entry.Decoded);
+	entry.StreamingTicket = m_UploadContextPtr->GetPendingTicket();
+}
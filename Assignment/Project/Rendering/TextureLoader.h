@@ -0,0 +1,165 @@
+#ifndef VK_TEXTURE_LOADER_H
+#define VK_TEXTURE_LOADER_H
+#include "Engine/Configuration.h"
+#include "Rendering/Image.h"
+#include "Rendering/UploadContext.h"
+#include "Pipeline/BindlessTextureSet.h"
+#include <future>
+#include <unordered_map>
+
+namespace vkInit
+{
+	using TextureHandle = uint32_t;
+
+	struct TextureLoaderInBundle
+	{
+		vk::Device Device;
+		vk::PhysicalDevice PhysicalDevice;
+		vkUtil::UploadContext* UploadContextPtr{ nullptr };
+		BindlessTextureSet* TextureSetPtr{ nullptr };
+		TextureFiltering Filtering{ TextureFiltering::Anisotropic };
+		//device memory every texture together may take, the finest levels of the least recently requested textures are evicted to stay below it
+		vk::DeviceSize MemoryBudget{ 256ull * 1024 * 1024 };
+	};
+
+	//decodes textures on the thread pool and uploads the finished ones in one batch per frame, loading never waits on image io
+	//until a texture is resident its handle points at a 1x1 placeholder, a failed texture keeps pointing at it
+	//a texture first becomes resident with only its smallest levels, the finer ones stream in once a mesh on screen asks for them
+	//the image of a texture only holds its resident levels, streaming creates an image with the new levels from the copy kept on the host
+	//and moves the texture to a new slot once it finished, so sampling never reaches a level that has not arrived
+	//not thread safe, use it from the thread that owns the upload context
+	class TextureLoader final
+	{
+	public:
+		TextureLoader(TextureLoaderInBundle const& in);
+		~TextureLoader();
+
+		TextureLoader(TextureLoader const& other) = delete;
+		TextureLoader(TextureLoader&& other) = delete;
+		TextureLoader& operator=(TextureLoader const& other) = delete;
+		TextureLoader& operator=(TextureLoader&& other) = delete;
+
+		//starts decoding the file, a file that is already loaded gets the same handle with one more use
+		TextureHandle Load(std::string const& fileName);
+
+		//the texture and its slot are destroyed once the last use is released and every frame that could sample it has finished
+		void Release(TextureHandle handle);
+
+		//the texture covers at most this many pixels across the screen, the finest level it streams in is the one with about as many texels
+		//the largest request since the last update counts, a texture that is not requested for a while can have its finer levels evicted
+		void RequestResolution(TextureHandle handle, float pixels);
+
+		//records the uploads of every decoded texture and of the levels that stream in or out and submits them
+		//textures whose batch has finished get their own slot
+		//has to be called once per frame after the frame was submitted, the next frame acquires the batch before any draw samples it
+		void Update();
+
+		void SetFramesInFlight(int framesInFlight);
+
+		//every texture gets a new slot written with the sampler of the filtering, the old slots are retired like released textures
+		void SetFiltering(TextureFiltering filtering);
+		TextureFiltering GetFiltering() const;
+
+		//has to be called once per frame after waiting for the fence of the frame
+		void AdvanceFrame();
+
+		//slot in the texture set for the draw data, the placeholder's until the texture is resident
+		uint32_t GetTextureIdx(TextureHandle handle) const;
+		bool IsResident(TextureHandle handle) const;
+
+		//textures that are still decoding or uploading
+		int GetPendingCount() const;
+
+		//device memory of the images of every texture, those that are still streaming included
+		vk::DeviceSize GetResidentBytes() const;
+		vk::DeviceSize GetMemoryBudget() const;
+	private:
+		//levels up to this size are uploaded when the texture is loaded
+		static constexpr uint32_t TailSize{ 64 };
+		//a texture that was not requested for this many updates is only kept at its tail when memory runs out
+		static constexpr std::uint64_t UnusedUpdates{ 120 };
+		//bytes of streamed levels recorded per update, so streaming never stalls a frame on upload bandwidth
+		static constexpr vk::DeviceSize StreamBytesPerUpdate{ 16ull * 1024 * 1024 };
+
+		enum class TextureState
+		{
+			Decoding,
+			Uploading,
+			Resident,
+			Failed
+		};
+
+		struct TextureEntry
+		{
+			std::string FileName;
+			int UseCount{};
+			TextureState State{ TextureState::Decoding };
+			std::future<DecodedTexture> DecodeFuture;
+			std::unique_ptr<Texture> TextureUPtr{ nullptr };
+			vkUtil::UploadTicket Ticket{};
+			std::optional<uint32_t> TextureIdx;
+			std::chrono::high_resolution_clock::time_point LoadTimePoint;
+
+			//every level of the texture stays on the host, levels are streamed from it and evicted ones can come back
+			DecodedTexture Decoded;
+			//the image that replaces the resident one once its upload finished
+			std::unique_ptr<Texture> StreamingUPtr{ nullptr };
+			vkUtil::UploadTicket StreamingTicket{};
+			float RequestedPixels{};
+			std::uint64_t LastRequestUpdate{};
+		};
+
+		//a released texture that might still be sampled by a frame in flight
+		struct RetiredTexture
+		{
+			std::unique_ptr<Texture> TextureUPtr;
+			std::optional<uint32_t> TextureIdx;
+			int FramesLeft;
+		};
+
+		vk::Device m_Device;
+		vk::PhysicalDevice m_PhysicalDevice;
+		vkUtil::UploadContext* m_UploadContextPtr;
+		BindlessTextureSet& m_TextureSet;
+
+		//one sampler per filtering, created up front so switching never waits on a frame
+		std::array<vk::Sampler, 3> m_SamplerArr{};
+		TextureFiltering m_Filtering;
+
+		//the formats a ktx2 file can be uploaded in as is, queried once and copied into every decode
+		std::vector<vk::Format> m_SupportedFormatVec;
+
+		std::unique_ptr<Texture> m_PlaceholderUPtr{ nullptr };
+		uint32_t m_PlaceholderIdx{ 0 };
+
+		//indexed by the handle, released entries are reused
+		std::vector<TextureEntry> m_TextureVec;
+		std::vector<TextureHandle> m_FreeHandleVec;
+		std::unordered_map<std::string, TextureHandle> m_HandleMap;
+
+		std::vector<RetiredTexture> m_RetiredVec;
+		int m_FramesInFlight{ 1 };
+
+		vk::DeviceSize m_MemoryBudget;
+		std::uint64_t m_UpdateNr{ 1 };
+
+		vk::Sampler const& GetSampler() const;
+
+		TextureInBundle GetTextureInBundle(TextureEntry const& entry, uint32_t baseMip) const;
+		//the coarsest level that still starts the tail and the level the requests of the entry ask for
+		uint32_t GetTailMip(TextureEntry const& entry) const;
+		uint32_t GetWantedMip(TextureEntry const& entry) const;
+		//memory of the texture when its image starts at the level, estimated from the size of its levels
+		vk::DeviceSize GetTextureBytes(TextureEntry const& entry, uint32_t baseMip) const;
+
+		//moves the textures whose streamed image finished to a slot of it
+		void FinishStreaming();
+		//streams the levels the requests ask for in, evicting the finest levels of the least recently requested textures to stay in the budget
+		//returns true when an upload was recorded
+		bool Stream();
+		void StartStreaming(TextureEntry& entry, uint32_t baseMip);
+	};
+
+}
+
+#endif
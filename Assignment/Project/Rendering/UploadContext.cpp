@@ -0,0 +1,419 @@
+#include "UploadContext.h"
+#include "Rendering/Commands.h"
+#include "Utils/BlockCompression.h"
+
+vkUtil::UploadContext::UploadContext(UploadContextInBundle const& in)
+	: m_Device{ in.Device }
+	, m_PhysicalDevice{ in.PhysicalDevice }
+	, m_Queue{ in.Queue }
+	, m_QueueFamilyIdx{ in.QueueFamilyIdx }
+	, m_DstQueueFamilyIdx{ in.DstQueueFamilyIdx }
+	, m_StagingSize{ in.StagingSize }
+{
+	vk::CommandPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+	poolCreateInfo.queueFamilyIndex = in.QueueFamilyIdx;
+
+	vk::SemaphoreTypeCreateInfo semaphoreTypeCreateInfo{};
+	semaphoreTypeCreateInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+	semaphoreTypeCreateInfo.initialValue = 0;
+
+	vk::SemaphoreCreateInfo semaphoreCreateInfo{};
+	semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+
+	try
+	{
+		m_CommandPool = m_Device.createCommandPool(poolCreateInfo);
+		m_TimelineSemaphore = m_Device.createSemaphore(semaphoreCreateInfo);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+	}
+
+	BufferInBundle stagingIn{};
+	stagingIn.Device = m_Device;
+	stagingIn.PhysicalDevice = m_PhysicalDevice;
+	stagingIn.Size = m_StagingSize;
+	stagingIn.UsageFlags = vk::BufferUsageFlagBits::eTransferSrc;
+	stagingIn.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+	m_StagingBuffer = CreateBuffer(stagingIn);
+	m_StagingPtr = static_cast<char*>(m_StagingBuffer.Allocation.MappedPtr);
+}
+
+vkUtil::UploadContext::~UploadContext()
+{
+	Wait(Submit());
+
+	DestroyBuffer(m_Device, m_StagingBuffer);
+	m_Device.destroySemaphore(m_TimelineSemaphore);
+	m_Device.destroyCommandPool(m_CommandPool);
+}
+
+void vkUtil::UploadContext::UploadBuffer(vk::Buffer const& dstBuffer, vk::DeviceSize dstOffset, void const* dataPtr, vk::DeviceSize size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	auto const [srcBuffer, srcOffset] { Stage(dataPtr, size, 4) };
+
+	vk::CommandBuffer const& commandBuffer{ GetRecordingCommandBuffer() };
+	commandBuffer.copyBuffer(srcBuffer, dstBuffer, vk::BufferCopy{ srcOffset, dstOffset, size });
+
+	if (not TransfersOwnership())
+	{
+		//the timeline semaphore wait of the using queue already makes the copy visible
+		return;
+	}
+
+	vk::BufferMemoryBarrier barrier{};
+	barrier.srcQueueFamilyIndex = m_QueueFamilyIdx;
+	barrier.dstQueueFamilyIndex = m_DstQueueFamilyIdx;
+	barrier.buffer = dstBuffer;
+	barrier.offset = dstOffset;
+	barrier.size = size;
+
+	//release, the access on the using queue is part of the acquire
+	barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	barrier.dstAccessMask = vk::AccessFlagBits::eNoneKHR;
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags{}, nullptr, barrier, nullptr);
+
+	barrier.srcAccessMask = vk::AccessFlagBits::eNoneKHR;
+	barrier.dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eShaderRead;
+	m_RecordingBufferAcquireVec.emplace_back(barrier);
+}
+
+void vkUtil::UploadContext::UploadImage(vk::Image const& dstImage, vk::Extent2D const& extent, void const* dataPtr, vk::DeviceSize size, uint32_t mipLevels, vk::Format format)
+{
+	//buffer offsets of image copies have to be a multiple of the texel or block size, 16 covers every format a texture can have
+	auto const [srcBuffer, srcOffset] { Stage(dataPtr, size, 16) };
+	FormatBlock const block{ GetFormatBlock(format).value_or(FormatBlock{}) };
+
+	vk::CommandBuffer const& commandBuffer{ GetRecordingCommandBuffer() };
+
+	vk::ImageSubresourceRange imgSubRange{};
+	imgSubRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+	imgSubRange.baseMipLevel = 0;
+	imgSubRange.levelCount = mipLevels;
+	imgSubRange.baseArrayLayer = 0;
+	imgSubRange.layerCount = 1;
+
+	vk::ImageMemoryBarrier barrier{};
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = dstImage;
+	barrier.subresourceRange = imgSubRange;
+
+	barrier.oldLayout = vk::ImageLayout::eUndefined;
+	barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+	barrier.srcAccessMask = vk::AccessFlagBits::eNoneKHR;
+	barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags{}, nullptr, nullptr, barrier);
+
+	std::vector<vk::BufferImageCopy> copyVec{};
+	vk::DeviceSize levelOffset{ srcOffset };
+	for (uint32_t mipLevel{}; mipLevel < mipLevels; ++mipLevel)
+	{
+		vk::Extent2D const levelExtent{ std::max(extent.width >> mipLevel, 1u), std::max(extent.height >> mipLevel, 1u) };
+
+		vk::BufferImageCopy copy{};
+		copy.bufferOffset = levelOffset;
+		copy.bufferRowLength = 0;
+		copy.bufferImageHeight = 0;
+		copy.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+		copy.imageSubresource.mipLevel = mipLevel;
+		copy.imageSubresource.baseArrayLayer = 0;
+		copy.imageSubresource.layerCount = 1;
+		copy.imageOffset = vk::Offset3D{ 0, 0, 0 };
+		copy.imageExtent = vk::Extent3D{ levelExtent, 1 };
+		copyVec.emplace_back(copy);
+
+		//a level smaller than a block still takes a whole one, the copy extent stays the size of the level
+		levelOffset += GetLevelSize(block, levelExtent.width, levelExtent.height);
+	}
+	commandBuffer.copyBufferToImage(srcBuffer, dstImage, vk::ImageLayout::eTransferDstOptimal, copyVec);
+
+	barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+	barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+	if (not TransfersOwnership())
+	{
+		barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags{}, nullptr, nullptr, barrier);
+		return;
+	}
+
+	//release with the layout change, the acquire repeats the same transition on the using queue
+	barrier.srcQueueFamilyIndex = m_QueueFamilyIdx;
+	barrier.dstQueueFamilyIndex = m_DstQueueFamilyIdx;
+	barrier.dstAccessMask = vk::AccessFlagBits::eNoneKHR;
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags{}, nullptr, nullptr, barrier);
+
+	barrier.srcAccessMask = vk::AccessFlagBits::eNoneKHR;
+	barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+	m_RecordingImageAcquireVec.emplace_back(barrier);
+}
+
+vkUtil::UploadTicket vkUtil::UploadContext::RecordAcquireBarriers(vk::CommandBuffer const& commandBuffer)
+{
+	if (not m_SubmittedBufferAcquireVec.empty() or not m_SubmittedImageAcquireVec.empty())
+	{
+		commandBuffer.pipelineBarrier
+		(
+			GetWaitStages(),
+			GetWaitStages(),
+			vk::DependencyFlags{},
+			nullptr,
+			m_SubmittedBufferAcquireVec,
+			m_SubmittedImageAcquireVec
+		);
+
+		m_SubmittedBufferAcquireVec.clear();
+		m_SubmittedImageAcquireVec.clear();
+	}
+
+	return m_LastSubmittedTicket;
+}
+
+vkUtil::UploadTicket vkUtil::UploadContext::Submit()
+{
+	if (not m_RecordingCommandBuffer)
+	{
+		return m_LastSubmittedTicket;
+	}
+
+	m_RecordingCommandBuffer.end();
+
+	UploadTicket const ticket{ m_LastSubmittedTicket + 1 };
+
+	vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+	timelineSubmitInfo.signalSemaphoreValueCount = 1;
+	timelineSubmitInfo.pSignalSemaphoreValues = &ticket;
+
+	vk::SubmitInfo submitInfo{};
+	submitInfo.pNext = &timelineSubmitInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &m_RecordingCommandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &m_TimelineSemaphore;
+
+	try
+	{
+		m_Queue.submit(submitInfo, nullptr);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+	}
+
+	m_LastSubmittedTicket = ticket;
+
+	InFlightBatch batch{};
+	batch.Ticket = ticket;
+	batch.CommandBuffer = m_RecordingCommandBuffer;
+	batch.StagingEnd = m_StagingHead;
+	batch.StagingBytes = m_RecordingStagingBytes;
+	batch.OversizedStagingVec.swap(m_RecordingOversizedStagingVec);
+	m_InFlightBatchDeque.emplace_back(std::move(batch));
+
+	m_SubmittedBufferAcquireVec.insert(m_SubmittedBufferAcquireVec.end(), m_RecordingBufferAcquireVec.begin(), m_RecordingBufferAcquireVec.end());
+	m_SubmittedImageAcquireVec.insert(m_SubmittedImageAcquireVec.end(), m_RecordingImageAcquireVec.begin(), m_RecordingImageAcquireVec.end());
+	m_RecordingBufferAcquireVec.clear();
+	m_RecordingImageAcquireVec.clear();
+
+	m_RecordingCommandBuffer = nullptr;
+	m_RecordingStagingBytes = 0;
+
+	return ticket;
+}
+
+bool vkUtil::UploadContext::IsComplete(UploadTicket ticket) const
+{
+	return m_Device.getSemaphoreCounterValue(m_TimelineSemaphore) >= ticket;
+}
+
+void vkUtil::UploadContext::Wait(UploadTicket ticket)
+{
+	if (ticket > m_LastSubmittedTicket)
+	{
+		Submit();
+	}
+
+	vk::SemaphoreWaitInfo waitInfo{};
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &m_TimelineSemaphore;
+	waitInfo.pValues = &ticket;
+
+	vk::Result const result{ m_Device.waitSemaphores(waitInfo, UINT64_MAX) };
+	if (result != vk::Result::eSuccess)
+	{
+		std::cout << "Waiting for upload failure\n";
+	}
+
+	ReclaimFinishedBatches();
+}
+
+vkUtil::UploadTicket vkUtil::UploadContext::GetPendingTicket() const
+{
+	return m_LastSubmittedTicket + 1;
+}
+
+vkUtil::UploadTicket vkUtil::UploadContext::GetLastSubmittedTicket() const
+{
+	return m_LastSubmittedTicket;
+}
+
+vk::Semaphore vkUtil::UploadContext::GetTimelineSemaphore() const
+{
+	return m_TimelineSemaphore;
+}
+
+vk::PipelineStageFlags vkUtil::UploadContext::GetWaitStages() const
+{
+	return vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+}
+
+bool vkUtil::UploadContext::TransfersOwnership() const
+{
+	return m_QueueFamilyIdx != m_DstQueueFamilyIdx;
+}
+
+vk::CommandBuffer const& vkUtil::UploadContext::GetRecordingCommandBuffer()
+{
+	if (m_RecordingCommandBuffer)
+	{
+		return m_RecordingCommandBuffer;
+	}
+
+	if (m_FreeCommandBufferVec.empty())
+	{
+		vk::CommandBufferAllocateInfo bufferAllocInfo{};
+		bufferAllocInfo.commandPool = m_CommandPool;
+		bufferAllocInfo.level = vk::CommandBufferLevel::ePrimary;
+		bufferAllocInfo.commandBufferCount = 1;
+
+		m_RecordingCommandBuffer = m_Device.allocateCommandBuffers(bufferAllocInfo)[0];
+	}
+	else
+	{
+		m_RecordingCommandBuffer = m_FreeCommandBufferVec.back();
+		m_FreeCommandBufferVec.pop_back();
+	}
+
+	vkInit::BeginSingleCommand(m_RecordingCommandBuffer);
+
+	return m_RecordingCommandBuffer;
+}
+
+std::pair<vk::Buffer, vk::DeviceSize> vkUtil::UploadContext::Stage(void const* dataPtr, vk::DeviceSize size, vk::DeviceSize alignment)
+{
+	ReclaimFinishedBatches();
+
+	if (size > m_StagingSize)
+	{
+		BufferInBundle stagingIn{};
+		stagingIn.Device = m_Device;
+		stagingIn.PhysicalDevice = m_PhysicalDevice;
+		stagingIn.Size = size;
+		stagingIn.UsageFlags = vk::BufferUsageFlagBits::eTransferSrc;
+		stagingIn.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+		DataBuffer const& stagingBuffer{ m_RecordingOversizedStagingVec.emplace_back(CreateBuffer(stagingIn)) };
+		memcpy(stagingBuffer.Allocation.MappedPtr, dataPtr, size);
+		return { stagingBuffer.Buffer, 0 };
+	}
+
+	std::optional<vk::DeviceSize> offset{ TryAllocateStaging(size, alignment) };
+	while (not offset)
+	{
+		//the ring is full, the oldest batch has to finish before its staging memory can be reused
+		if (m_InFlightBatchDeque.empty())
+		{
+			Submit();
+		}
+		Wait(m_InFlightBatchDeque.front().Ticket);
+
+		offset = TryAllocateStaging(size, alignment);
+	}
+
+	memcpy(m_StagingPtr + *offset, dataPtr, size);
+	return { m_StagingBuffer.Buffer, *offset };
+}
+
+std::optional<vk::DeviceSize> vkUtil::UploadContext::TryAllocateStaging(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+	if (m_StagingUsedBytes == 0)
+	{
+		m_StagingHead = 0;
+		m_StagingTail = 0;
+	}
+
+	vk::DeviceSize const alignedHead{ (m_StagingHead + alignment - 1) / alignment * alignment };
+	vk::DeviceSize allocatedBytes{};
+	vk::DeviceSize offset{};
+
+	if (m_StagingHead > m_StagingTail or m_StagingUsedBytes == 0)
+	{
+		//the used part is [tail, head), free space at the end first and then in front of the tail
+		if (alignedHead + size <= m_StagingSize)
+		{
+			offset = alignedHead;
+			allocatedBytes = alignedHead + size - m_StagingHead;
+		}
+		else if (size <= m_StagingTail)
+		{
+			offset = 0;
+			allocatedBytes = m_StagingSize - m_StagingHead + size;
+		}
+		else
+		{
+			return std::nullopt;
+		}
+	}
+	else
+	{
+		//wrapped around, the only free space is [head, tail)
+		if (alignedHead + size > m_StagingTail)
+		{
+			return std::nullopt;
+		}
+		offset = alignedHead;
+		allocatedBytes = alignedHead + size - m_StagingHead;
+	}
+
+	m_StagingHead = offset + size;
+	m_StagingUsedBytes += allocatedBytes;
+	m_RecordingStagingBytes += allocatedBytes;
+
+	return offset;
+}
+
+void vkUtil::UploadContext::ReclaimFinishedBatches()
+{
+	if (m_InFlightBatchDeque.empty())
+	{
+		return;
+	}
+
+	UploadTicket const finishedTicket{ m_Device.getSemaphoreCounterValue(m_TimelineSemaphore) };
+
+	while (not m_InFlightBatchDeque.empty() and m_InFlightBatchDeque.front().Ticket <= finishedTicket)
+	{
+		InFlightBatch& batch{ m_InFlightBatchDeque.front() };
+
+		m_StagingTail = batch.StagingEnd;
+		m_StagingUsedBytes -= batch.StagingBytes;
+
+		for (auto& stagingBuffer : batch.OversizedStagingVec)
+		{
+			DestroyBuffer(m_Device, stagingBuffer);
+		}
+
+		m_FreeCommandBufferVec.emplace_back(batch.CommandBuffer);
+		m_InFlightBatchDeque.pop_front();
+	}
+}
@@ -0,0 +1,121 @@
+#ifndef VK_UPLOAD_CONTEXT_H
+#define VK_UPLOAD_CONTEXT_H
+#include "Engine/Configuration.h"
+#include "Utils/Buffer.h"
+#include <deque>
+
+namespace vkUtil
+{
+	//value the timeline semaphore of the upload context reaches once a batch has finished
+	using UploadTicket = std::uint64_t;
+
+	struct UploadContextInBundle
+	{
+		vk::Device Device;
+		vk::PhysicalDevice PhysicalDevice;
+		vk::Queue Queue;
+		uint32_t QueueFamilyIdx{};
+		//family of the queue that uses the uploaded resources, ownership is transferred when it differs from QueueFamilyIdx
+		uint32_t DstQueueFamilyIdx{};
+		vk::DeviceSize StagingSize{ 32ull * 1024 * 1024 };
+	};
+
+	//records buffer and image uploads into one command buffer until Submit, the data goes through a ring of staging memory
+	//every submit signals the next value of a timeline semaphore instead of waiting for the queue to idle
+	//on a separate transfer family the uploads release their resources, the using queue acquires them with RecordAcquireBarriers
+	//not thread safe, record and submit from one thread
+	class UploadContext final
+	{
+	public:
+		UploadContext(UploadContextInBundle const& in);
+		~UploadContext();
+
+		UploadContext(UploadContext const& other) = delete;
+		UploadContext(UploadContext&& other) = delete;
+		UploadContext& operator=(UploadContext const& other) = delete;
+		UploadContext& operator=(UploadContext&& other) = delete;
+
+		void UploadBuffer(vk::Buffer const& dstBuffer, vk::DeviceSize dstOffset, void const* dataPtr, vk::DeviceSize size);
+
+		//the whole image goes from undefined to shader read only, it can only be sampled once the ticket is signaled
+		//the data holds mipLevels levels of the format, each one packed right after the previous one
+		void UploadImage(vk::Image const& dstImage, vk::Extent2D const& extent, void const* dataPtr, vk::DeviceSize size, uint32_t mipLevels = 1, vk::Format format = vk::Format::eR8G8B8A8Unorm);
+
+		//records the acquire half of the ownership transfers of every submitted batch into a command buffer of the using queue
+		//returns the ticket the submit of that command buffer has to wait on
+		UploadTicket RecordAcquireBarriers(vk::CommandBuffer const& commandBuffer);
+
+		//submits everything recorded since the last submit, without recorded work the last ticket is returned
+		UploadTicket Submit();
+
+		bool IsComplete(UploadTicket ticket) const;
+		//submits first when the ticket belongs to the batch that is still recording
+		void Wait(UploadTicket ticket);
+
+		//the ticket the next submit will signal, uploads recorded now complete with it
+		UploadTicket GetPendingTicket() const;
+		UploadTicket GetLastSubmittedTicket() const;
+
+		//the graphics submit waits on this so draws never read geometry or textures that are still uploading
+		vk::Semaphore GetTimelineSemaphore() const;
+		//the stages that wait on the timeline semaphore, the acquire barriers chain onto that wait from these stages
+		vk::PipelineStageFlags GetWaitStages() const;
+	private:
+		struct InFlightBatch
+		{
+			UploadTicket Ticket;
+			vk::CommandBuffer CommandBuffer;
+			//ring bytes of the batch, padding and the skipped end of the ring included
+			vk::DeviceSize StagingEnd;
+			vk::DeviceSize StagingBytes;
+			//uploads that did not fit in the ring got their own staging buffer
+			std::vector<DataBuffer> OversizedStagingVec;
+		};
+
+		vk::Device m_Device;
+		vk::PhysicalDevice m_PhysicalDevice;
+		vk::Queue m_Queue;
+		uint32_t m_QueueFamilyIdx;
+		uint32_t m_DstQueueFamilyIdx;
+
+		vk::CommandPool m_CommandPool;
+		std::vector<vk::CommandBuffer> m_FreeCommandBufferVec;
+		vk::CommandBuffer m_RecordingCommandBuffer;
+
+		vk::Semaphore m_TimelineSemaphore;
+		UploadTicket m_LastSubmittedTicket{ 0 };
+
+		DataBuffer m_StagingBuffer;
+		char* m_StagingPtr{ nullptr };
+		vk::DeviceSize m_StagingSize;
+		vk::DeviceSize m_StagingHead{ 0 };
+		vk::DeviceSize m_StagingTail{ 0 };
+		vk::DeviceSize m_StagingUsedBytes{ 0 };
+
+		vk::DeviceSize m_RecordingStagingBytes{ 0 };
+		std::vector<DataBuffer> m_RecordingOversizedStagingVec;
+
+		std::deque<InFlightBatch> m_InFlightBatchDeque;
+
+		//acquire barriers of the batch that is recording and of submitted batches nobody acquired yet
+		std::vector<vk::BufferMemoryBarrier> m_RecordingBufferAcquireVec;
+		std::vector<vk::ImageMemoryBarrier> m_RecordingImageAcquireVec;
+		std::vector<vk::BufferMemoryBarrier> m_SubmittedBufferAcquireVec;
+		std::vector<vk::ImageMemoryBarrier> m_SubmittedImageAcquireVec;
+
+		bool TransfersOwnership() const;
+
+		//starts a command buffer if the current batch has none yet
+		vk::CommandBuffer const& GetRecordingCommandBuffer();
+
+		//copies the data into staging memory and returns the buffer and offset the copy has to read from
+		std::pair<vk::Buffer, vk::DeviceSize> Stage(void const* dataPtr, vk::DeviceSize size, vk::DeviceSize alignment);
+		std::optional<vk::DeviceSize> TryAllocateStaging(vk::DeviceSize size, vk::DeviceSize alignment);
+
+		//releases the staging memory and command buffers of every finished batch
+		void ReclaimFinishedBatches();
+	};
+
+}
+
+#endif
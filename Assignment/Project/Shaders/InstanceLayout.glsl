@@ -0,0 +1,72 @@
+//decodes one entry of the instance storage buffer, has to match the encode in Utils/InstanceLayout.h
+//the layout is picked by the AVE_INSTANCE_LAYOUT cmake option
+
+mat4 ComposeTRS(vec3 position, vec4 rotation, float scale)
+{
+	vec4 q = normalize(rotation);
+	mat3 rotationMatrix = mat3(
+		1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.w * q.z), 2.0 * (q.x * q.z - q.w * q.y),
+		2.0 * (q.x * q.y - q.w * q.z), 1.0 - 2.0 * (q.x * q.x + q.z * q.z), 2.0 * (q.y * q.z + q.w * q.x),
+		2.0 * (q.x * q.z + q.w * q.y), 2.0 * (q.y * q.z - q.w * q.x), 1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+
+	return mat4(
+		vec4(rotationMatrix[0] * scale, 0.0),
+		vec4(rotationMatrix[1] * scale, 0.0),
+		vec4(rotationMatrix[2] * scale, 0.0),
+		vec4(position, 1.0));
+}
+
+#if defined(AVE_INSTANCE_LAYOUT_AFFINE)
+
+struct Instance
+{
+	vec4 Rows[3];
+};
+
+mat4 DecodeInstance(Instance instance)
+{
+	return transpose(mat4(instance.Rows[0], instance.Rows[1], instance.Rows[2], vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+#elif defined(AVE_INSTANCE_LAYOUT_TRS)
+
+struct Instance
+{
+	vec4 PositionScale;
+	vec4 Rotation;
+};
+
+mat4 DecodeInstance(Instance instance)
+{
+	return ComposeTRS(instance.PositionScale.xyz, instance.Rotation, instance.PositionScale.w);
+}
+
+#elif defined(AVE_INSTANCE_LAYOUT_HALFTRS)
+
+struct Instance
+{
+	uvec4 Packed;
+};
+
+mat4 DecodeInstance(Instance instance)
+{
+	vec2 positionXY = unpackHalf2x16(instance.Packed.x);
+	vec2 positionZScale = unpackHalf2x16(instance.Packed.y);
+	vec4 rotation = vec4(unpackSnorm2x16(instance.Packed.z), unpackSnorm2x16(instance.Packed.w));
+
+	return ComposeTRS(vec3(positionXY, positionZScale.x), rotation, positionZScale.y);
+}
+
+#else
+
+struct Instance
+{
+	mat4 Model;
+};
+
+mat4 DecodeInstance(Instance instance)
+{
+	return instance.Model;
+}
+
+#endif
@@ -1,12 +1,15 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 fragWorldPosition;
 layout(location = 1) in vec3 fragWorldNormal;
 layout(location = 2) in vec2 fragTexCoor;
+layout(location = 3) flat in uint fragTextureIdx;
 
 layout(location = 0) out vec4 outColor;
 
-layout(set = 1, binding = 0) uniform sampler2D material;
+//bindless texture set, the size is picked at runtime and only registered slots are valid
+layout(set = 1, binding = 0) uniform sampler2D materials[];
 
 struct Light
 {
@@ -24,5 +27,6 @@ void main()
 	mainLight.intensity = 10.0f;
 	
 	float cosAngle = max(dot(fragWorldNormal, normalize(-mainLight.direction)), 0);
-	outColor = cosAngle * texture(material, fragTexCoor);
+	//one multi draw can put fragments of different meshes in the same subgroup
+	outColor = cosAngle * texture(materials[nonuniformEXT(fragTextureIdx)], fragTexCoor);
 }
\ No newline at end of file
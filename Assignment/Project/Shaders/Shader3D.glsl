@@ -0,0 +1,64 @@
+//bindings shared by the vertex shaders of the 3d pipelines, every vertex format reads its instances and draws the same way
+#include "InstanceLayout.glsl"
+
+layout(binding = 0) uniform UBO
+{
+	mat4 View;
+	mat4 Projection;
+} VPMatrix;
+
+//first draw command of the call, gl_DrawID counts from there
+layout(push_constant) uniform DRAW
+{
+	uint FirstDraw;
+} Draw;
+
+//std430 enforces that the layout on cpu is the same as on gpu, instance structs are tightly packed
+layout(std430, binding = 1) readonly buffer StorageBuffer
+{
+	Instance Instances[];
+} WorldMatrix;
+
+//filled by the culling pass, gl_InstanceIndex already contains the first instance of the draw
+layout(std430, binding = 2) readonly buffer VisibleBuffer
+{
+	uint Indices[];
+} VisibleInstances;
+
+//matches vkUtil::DrawData, one entry per draw command
+struct DrawData
+{
+	vec3 PositionOffset;
+	uint TextureIdx;
+	vec3 PositionScale;
+	float Padding;
+};
+
+layout(std430, binding = 4) readonly buffer DrawDataBuffer
+{
+	DrawData Data[];
+} Draws;
+
+layout(location = 0) out vec3 fragWorldPosition;
+layout(location = 1) out vec3 fragWorldNormal;
+layout(location = 2) out vec2 fragTexCoor;
+layout(location = 3) flat out uint fragTextureIdx;
+
+DrawData GetDrawData()
+{
+	return Draws.Data[Draw.FirstDraw + gl_DrawID];
+}
+
+mat4 GetModelMatrix()
+{
+	return DecodeInstance(WorldMatrix.Instances[VisibleInstances.Indices[gl_InstanceIndex]]);
+}
+
+void WriteOutputs(mat4 model, vec3 position, vec3 normal, vec2 texCoor, uint textureIdx)
+{
+	fragWorldPosition = vec3(model * vec4(position, 1.0));
+	gl_Position = VPMatrix.Projection * VPMatrix.View * vec4(fragWorldPosition, 1.0);
+	fragWorldNormal = normalize(normalize(normal) * mat3(model));
+	fragTexCoor = texCoor;
+	fragTextureIdx = textureIdx;
+}
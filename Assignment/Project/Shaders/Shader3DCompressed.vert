@@ -0,0 +1,26 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "Shader3D.glsl"
+
+//vkUtil::CompressedVertex3D, the formats of the attributes already turn the integers into floats
+layout(location = 0) in vec4 vertexQuantizedPosition;
+layout(location = 1) in vec2 vertexOctahedralNormal;
+layout(location = 2) in vec2 vertexTexCoor;
+
+//has to match vkUtil::DecodeOctahedral
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0);
+	normal.x += normal.x >= 0.0 ? -fold : fold;
+	normal.y += normal.y >= 0.0 ? -fold : fold;
+	return normal;
+}
+
+void main()
+{
+	DrawData drawData = GetDrawData();
+	vec3 position = drawData.PositionOffset + vertexQuantizedPosition.xyz * drawData.PositionScale;
+	WriteOutputs(GetModelMatrix(), position, DecodeOctahedral(vertexOctahedralNormal), vertexTexCoor, drawData.TextureIdx);
+}
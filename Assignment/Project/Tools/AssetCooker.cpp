@@ -0,0 +1,236 @@
+#include "Engine/Configuration.h"
+#include "Utils/CookedAsset.h"
+#include "Utils/FileReader.h"
+#include "Utils/Bounds.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/MeshSimplifier.h"
+#include "Utils/VertexCompression.h"
+#include "Utils/BlockCompression.h"
+#include "Utils/Ktx2.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "Utils/STBI.h"
+#include <filesystem>
+
+//converts the obj meshes and the png/jpg textures of the given files or directories into the cooked format the engine maps at startup
+//textures also get a bc7 ktx2 file the engine uploads as is when the device can sample it
+//usage: AssetCooker [--force] [--flip] [--compress] [--bc1] <file or directory>...
+//	--force	cook every asset again, even when its cooked file is current
+//	--flip	flip the axis and winding of the obj meshes, has to match the flag the engine loads them with
+//	--compress	store the obj meshes as CompressedVertex3D, has to match the vertex type the engine loads them as
+//	--bc1	compress opaque textures to bc1 instead of bc7, half the size at a lower quality
+
+namespace
+{
+	struct CookSettings
+	{
+		bool Force{ false };
+		bool FlipAxisAndWinding{ false };
+		bool CompressVertices{ false };
+		bool OpaqueAsBC1{ false };
+	};
+
+	bool CookMesh(std::string const& fileName, CookSettings const& settings)
+	{
+		using V3D = vkUtil::Vertex3D;
+		using CV3D = vkUtil::CompressedVertex3D;
+
+		uint32_t flags{ settings.FlipAxisAndWinding ? vkUtil::CookedFlags::FlipAxisAndWinding : vkUtil::CookedFlags::None };
+		if (settings.CompressVertices)
+		{
+			flags |= vkUtil::CookedFlags::CompressedVertices;
+		}
+		std::string const cookedFileName{ vkUtil::GetCookedFileName(fileName, flags) };
+		if (not settings.Force and vkUtil::CookedAsset{ cookedFileName, fileName, flags }.IsValid())
+		{
+			std::cout << "\tcurrent: " << fileName << "\n";
+			return true;
+		}
+
+		std::vector<V3D> vertexVec{};
+		std::vector<uint32_t> indexVec{};
+		std::vector<vkUtil::MeshLod> lodVec{};
+		vkUtil::MeshBounds bounds{};
+		if (not vkUtil::ParseMesh<V3D>(fileName, vertexVec, indexVec, lodVec, bounds, settings.FlipAxisAndWinding))
+		{
+			std::cout << "\tfailed to parse: " << fileName << "\n";
+			return false;
+		}
+
+		std::vector<vkUtil::CookedChunkData> chunkVec
+		{
+			{ vkUtil::CookedChunkType::Indices, sizeof(uint32_t), std::as_bytes(std::span<uint32_t const>{ indexVec }) },
+			{ vkUtil::CookedChunkType::Bounds, sizeof(vkUtil::MeshBounds), std::as_bytes(std::span<vkUtil::MeshBounds const>{ &bounds, 1 }) },
+			{ vkUtil::CookedChunkType::Lods, sizeof(vkUtil::MeshLod), std::as_bytes(std::span<vkUtil::MeshLod const>{ lodVec }) }
+		};
+
+		//has to outlive the write, the chunks only point at it
+		std::vector<CV3D> compressedVertexVec{};
+		vkUtil::VertexQuantization quantization{};
+		if (settings.CompressVertices)
+		{
+			quantization = vkUtil::ComputeQuantization(bounds);
+			compressedVertexVec = vkUtil::CompressVertices(vertexVec, quantization);
+			vkUtil::PrintCompressionReport(fileName, vertexVec, compressedVertexVec, quantization);
+
+			chunkVec.push_back({ vkUtil::CookedChunkType::Vertices, sizeof(CV3D), std::as_bytes(std::span<CV3D const>{ compressedVertexVec }) });
+			chunkVec.push_back({ vkUtil::CookedChunkType::Quantization, sizeof(vkUtil::VertexQuantization), std::as_bytes(std::span<vkUtil::VertexQuantization const>{ &quantization, 1 }) });
+		}
+		else
+		{
+			chunkVec.push_back({ vkUtil::CookedChunkType::Vertices, sizeof(V3D), std::as_bytes(std::span<V3D const>{ vertexVec }) });
+		}
+
+		if (not vkUtil::WriteCookedAsset(cookedFileName, fileName, flags, chunkVec))
+		{
+			std::cout << "\tfailed to write: " << cookedFileName << "\n";
+			return false;
+		}
+
+		std::cout << "\tcooked: " << fileName << " (" << vertexVec.size() << (settings.CompressVertices ? " compressed" : "") << " vertices, " << indexVec.size() << " indices, " << lodVec.size() << " lods)\n";
+		return true;
+	}
+
+	bool CookTexture(std::string const& fileName, CookSettings const& settings)
+	{
+		std::string const cookedFileName{ vkUtil::GetCookedFileName(fileName) };
+		std::string const ktx2FileName{ vkUtil::GetKtx2FileName(fileName) };
+		//a ktx2 file written with the other block format still counts as current, --force replaces it
+		bool const cookedCurrent{ not settings.Force and vkUtil::CookedAsset{ cookedFileName, fileName, vkUtil::CookedFlags::None }.IsValid() };
+		bool const ktx2Current{ not settings.Force and vkUtil::IsKtx2Current(ktx2FileName, fileName) };
+		if (cookedCurrent and ktx2Current)
+		{
+			std::cout << "\tcurrent: " << fileName << "\n";
+			return true;
+		}
+
+		int width{}, height{}, channels{};
+		unsigned char* pixelPtr{ stbi_load(fileName.c_str(), &width, &height, &channels, STBI_rgb_alpha) };
+		if (pixelPtr == nullptr)
+		{
+			std::cout << "\tfailed to decode: " << fileName << "\n";
+			return false;
+		}
+
+		vkUtil::CookedTextureHeader header{};
+		header.Width = static_cast<uint32_t>(width);
+		header.Height = static_cast<uint32_t>(height);
+		header.MipLevels = vkUtil::GetMipLevelCount(header.Width, header.Height);
+
+		std::vector<unsigned char> const levelVec{ vkUtil::GenerateMipChain(pixelPtr, header.Width, header.Height, header.MipLevels) };
+		stbi_image_free(pixelPtr);
+
+		if (not cookedCurrent)
+		{
+			std::vector<vkUtil::CookedChunkData> const chunkVec
+			{
+				{ vkUtil::CookedChunkType::TextureHeader, sizeof(vkUtil::CookedTextureHeader), std::as_bytes(std::span<vkUtil::CookedTextureHeader const>{ &header, 1 }) },
+				{ vkUtil::CookedChunkType::TextureLevels, sizeof(unsigned char), std::as_bytes(std::span<unsigned char const>{ levelVec }) }
+			};
+
+			if (not vkUtil::WriteCookedAsset(cookedFileName, fileName, vkUtil::CookedFlags::None, chunkVec))
+			{
+				std::cout << "\tfailed to write: " << cookedFileName << "\n";
+				return false;
+			}
+
+			std::cout << "\tcooked: " << fileName << " (" << width << "x" << height << ", " << header.MipLevels << " mips)\n";
+		}
+
+		if (not ktx2Current)
+		{
+			//bc1 has no alpha, a texture with transparency stays bc7
+			bool const useBC1{ settings.OpaqueAsBC1 and not vkUtil::HasTransparency(levelVec) };
+			vk::Format const format{ useBC1 ? vk::Format::eBc1RgbUnormBlock : vk::Format::eBc7UnormBlock };
+
+			std::vector<unsigned char> const blockVec{ vkUtil::CompressMipChain(levelVec, header.Width, header.Height, header.MipLevels, format) };
+			if (not vkUtil::WriteKtx2(ktx2FileName, format, header.Width, header.Height, header.MipLevels, blockVec, vkUtil::Ktx2Supercompression::Zstandard))
+			{
+				std::cout << "\tfailed to write: " << ktx2FileName << "\n";
+				return false;
+			}
+
+			//the gpu holds the blocks, the file on disk can be smaller still when it is supercompressed
+			std::error_code errorCode{};
+			std::uintmax_t const fileSize{ std::filesystem::file_size(ktx2FileName, errorCode) };
+			std::cout << "\tblock compressed: " << fileName << " (" << (useBC1 ? "bc1" : "bc7") << ", " << blockVec.size() / 1024 << " KB instead of " << levelVec.size() / 1024
+				<< " KB in memory, " << fileSize / 1024 << " KB on disk)\n";
+		}
+		return true;
+	}
+
+	bool CookFile(std::filesystem::path const& path, CookSettings const& settings)
+	{
+		std::string extension{ path.extension().string() };
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+
+		if (extension == ".obj")
+		{
+			return CookMesh(path.string(), settings);
+		}
+		if (extension == ".png" or extension == ".jpg" or extension == ".jpeg" or extension == ".tga")
+		{
+			return CookTexture(path.string(), settings);
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	CookSettings settings{};
+	std::vector<std::filesystem::path> pathVec{};
+	for (int argIdx{ 1 }; argIdx < argc; ++argIdx)
+	{
+		std::string const arg{ argv[argIdx] };
+		if (arg == "--force")
+		{
+			settings.Force = true;
+		}
+		else if (arg == "--flip")
+		{
+			settings.FlipAxisAndWinding = true;
+		}
+		else if (arg == "--compress")
+		{
+			settings.CompressVertices = true;
+		}
+		else if (arg == "--bc1")
+		{
+			settings.OpaqueAsBC1 = true;
+		}
+		else
+		{
+			pathVec.emplace_back(arg);
+		}
+	}
+
+	if (pathVec.empty())
+	{
+		std::cout << "usage: AssetCooker [--force] [--flip] [--compress] [--bc1] <file or directory>...\n";
+		return 1;
+	}
+
+	bool succeeded{ true };
+	for (const auto& path : pathVec)
+	{
+		std::cout << "Cooking " << path.string() << "\n";
+
+		std::error_code errorCode{};
+		if (std::filesystem::is_directory(path, errorCode))
+		{
+			for (const auto& entry : std::filesystem::directory_iterator{ path, errorCode })
+			{
+				if (entry.is_regular_file())
+				{
+					succeeded = CookFile(entry.path(), settings) and succeeded;
+				}
+			}
+		}
+		else
+		{
+			succeeded = CookFile(path, settings) and succeeded;
+		}
+	}
+
+	return succeeded ? 0 : 1;
+}
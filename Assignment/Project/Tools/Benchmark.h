@@ -0,0 +1,44 @@
+#ifndef VK_BENCHMARK_H
+#define VK_BENCHMARK_H
+#include "Engine/Configuration.h"
+#include <iomanip>
+#include <limits>
+
+namespace ave
+{
+
+	//fastest of repetitionCount runs in milliseconds, the first run also warms the caches
+	template<typename Function>
+	double MeasureMilliseconds(int repetitionCount, Function&& function)
+	{
+		double bestMilliseconds{ std::numeric_limits<double>::max() };
+		for (int repetitionIdx{}; repetitionIdx < repetitionCount; ++repetitionIdx)
+		{
+			auto const start{ std::chrono::high_resolution_clock::now() };
+			function();
+			bestMilliseconds = std::min(bestMilliseconds, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+		}
+		return bestMilliseconds;
+	}
+
+	//one row of a benchmark table, the name left aligned and the values right aligned behind it
+	inline void PrintBenchmarkRow(std::string const& name, std::vector<std::string> const& valueVec)
+	{
+		std::cout << "\t" << std::left << std::setw(24) << name << std::right;
+		for (const auto& value : valueVec)
+		{
+			std::cout << std::setw(16) << value;
+		}
+		std::cout << "\n";
+	}
+
+	inline std::string FormatMilliseconds(double milliseconds)
+	{
+		std::ostringstream stream{};
+		stream << std::fixed << std::setprecision(2) << milliseconds << " ms";
+		return stream.str();
+	}
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "Engine/Configuration.h"
+#include "Engine/ThreadPool.h"
+#include "Utils/Culling.h"
+#include "Tools/Benchmark.h"
+#include <random>
+
+//culls 10k to 10M instances with the instruction set this executable was compiled for and checks the visible indices against a plain scalar test
+//the instruction set is picked at compile time, CMake builds CullBenchmarkScalar, CullBenchmarkSse and CullBenchmarkAvx2 from this file
+//usage: CullBenchmark<InstructionSet>
+
+namespace
+{
+	//instances scattered around the camera so part of them is in the frustum
+	std::vector<glm::mat4> CreateWorldMatrices(std::int64_t instanceCount)
+	{
+		std::mt19937 generator{ 1234 };
+		std::uniform_real_distribution<float> positionDistribution{ -9000.f, 9000.f };
+		std::uniform_real_distribution<float> scaleDistribution{ 0.5f, 2.f };
+
+		std::vector<glm::mat4> worldMatrixVec{};
+		worldMatrixVec.reserve(instanceCount);
+		for (std::int64_t instanceIdx{}; instanceIdx < instanceCount; ++instanceIdx)
+		{
+			glm::vec3 const position{ positionDistribution(generator), positionDistribution(generator) / 10.f, positionDistribution(generator) };
+			worldMatrixVec.emplace_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(scaleDistribution(generator))));
+		}
+		return worldMatrixVec;
+	}
+
+	//the planes of a camera in the origin looking down the z axis, the same way Camera::GetFrustumPlanes builds them
+	std::array<glm::vec4, 6> CreateFrustumPlanes()
+	{
+		glm::mat4 const projection{ glm::perspective(45.f * ave::ToRadians, 16.f / 9.f, 0.1f, 5000.f) };
+		glm::mat4 const view{ glm::lookAt(glm::vec3{ 0.f, 0.f, 0.f }, glm::vec3{ 0.f, 0.f, 1.f }, glm::vec3{ 0.f, 1.f, 0.f }) };
+		glm::mat4 const viewProjection{ glm::transpose(projection * view) };
+
+		std::array<glm::vec4, 6> planeArr
+		{
+			viewProjection[3] + viewProjection[0],
+			viewProjection[3] - viewProjection[0],
+			viewProjection[3] + viewProjection[1],
+			viewProjection[3] - viewProjection[1],
+			viewProjection[3] + viewProjection[2],
+			viewProjection[3] - viewProjection[2]
+		};
+
+		for (auto& plane : planeArr)
+		{
+			plane /= glm::length(glm::vec3{ plane });
+		}
+
+		return planeArr;
+	}
+
+	//one instance at a time with the same arithmetic as the scalar path of the culler
+	std::vector<uint32_t> CullReference(std::array<glm::vec4, 6> const& frustumPlaneArr, vkUtil::MeshBounds const& bounds, std::vector<glm::mat4> const& worldMatrixVec)
+	{
+		std::vector<uint32_t> visibleIdxVec{};
+		glm::vec4 const localCenter{ bounds.Center, 1.f };
+		for (std::int64_t idx{}; idx < std::ssize(worldMatrixVec); ++idx)
+		{
+			glm::mat4 const& worldMatrix{ worldMatrixVec[idx] };
+			glm::vec4 const center{ worldMatrix * localCenter };
+			float const scaleSquared{ std::max({ glm::dot(glm::vec3{ worldMatrix[0] }, glm::vec3{ worldMatrix[0] }),
+				glm::dot(glm::vec3{ worldMatrix[1] }, glm::vec3{ worldMatrix[1] }),
+				glm::dot(glm::vec3{ worldMatrix[2] }, glm::vec3{ worldMatrix[2] }) }) };
+			float const radius{ bounds.Radius * std::sqrt(scaleSquared) };
+
+			bool inside{ true };
+			for (int planeIdx{}; planeIdx < 6 and inside; ++planeIdx)
+			{
+				glm::vec4 const& plane{ frustumPlaneArr[planeIdx] };
+				inside = plane.x * center.x + plane.w + plane.y * center.y + plane.z * center.z >= -radius;
+			}
+
+			if (inside)
+			{
+				visibleIdxVec.emplace_back(static_cast<uint32_t>(idx));
+			}
+		}
+		return visibleIdxVec;
+	}
+}
+
+int main()
+{
+	std::array<glm::vec4, 6> const frustumPlaneArr{ CreateFrustumPlanes() };
+	vkUtil::MeshBounds const bounds{ glm::vec3{ -1.f }, glm::vec3{ 1.f }, glm::vec3{ 0.f }, std::sqrt(3.f) };
+
+	std::cout << "instruction set " << vkUtil::InstanceCuller::GetInstructionSetName() << ", " << ave::ThreadPool::GetInstance().GetThreadCount() << " threads\n";
+	ave::PrintBenchmarkRow("instances", { "visible", "cull", "per instance", "scalar check" });
+
+	bool allMatch{ true };
+	for (std::int64_t const instanceCount : { std::int64_t{ 10'000 }, std::int64_t{ 100'000 }, std::int64_t{ 1'000'000 }, std::int64_t{ 10'000'000 } })
+	{
+		std::vector<glm::mat4> const worldMatrixVec{ CreateWorldMatrices(instanceCount) };
+
+		//stands in for the mapped visible index buffer
+		std::vector<uint32_t> visibleIdxVec(worldMatrixVec.size());
+		//a mesh without lods, only the frustum test is timed
+		vkUtil::LodCullInBundle const lodIn{};
+		std::array<uint32_t, vkUtil::MaxLodCount> lodVisibleCountArr{};
+		vkUtil::InstanceCuller culler{};
+		std::int64_t visibleCount{};
+		double const milliseconds{ ave::MeasureMilliseconds(5, [&]()
+			{
+				visibleCount = culler.Cull(frustumPlaneArr, bounds, worldMatrixVec, 0, lodIn, visibleIdxVec.data(), lodVisibleCountArr);
+			}) };
+		visibleIdxVec.resize(static_cast<std::size_t>(visibleCount));
+
+		bool const match{ visibleIdxVec == CullReference(frustumPlaneArr, bounds, worldMatrixVec) };
+		allMatch = allMatch and match;
+
+		std::ostringstream perInstanceStream{};
+		perInstanceStream << std::fixed << std::setprecision(2) << milliseconds * 1.0e6 / static_cast<double>(instanceCount) << " ns";
+		ave::PrintBenchmarkRow(std::to_string(instanceCount), { std::to_string(visibleCount), ave::FormatMilliseconds(milliseconds), perInstanceStream.str(), match ? "match" : "MISMATCH" });
+	}
+
+	return allMatch ? 0 : 1;
+}
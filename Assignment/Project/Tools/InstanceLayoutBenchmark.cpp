@@ -0,0 +1,79 @@
+#include "Engine/Configuration.h"
+#include "Utils/InstanceLayout.h"
+#include "Tools/Benchmark.h"
+#include <random>
+#include <cstring>
+
+//encodes the same instance transforms with every instance layout, the way the meshes write their dirty ranges into the mapped instance buffer
+//prints the bytes a full upload of the instances takes and the time the encode of all of them takes
+//usage: InstanceLayoutBenchmark
+
+namespace
+{
+	//positions across the extent of the bundled grid scene, random rotations and uniform scales
+	std::vector<glm::mat4> CreateWorldMatrices(std::int64_t instanceCount)
+	{
+		std::mt19937 generator{ 1234 };
+		std::uniform_real_distribution<float> positionDistribution{ -9000.f, 9000.f };
+		std::uniform_real_distribution<float> angleDistribution{ 0.f, 2.f * ave::Pi };
+		std::uniform_real_distribution<float> scaleDistribution{ 0.5f, 2.f };
+
+		std::vector<glm::mat4> worldMatrixVec{};
+		worldMatrixVec.reserve(instanceCount);
+		for (std::int64_t instanceIdx{}; instanceIdx < instanceCount; ++instanceIdx)
+		{
+			glm::vec3 const position{ positionDistribution(generator), positionDistribution(generator) / 10.f, positionDistribution(generator) };
+
+			glm::mat4 worldMatrix{ glm::translate(glm::mat4(1.0f), position) };
+			worldMatrix = glm::rotate(worldMatrix, angleDistribution(generator), glm::vec3(0.0f, 1.0f, 0.0f));
+			worldMatrix = glm::rotate(worldMatrix, angleDistribution(generator), glm::vec3(1.0f, 0.0f, 0.0f));
+			worldMatrix = glm::scale(worldMatrix, glm::vec3(scaleDistribution(generator)));
+			worldMatrixVec.emplace_back(worldMatrix);
+		}
+		return worldMatrixVec;
+	}
+
+	template<vkUtil::InstanceLayout LayoutPolicy>
+	void BenchmarkLayout(std::string const& layoutName, std::vector<glm::mat4> const& worldMatrixVec)
+	{
+		using GPUInstance = typename LayoutPolicy::GPUInstance;
+
+		//stands in for the mapped instance buffer
+		std::vector<GPUInstance> instanceVec(worldMatrixVec.size());
+		double const milliseconds{ ave::MeasureMilliseconds(5, [&]()
+			{
+				std::transform(worldMatrixVec.begin(), worldMatrixVec.end(), instanceVec.begin(), &LayoutPolicy::Encode);
+			}) };
+
+		//reads a word of every instance back so the encode can not be dropped
+		uint32_t checksum{};
+		for (const auto& instance : instanceVec)
+		{
+			uint32_t word{};
+			std::memcpy(&word, &instance, sizeof(word));
+			checksum ^= word;
+		}
+
+		std::size_t const bytes{ instanceVec.size() * sizeof(GPUInstance) };
+		std::ostringstream bandwidthStream{};
+		bandwidthStream << std::fixed << std::setprecision(2) << static_cast<double>(bytes) / (milliseconds * 1.0e6) << " GB/s";
+		ave::PrintBenchmarkRow(layoutName, { std::to_string(sizeof(GPUInstance)) + " B", std::to_string(bytes / 1024) + " KB", ave::FormatMilliseconds(milliseconds), bandwidthStream.str(), std::to_string(checksum) });
+	}
+}
+
+int main()
+{
+	for (std::int64_t const instanceCount : { std::int64_t{ 100'000 }, std::int64_t{ 1'000'000 } })
+	{
+		std::vector<glm::mat4> const worldMatrixVec{ CreateWorldMatrices(instanceCount) };
+
+		std::cout << instanceCount << " instances\n";
+		ave::PrintBenchmarkRow("layout", { "instance", "upload", "encode", "throughput", "checksum" });
+		BenchmarkLayout<vkUtil::InstanceLayoutMat4>("Mat4", worldMatrixVec);
+		BenchmarkLayout<vkUtil::InstanceLayoutAffine>("Affine", worldMatrixVec);
+		BenchmarkLayout<vkUtil::InstanceLayoutTRS>("TRS", worldMatrixVec);
+		BenchmarkLayout<vkUtil::InstanceLayoutHalfTRS>("HalfTRS", worldMatrixVec);
+	}
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include "Engine/Configuration.h"
+#include "Engine/ThreadPool.h"
+#include "Utils/FileReader.h"
+#include "Tools/Benchmark.h"
+#include <cstring>
+#include <filesystem>
+
+//parses obj files with the parser the engine used before the memory mapped one and with vkUtil::ParseOBJ, and checks that both give the same mesh
+//SyntheticObjGenerator writes a 10M triangle file to run it on
+//usage: ObjParseBenchmark <obj file>...
+
+namespace
+{
+	//the std::ifstream parser vkUtil::ParseOBJ replaced, triangles only and no negative indices
+	//it reads the line after the last one again at the end of the file, so its last triangle comes out twice
+	template<typename VertexStruct>
+	bool ParseOBJLegacy(const std::string& filename, std::vector<VertexStruct>& vertexVec, std::vector<uint32_t>& indexVec, bool flipAxisAndWinding)
+	{
+		std::ifstream file{ filename };
+		if (not file)
+		{
+			return false;
+		}
+
+		std::vector<glm::vec3> positionVec{};
+		std::vector<glm::vec3> normalVec{};
+		std::vector<glm::vec2> uvVec{};
+
+		vertexVec.clear();
+		indexVec.clear();
+
+		std::string command;
+		while (not file.eof())
+		{
+			file >> command;
+			if (command == "v")
+			{
+				float x, y, z;
+				file >> x >> y >> z;
+				positionVec.emplace_back(glm::vec3{ x, y, z });
+			}
+			else if (command == "vt")
+			{
+				float u, v;
+				file >> u >> v;
+				uvVec.emplace_back(u, 1 - v);
+			}
+			else if (command == "vn")
+			{
+				float x, y, z;
+				file >> x >> y >> z;
+				normalVec.emplace_back(glm::vec3{ x, y, z });
+			}
+			else if (command == "f")
+			{
+				VertexStruct vertex{};
+				std::size_t positionIdx, uvIdx, normalIdx;
+
+				uint32_t cornerIdxArr[3];
+				for (std::size_t cornerIdx{}; cornerIdx < 3; ++cornerIdx)
+				{
+					//obj indices start at 1
+					file >> positionIdx;
+					vertex.Position = positionVec[positionIdx - 1];
+					vertex.Position.z *= -1.f;
+
+					if ('/' == file.peek())
+					{
+						file.ignore();
+						if ('/' != file.peek())
+						{
+							file >> uvIdx;
+							vertex.UV = uvVec[uvIdx - 1];
+						}
+						if ('/' == file.peek())
+						{
+							file.ignore();
+							file >> normalIdx;
+							vertex.Normal = normalVec[normalIdx - 1];
+						}
+					}
+
+					vertexVec.emplace_back(vertex);
+					cornerIdxArr[cornerIdx] = static_cast<uint32_t>(vertexVec.size()) - 1;
+				}
+
+				indexVec.emplace_back(cornerIdxArr[0]);
+				indexVec.emplace_back(flipAxisAndWinding ? cornerIdxArr[2] : cornerIdxArr[1]);
+				indexVec.emplace_back(flipAxisAndWinding ? cornerIdxArr[1] : cornerIdxArr[2]);
+			}
+			//comments and the commands the engine does not use are skipped with the rest of the line
+			file.ignore(1000, '\n');
+		}
+		return true;
+	}
+
+	//the legacy parser may only differ by the repeated last triangle
+	template<typename VertexStruct>
+	bool IsSameMesh(std::vector<VertexStruct> const& legacyVertexVec, std::vector<uint32_t> const& legacyIndexVec, std::vector<VertexStruct> const& vertexVec, std::vector<uint32_t> const& indexVec)
+	{
+		if (legacyVertexVec.size() != vertexVec.size() and legacyVertexVec.size() != vertexVec.size() + 3)
+		{
+			return false;
+		}
+		return std::equal(indexVec.begin(), indexVec.end(), legacyIndexVec.begin())
+			and std::memcmp(legacyVertexVec.data(), vertexVec.data(), vertexVec.size() * sizeof(VertexStruct)) == 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using V3D = vkUtil::Vertex3D;
+
+	if (argc < 2)
+	{
+		std::cout << "usage: ObjParseBenchmark <obj file>...\n";
+		return 1;
+	}
+
+	std::cout << ave::ThreadPool::GetInstance().GetThreadCount() << " threads\n";
+	ave::PrintBenchmarkRow("file", { "size", "triangles", "legacy", "mapped", "speedup", "same mesh" });
+
+	bool allSame{ true };
+	for (int argIdx{ 1 }; argIdx < argc; ++argIdx)
+	{
+		std::string const fileName{ argv[argIdx] };
+		std::uintmax_t const fileBytes{ std::filesystem::file_size(fileName) };
+		//a large file takes seconds per parse, one run is enough there
+		int const repetitionCount{ fileBytes > 100 * 1024 * 1024 ? 1 : 5 };
+
+		std::vector<V3D> legacyVertexVec{};
+		std::vector<uint32_t> legacyIndexVec{};
+		bool legacyParsed{};
+		double const legacyMilliseconds{ ave::MeasureMilliseconds(repetitionCount, [&]()
+			{
+				legacyParsed = ParseOBJLegacy<V3D>(fileName, legacyVertexVec, legacyIndexVec, true);
+			}) };
+
+		std::vector<V3D> vertexVec{};
+		std::vector<uint32_t> indexVec{};
+		bool parsed{};
+		double const milliseconds{ ave::MeasureMilliseconds(repetitionCount, [&]()
+			{
+				parsed = vkUtil::ParseOBJ<V3D>(fileName, vertexVec, indexVec, true);
+			}) };
+
+		bool const same{ legacyParsed and parsed and IsSameMesh(legacyVertexVec, legacyIndexVec, vertexVec, indexVec) };
+		allSame = allSame and same;
+
+		std::ostringstream sizeStream{};
+		sizeStream << std::fixed << std::setprecision(1) << static_cast<double>(fileBytes) / (1024.0 * 1024.0) << " MB";
+		std::ostringstream speedupStream{};
+		speedupStream << std::fixed << std::setprecision(2) << legacyMilliseconds / milliseconds << "x";
+		ave::PrintBenchmarkRow(std::filesystem::path{ fileName }.filename().string(), { sizeStream.str(), std::to_string(indexVec.size() / 3),
+			ave::FormatMilliseconds(legacyMilliseconds), ave::FormatMilliseconds(milliseconds), speedupStream.str(), same ? "yes" : "NO" });
+	}
+
+	return allSame ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//writes a wavy grid as an obj file with positions, uvs and normals, every face references all three
+//the default 10M triangles give a file of about 1.1 GB, large enough that the parse time is not lost in the noise
+//usage: SyntheticObjGenerator <output file> [triangle count]
+
+namespace
+{
+	//one line goes through a stack buffer, formatting with the stream operators would take longer than the parsers it feeds
+	void AppendLine(std::string& text, char const* format, auto... values)
+	{
+		char lineBuffer[128];
+		int const length{ std::snprintf(lineBuffer, sizeof(lineBuffer), format, values...) };
+		text.append(lineBuffer, static_cast<std::size_t>(length));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "usage: SyntheticObjGenerator <output file> [triangle count]\n";
+		return 1;
+	}
+
+	std::int64_t const triangleCount{ argc > 2 ? std::stoll(argv[2]) : 10'000'000 };
+	//two triangles per cell of a square grid
+	std::int64_t const cellsPerSide{ std::max<std::int64_t>(1, static_cast<std::int64_t>(std::sqrt(static_cast<double>(triangleCount) / 2.0))) };
+	std::int64_t const verticesPerSide{ cellsPerSide + 1 };
+
+	std::ofstream file{ argv[1], std::ios::binary };
+	if (not file)
+	{
+		std::cout << "Could not open " << argv[1] << "\n";
+		return 1;
+	}
+
+	std::string text{};
+	text.reserve(64 * 1024 * 1024);
+	auto const flush{ [&]()
+		{
+			file.write(text.data(), static_cast<std::streamsize>(text.size()));
+			text.clear();
+		} };
+
+	text.append("# synthetic grid written by SyntheticObjGenerator\n");
+	for (std::int64_t rowIdx{}; rowIdx < verticesPerSide; ++rowIdx)
+	{
+		for (std::int64_t columnIdx{}; columnIdx < verticesPerSide; ++columnIdx)
+		{
+			float const x{ static_cast<float>(columnIdx) * 0.01f };
+			float const z{ static_cast<float>(rowIdx) * 0.01f };
+			AppendLine(text, "v %f %f %f\n", x, 0.05f * std::sin(5.f * x), z);
+		}
+		if (text.size() > 60 * 1024 * 1024)
+		{
+			flush();
+		}
+	}
+	for (std::int64_t rowIdx{}; rowIdx < verticesPerSide; ++rowIdx)
+	{
+		for (std::int64_t columnIdx{}; columnIdx < verticesPerSide; ++columnIdx)
+		{
+			AppendLine(text, "vt %f %f\n", static_cast<float>(columnIdx) / static_cast<float>(cellsPerSide), static_cast<float>(rowIdx) / static_cast<float>(cellsPerSide));
+		}
+		if (text.size() > 60 * 1024 * 1024)
+		{
+			flush();
+		}
+	}
+	for (std::int64_t rowIdx{}; rowIdx < verticesPerSide; ++rowIdx)
+	{
+		for (std::int64_t columnIdx{}; columnIdx < verticesPerSide; ++columnIdx)
+		{
+			//normal of the height function 0.05 sin(5x)
+			float const slope{ 0.25f * std::cos(5.f * static_cast<float>(columnIdx) * 0.01f) };
+			float const length{ std::sqrt(slope * slope + 1.f) };
+			AppendLine(text, "vn %f %f %f\n", -slope / length, 1.f / length, 0.f);
+		}
+		if (text.size() > 60 * 1024 * 1024)
+		{
+			flush();
+		}
+	}
+
+	//obj indices start at 1, position, uv and normal share the index because every vertex has one of each
+	for (std::int64_t rowIdx{}; rowIdx < cellsPerSide; ++rowIdx)
+	{
+		for (std::int64_t columnIdx{}; columnIdx < cellsPerSide; ++columnIdx)
+		{
+			long long const topLeft{ rowIdx * verticesPerSide + columnIdx + 1 };
+			long long const topRight{ topLeft + 1 };
+			long long const bottomLeft{ topLeft + verticesPerSide };
+			long long const bottomRight{ bottomLeft + 1 };
+			AppendLine(text, "f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n", topLeft, topLeft, topLeft, bottomLeft, bottomLeft, bottomLeft, topRight, topRight, topRight);
+			AppendLine(text, "f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n", topRight, topRight, topRight, bottomLeft, bottomLeft, bottomLeft, bottomRight, bottomRight, bottomRight);
+		}
+		if (text.size() > 60 * 1024 * 1024)
+		{
+			flush();
+		}
+	}
+	flush();
+
+	std::cout << "Wrote " << verticesPerSide * verticesPerSide << " vertices and " << 2 * cellsPerSide * cellsPerSide << " triangles to " << argv[1] << "\n";
+	return 0;
+}
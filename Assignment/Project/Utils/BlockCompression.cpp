@@ -0,0 +1,399 @@
+#include "BlockCompression.h"
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	constexpr uint32_t BlockDim{ 4 };
+	constexpr uint32_t BlockTexels{ BlockDim * BlockDim };
+
+	//appends bits to a block lowest bit first, the way every bc format is laid out
+	class BlockWriter final
+	{
+	public:
+		explicit BlockWriter(std::span<unsigned char> blockSpan)
+			: m_BlockSpan{ blockSpan }
+		{
+			std::fill(m_BlockSpan.begin(), m_BlockSpan.end(), static_cast<unsigned char>(0));
+		}
+
+		void Write(uint32_t value, uint32_t bitCount)
+		{
+			for (uint32_t bitIdx{}; bitIdx < bitCount; ++bitIdx, ++m_BitOffset)
+			{
+				if ((value >> bitIdx) & 1u)
+				{
+					m_BlockSpan[m_BitOffset / 8] |= static_cast<unsigned char>(1u << (m_BitOffset % 8));
+				}
+			}
+		}
+	private:
+		std::span<unsigned char> m_BlockSpan;
+		uint32_t m_BitOffset{};
+	};
+
+	//the direction the texels of a block vary the most along, by power iteration on their covariance
+	template<std::size_t Channels>
+	std::array<float, Channels> GetPrincipalAxis(std::span<unsigned char const, 64> texelSpan, std::array<float, Channels> const& mean)
+	{
+		std::array<std::array<float, Channels>, Channels> covariance{};
+		for (uint32_t texelIdx{}; texelIdx < BlockTexels; ++texelIdx)
+		{
+			for (std::size_t row{}; row < Channels; ++row)
+			{
+				for (std::size_t column{}; column < Channels; ++column)
+				{
+					covariance[row][column] += (texelSpan[texelIdx * 4 + row] - mean[row]) * (texelSpan[texelIdx * 4 + column] - mean[column]);
+				}
+			}
+		}
+
+		std::array<float, Channels> axis{};
+		axis.fill(1.f);
+		for (int iteration{}; iteration < 8; ++iteration)
+		{
+			std::array<float, Channels> next{};
+			for (std::size_t row{}; row < Channels; ++row)
+			{
+				for (std::size_t column{}; column < Channels; ++column)
+				{
+					next[row] += covariance[row][column] * axis[column];
+				}
+			}
+
+			float length{};
+			for (float const value : next)
+			{
+				length = std::max(length, std::abs(value));
+			}
+			//a block of one color has no direction, any axis reproduces it
+			if (length == 0.f)
+			{
+				return axis;
+			}
+
+			for (std::size_t channel{}; channel < Channels; ++channel)
+			{
+				axis[channel] = next[channel] / length;
+			}
+		}
+		return axis;
+	}
+
+	//the two ends of the texels projected onto their principal axis, clamped to the range of a channel
+	template<std::size_t Channels>
+	std::array<std::array<float, Channels>, 2> GetEndpoints(std::span<unsigned char const, 64> texelSpan)
+	{
+		std::array<float, Channels> mean{};
+		for (uint32_t texelIdx{}; texelIdx < BlockTexels; ++texelIdx)
+		{
+			for (std::size_t channel{}; channel < Channels; ++channel)
+			{
+				mean[channel] += texelSpan[texelIdx * 4 + channel] / static_cast<float>(BlockTexels);
+			}
+		}
+
+		std::array<float, Channels> const axis{ GetPrincipalAxis<Channels>(texelSpan, mean) };
+		float axisLengthSq{};
+		for (float const value : axis)
+		{
+			axisLengthSq += value * value;
+		}
+
+		float minProjection{ std::numeric_limits<float>::max() };
+		float maxProjection{ std::numeric_limits<float>::lowest() };
+		for (uint32_t texelIdx{}; texelIdx < BlockTexels; ++texelIdx)
+		{
+			float projection{};
+			for (std::size_t channel{}; channel < Channels; ++channel)
+			{
+				projection += (texelSpan[texelIdx * 4 + channel] - mean[channel]) * axis[channel];
+			}
+			projection /= axisLengthSq;
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		std::array<std::array<float, Channels>, 2> endpoints{};
+		for (std::size_t channel{}; channel < Channels; ++channel)
+		{
+			endpoints[0][channel] = std::clamp(mean[channel] + axis[channel] * minProjection, 0.f, 255.f);
+			endpoints[1][channel] = std::clamp(mean[channel] + axis[channel] * maxProjection, 0.f, 255.f);
+		}
+		return endpoints;
+	}
+
+	template<std::size_t Channels>
+	uint32_t GetDistanceSq(unsigned char const* texelPtr, std::array<int, 4> const& color)
+	{
+		uint32_t distanceSq{};
+		for (std::size_t channel{}; channel < Channels; ++channel)
+		{
+			int const difference{ texelPtr[channel] - color[channel] };
+			distanceSq += static_cast<uint32_t>(difference * difference);
+		}
+		return distanceSq;
+	}
+
+	//the closest palette entry of every texel, returns the summed squared error
+	template<std::size_t Channels, std::size_t PaletteSize>
+	uint32_t FindIndices(std::span<unsigned char const, 64> texelSpan, std::array<std::array<int, 4>, PaletteSize> const& palette, std::array<uint32_t, BlockTexels>& indexArr)
+	{
+		uint32_t error{};
+		for (uint32_t texelIdx{}; texelIdx < BlockTexels; ++texelIdx)
+		{
+			uint32_t bestDistanceSq{ std::numeric_limits<uint32_t>::max() };
+			for (uint32_t paletteIdx{}; paletteIdx < PaletteSize; ++paletteIdx)
+			{
+				uint32_t const distanceSq{ GetDistanceSq<Channels>(&texelSpan[texelIdx * 4], palette[paletteIdx]) };
+				if (distanceSq < bestDistanceSq)
+				{
+					bestDistanceSq = distanceSq;
+					indexArr[texelIdx] = paletteIdx;
+				}
+			}
+			error += bestDistanceSq;
+		}
+		return error;
+	}
+
+	uint32_t ToRgb565(std::array<float, 3> const& color)
+	{
+		uint32_t const red{ static_cast<uint32_t>(std::lround(color[0] * 31.f / 255.f)) };
+		uint32_t const green{ static_cast<uint32_t>(std::lround(color[1] * 63.f / 255.f)) };
+		uint32_t const blue{ static_cast<uint32_t>(std::lround(color[2] * 31.f / 255.f)) };
+		return (red << 11) | (green << 5) | blue;
+	}
+
+	//the color the gpu decodes, the high bits are repeated into the low ones
+	std::array<int, 4> FromRgb565(uint32_t color)
+	{
+		uint32_t const red{ (color >> 11) & 31u };
+		uint32_t const green{ (color >> 5) & 63u };
+		uint32_t const blue{ color & 31u };
+		return { static_cast<int>((red << 3) | (red >> 2)), static_cast<int>((green << 2) | (green >> 4)), static_cast<int>((blue << 3) | (blue >> 2)), 255 };
+	}
+
+	//gathers the 4x4 texels of a block, texels past the edge of the level repeat the last row or column
+	void GatherBlock(unsigned char const* levelPtr, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, std::array<unsigned char, 64>& texelArr)
+	{
+		for (uint32_t y{}; y < BlockDim; ++y)
+		{
+			uint32_t const sourceY{ std::min(blockY * BlockDim + y, height - 1) };
+			for (uint32_t x{}; x < BlockDim; ++x)
+			{
+				uint32_t const sourceX{ std::min(blockX * BlockDim + x, width - 1) };
+				std::memcpy(&texelArr[(y * BlockDim + x) * 4], levelPtr + (static_cast<std::size_t>(sourceY) * width + sourceX) * 4, 4);
+			}
+		}
+	}
+}
+
+std::optional<vkUtil::FormatBlock> vkUtil::GetFormatBlock(vk::Format format)
+{
+	switch (format)
+	{
+	case vk::Format::eR8G8B8A8Unorm:
+	case vk::Format::eR8G8B8A8Srgb:
+		return FormatBlock{ 1, 1, 4 };
+	case vk::Format::eBc1RgbUnormBlock:
+	case vk::Format::eBc1RgbSrgbBlock:
+	case vk::Format::eBc1RgbaUnormBlock:
+	case vk::Format::eBc1RgbaSrgbBlock:
+		return FormatBlock{ 4, 4, 8 };
+	case vk::Format::eBc3UnormBlock:
+	case vk::Format::eBc3SrgbBlock:
+	case vk::Format::eBc5UnormBlock:
+	case vk::Format::eBc7UnormBlock:
+	case vk::Format::eBc7SrgbBlock:
+		return FormatBlock{ 4, 4, 16 };
+	//every astc block is 16 bytes, only the amount of texels it covers changes
+	case vk::Format::eAstc4x4UnormBlock:
+	case vk::Format::eAstc4x4SrgbBlock:
+		return FormatBlock{ 4, 4, 16 };
+	case vk::Format::eAstc6x6UnormBlock:
+	case vk::Format::eAstc6x6SrgbBlock:
+		return FormatBlock{ 6, 6, 16 };
+	case vk::Format::eAstc8x8UnormBlock:
+	case vk::Format::eAstc8x8SrgbBlock:
+		return FormatBlock{ 8, 8, 16 };
+	default:
+		return std::nullopt;
+	}
+}
+
+std::uint64_t vkUtil::GetLevelSize(FormatBlock const& block, uint32_t width, uint32_t height)
+{
+	std::uint64_t const blocksX{ (width + block.Width - 1) / block.Width };
+	std::uint64_t const blocksY{ (height + block.Height - 1) / block.Height };
+	return blocksX * blocksY * block.Size;
+}
+
+std::uint64_t vkUtil::GetMipChainSize(FormatBlock const& block, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+	std::uint64_t size{};
+	for (uint32_t mipLevel{}; mipLevel < mipLevels; ++mipLevel)
+	{
+		size += GetLevelSize(block, std::max(width >> mipLevel, 1u), std::max(height >> mipLevel, 1u));
+	}
+	return size;
+}
+
+bool vkUtil::HasTransparency(std::span<unsigned char const> pixelSpan)
+{
+	for (std::size_t alphaIdx{ 3 }; alphaIdx < pixelSpan.size(); alphaIdx += 4)
+	{
+		if (pixelSpan[alphaIdx] != 255)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<unsigned char> vkUtil::CompressMipChain(std::span<unsigned char const> levelSpan, uint32_t width, uint32_t height, uint32_t mipLevels, vk::Format format)
+{
+	bool const isBC1{ format == vk::Format::eBc1RgbUnormBlock or format == vk::Format::eBc1RgbaUnormBlock };
+	FormatBlock const block{ isBC1 ? FormatBlock{ 4, 4, 8 } : FormatBlock{ 4, 4, 16 } };
+
+	std::vector<unsigned char> blockVec(GetMipChainSize(block, width, height, mipLevels));
+	std::array<unsigned char, 64> texelArr{};
+
+	unsigned char const* levelPtr{ levelSpan.data() };
+	unsigned char* blockPtr{ blockVec.data() };
+	for (uint32_t mipLevel{}; mipLevel < mipLevels; ++mipLevel)
+	{
+		uint32_t const levelWidth{ std::max(width >> mipLevel, 1u) };
+		uint32_t const levelHeight{ std::max(height >> mipLevel, 1u) };
+
+		for (uint32_t blockY{}; blockY < (levelHeight + BlockDim - 1) / BlockDim; ++blockY)
+		{
+			for (uint32_t blockX{}; blockX < (levelWidth + BlockDim - 1) / BlockDim; ++blockX)
+			{
+				GatherBlock(levelPtr, levelWidth, levelHeight, blockX, blockY, texelArr);
+				if (isBC1)
+				{
+					CompressBlockBC1(texelArr, std::span<unsigned char, 8>{ blockPtr, 8 });
+				}
+				else
+				{
+					CompressBlockBC7(texelArr, std::span<unsigned char, 16>{ blockPtr, 16 });
+				}
+				blockPtr += block.Size;
+			}
+		}
+		levelPtr += static_cast<std::size_t>(levelWidth) * levelHeight * 4;
+	}
+	return blockVec;
+}
+
+void vkUtil::CompressBlockBC1(std::span<unsigned char const, 64> texelSpan, std::span<unsigned char, 8> blockSpan)
+{
+	std::array<std::array<float, 3>, 2> const endpoints{ GetEndpoints<3>(texelSpan) };
+	uint32_t color0{ ToRgb565(endpoints[1]) };
+	uint32_t color1{ ToRgb565(endpoints[0]) };
+
+	std::array<uint32_t, BlockTexels> indexArr{};
+	if (color0 != color1)
+	{
+		//the first color being the larger one selects the opaque four color palette
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		std::array<int, 4> const decoded0{ FromRgb565(color0) };
+		std::array<int, 4> const decoded1{ FromRgb565(color1) };
+		std::array<std::array<int, 4>, 4> palette{ decoded0, decoded1 };
+		for (std::size_t channel{}; channel < 3; ++channel)
+		{
+			palette[2][channel] = (2 * decoded0[channel] + decoded1[channel]) / 3;
+			palette[3][channel] = (decoded0[channel] + 2 * decoded1[channel]) / 3;
+		}
+		FindIndices<3, 4>(texelSpan, palette, indexArr);
+	}
+
+	BlockWriter writer{ blockSpan };
+	writer.Write(color0, 16);
+	writer.Write(color1, 16);
+	for (uint32_t const index : indexArr)
+	{
+		writer.Write(index, 2);
+	}
+}
+
+void vkUtil::CompressBlockBC7(std::span<unsigned char const, 64> texelSpan, std::span<unsigned char, 16> blockSpan)
+{
+	//mode 6: one subset, 7 bit rgba endpoints with a shared lowest bit per endpoint and 4 bit indices
+	constexpr std::array<int, 16> weightArr{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	std::array<std::array<float, 4>, 2> const endpoints{ GetEndpoints<4>(texelSpan) };
+
+	std::array<std::array<uint32_t, 4>, 2> bestEndpoints{};
+	std::array<uint32_t, 2> bestPBits{};
+	std::array<uint32_t, BlockTexels> bestIndexArr{};
+	uint32_t bestError{ std::numeric_limits<uint32_t>::max() };
+
+	//the lowest bit is shared by all channels of an endpoint, every combination is tried
+	for (uint32_t pBits{}; pBits < 4; ++pBits)
+	{
+		std::array<uint32_t, 2> const pBitArr{ pBits & 1u, pBits >> 1 };
+
+		std::array<std::array<uint32_t, 4>, 2> quantized{};
+		std::array<std::array<int, 4>, 2> decoded{};
+		for (std::size_t endpointIdx{}; endpointIdx < 2; ++endpointIdx)
+		{
+			for (std::size_t channel{}; channel < 4; ++channel)
+			{
+				float const value{ (endpoints[endpointIdx][channel] - static_cast<float>(pBitArr[endpointIdx])) / 2.f };
+				quantized[endpointIdx][channel] = static_cast<uint32_t>(std::clamp(std::lround(value), 0l, 127l));
+				decoded[endpointIdx][channel] = static_cast<int>((quantized[endpointIdx][channel] << 1) | pBitArr[endpointIdx]);
+			}
+		}
+
+		std::array<std::array<int, 4>, 16> palette{};
+		for (std::size_t paletteIdx{}; paletteIdx < palette.size(); ++paletteIdx)
+		{
+			for (std::size_t channel{}; channel < 4; ++channel)
+			{
+				palette[paletteIdx][channel] = ((64 - weightArr[paletteIdx]) * decoded[0][channel] + weightArr[paletteIdx] * decoded[1][channel] + 32) >> 6;
+			}
+		}
+
+		std::array<uint32_t, BlockTexels> indexArr{};
+		uint32_t const error{ FindIndices<4, 16>(texelSpan, palette, indexArr) };
+		if (error < bestError)
+		{
+			bestError = error;
+			bestEndpoints = quantized;
+			bestPBits = pBitArr;
+			bestIndexArr = indexArr;
+		}
+	}
+
+	//the highest index bit of the first texel is implied zero, swapping the endpoints mirrors the indices
+	if (bestIndexArr[0] >= 8)
+	{
+		std::swap(bestEndpoints[0], bestEndpoints[1]);
+		std::swap(bestPBits[0], bestPBits[1]);
+		for (uint32_t& index : bestIndexArr)
+		{
+			index = 15 - index;
+		}
+	}
+
+	BlockWriter writer{ blockSpan };
+	writer.Write(1u << 6, 7);
+	for (std::size_t channel{}; channel < 4; ++channel)
+	{
+		writer.Write(bestEndpoints[0][channel], 7);
+		writer.Write(bestEndpoints[1][channel], 7);
+	}
+	writer.Write(bestPBits[0], 1);
+	writer.Write(bestPBits[1], 1);
+	writer.Write(bestIndexArr[0], 3);
+	for (uint32_t texelIdx{ 1 }; texelIdx < BlockTexels; ++texelIdx)
+	{
+		writer.Write(bestIndexArr[texelIdx], 4);
+	}
+}
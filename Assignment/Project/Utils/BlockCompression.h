@@ -0,0 +1,39 @@
+#ifndef VK_BLOCK_COMPRESSION_H
+#define VK_BLOCK_COMPRESSION_H
+#include "Engine/Configuration.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	//texels of a format are stored in blocks, an uncompressed format is a block of one texel
+	struct FormatBlock
+	{
+		uint32_t Width{ 1 };
+		uint32_t Height{ 1 };
+		//bytes of one block
+		uint32_t Size{ 4 };
+	};
+
+	//empty for formats a texture can not be loaded as
+	std::optional<FormatBlock> GetFormatBlock(vk::Format format);
+
+	//a level that is not a multiple of the block size still takes whole blocks
+	std::uint64_t GetLevelSize(FormatBlock const& block, uint32_t width, uint32_t height);
+	std::uint64_t GetMipChainSize(FormatBlock const& block, uint32_t width, uint32_t height, uint32_t mipLevels);
+
+	//true when a texel of the rgba8 pixels is not fully opaque, bc1 stores no alpha
+	bool HasTransparency(std::span<unsigned char const> pixelSpan);
+
+	//compresses every level of an rgba8 mip chain into bc1 or bc7, the blocks of a level are packed row by row
+	//edges that are not a multiple of 4 repeat their last texel, a level smaller than a block is one block
+	//bc1 is opaque 4 bits per texel, bc7 keeps the alpha at 8 bits per texel and only uses mode 6
+	std::vector<unsigned char> CompressMipChain(std::span<unsigned char const> levelSpan, uint32_t width, uint32_t height, uint32_t mipLevels, vk::Format format);
+
+	//one 4x4 block of rgba8 texels, row by row
+	void CompressBlockBC1(std::span<unsigned char const, 64> texelSpan, std::span<unsigned char, 8> blockSpan);
+	void CompressBlockBC7(std::span<unsigned char const, 64> texelSpan, std::span<unsigned char, 16> blockSpan);
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef VK_BOUNDS_H
+#define VK_BOUNDS_H
+#include "Engine/Configuration.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	//local space bounds of a mesh, the sphere is centered on the box
+	struct MeshBounds
+	{
+		glm::vec3 Min{};
+		glm::vec3 Max{};
+		glm::vec3 Center{};
+		float Radius{};
+	};
+
+	template<typename VertexStruct>
+	MeshBounds ComputeBounds(std::span<VertexStruct const> vertexSpan)
+	{
+		MeshBounds bounds{};
+		if (vertexSpan.empty())
+		{
+			return bounds;
+		}
+
+		bounds.Min = vertexSpan[0].Position;
+		bounds.Max = vertexSpan[0].Position;
+		for (const auto& vertex : vertexSpan)
+		{
+			bounds.Min = glm::min(bounds.Min, vertex.Position);
+			bounds.Max = glm::max(bounds.Max, vertex.Position);
+		}
+
+		bounds.Center = (bounds.Min + bounds.Max) * 0.5f;
+
+		float radiusSquared{};
+		for (const auto& vertex : vertexSpan)
+		{
+			glm::vec3 const toVertex{ vertex.Position - bounds.Center };
+			radiusSquared = std::max(radiusSquared, glm::dot(toVertex, toVertex));
+		}
+		bounds.Radius = std::sqrt(radiusSquared);
+
+		return bounds;
+	}
+
+}
+
+#endif
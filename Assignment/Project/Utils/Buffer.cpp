@@ -1,5 +1,5 @@
 #include "Buffer.h"
-#include "Rendering/Commands.h"
+#include "Rendering/UploadContext.h"
 
 uint32_t vkUtil::FindMemoryTypeIndex(const vk::PhysicalDevice& physicalDevice, uint32_t supportedMemoryIndices, vk::MemoryPropertyFlags requestedProperties)
 {
@@ -22,19 +22,7 @@ uint32_t vkUtil::FindMemoryTypeIndex(const vk::PhysicalDevice& physicalDevice, u
 
 void vkUtil::AllocateBufferMemory(DataBuffer& buffer, const BufferInBundle& in)
 {
-	vk::MemoryRequirements memoryRequirements{ in.Device.getBufferMemoryRequirements(buffer.Buffer) };
-
-	vk::MemoryAllocateInfo allocateInfo{};
-	allocateInfo.allocationSize = memoryRequirements.size;
-	allocateInfo.memoryTypeIndex = FindMemoryTypeIndex
-	(
-		in.PhysicalDevice,
-		memoryRequirements.memoryTypeBits,
-		in.MemoryPropertyFlags
-	);
-
-	buffer.BufferMemory = in.Device.allocateMemory(allocateInfo);
-	in.Device.bindBufferMemory(buffer.Buffer, buffer.BufferMemory, 0);
+	buffer.Allocation = MemoryAllocator::GetInstance().AllocateForBuffer(buffer.Buffer, in.MemoryPropertyFlags);
 }
 
 vkUtil::DataBuffer vkUtil::CreateBuffer(const BufferInBundle& in)
@@ -53,16 +41,23 @@ vkUtil::DataBuffer vkUtil::CreateBuffer(const BufferInBundle& in)
 	return buffer;
 }
 
-void vkUtil::CopyBuffer(DataBuffer& srcBuffer, DataBuffer& dstBuffer, const vk::DeviceSize& size, const vk::Queue& queue, const vk::CommandBuffer& commandBuffer)
+void vkUtil::DestroyBuffer(const vk::Device& device, DataBuffer& buffer)
 {
-	vkInit::BeginSingleCommand(commandBuffer);
+	device.destroyBuffer(buffer.Buffer);
+	MemoryAllocator::GetInstance().Free(buffer.Allocation);
 
-	vk::BufferCopy copyRegion{};
-	copyRegion.srcOffset = 0;
-	copyRegion.dstOffset = 0;
-	copyRegion.size = size;
+	buffer = DataBuffer{};
+}
+
+vkUtil::DataBuffer vkUtil::CreateDeviceLocalBuffer(const BufferInBundle& in, const void* dataPtr, UploadContext& uploadContext)
+{
+	BufferInBundle deviceIn{ in };
+	deviceIn.UsageFlags |= vk::BufferUsageFlagBits::eTransferDst;
+	deviceIn.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
 
-	commandBuffer.copyBuffer(srcBuffer.Buffer, dstBuffer.Buffer, 1, &copyRegion);
+	DataBuffer buffer{ CreateBuffer(deviceIn) };
 
-	vkInit::EndSingleCommand(commandBuffer, queue);
+	uploadContext.UploadBuffer(buffer.Buffer, 0, dataPtr, deviceIn.Size);
+
+	return buffer;
 }
@@ -1,9 +1,12 @@
 #ifndef VK_BUFFER_H
 #define VK_BUFFER_H
 #include "Engine/Configuration.h"
+#include "Utils/MemoryAllocator.h"
 
 namespace vkUtil
 {
+	class UploadContext;
+
 	struct BufferInBundle
 	{
 		size_t Size{ static_cast<size_t>(-1) };
@@ -16,7 +19,8 @@ namespace vkUtil
 	struct DataBuffer
 	{
 		vk::Buffer Buffer;
-		vk::DeviceMemory BufferMemory;
+		//range of a pooled memory block, MappedPtr is set for host visible buffers
+		MemoryAllocation Allocation;
 	};
 
 	uint32_t FindMemoryTypeIndex(const vk::PhysicalDevice& physicalDevice, uint32_t supportedMemoryIndices, vk::MemoryPropertyFlags requestedProperties);
@@ -25,7 +29,10 @@ namespace vkUtil
 
 	DataBuffer CreateBuffer(const BufferInBundle& in);
 
-	void CopyBuffer(DataBuffer& srcBuffer, DataBuffer& dstBuffer, const vk::DeviceSize& size, const vk::Queue& queue, const vk::CommandBuffer& commandBuffer);
+	void DestroyBuffer(const vk::Device& device, DataBuffer& buffer);
+
+	//creates a device local buffer of in.Size bytes and records its upload into the context, the transfer destination usage is added
+	DataBuffer CreateDeviceLocalBuffer(const BufferInBundle& in, const void* dataPtr, UploadContext& uploadContext);
 
 }
 
@@ -118,3 +118,31 @@ const glm::vec3& ave::Camera::GetCameraPosition() const
 {
 	return m_Origin;
 }
+
+float ave::Camera::GetProjectionScale(float viewportHeight) const
+{
+	return viewportHeight / (2.f * m_Fov);
+}
+
+std::array<glm::vec4, 6> ave::Camera::GetFrustumPlanes() const
+{
+	//rows of the view projection matrix, glm stores columns
+	glm::mat4 const viewProjection{ glm::transpose(m_ProjectionMatrix * m_ViewMatrix) };
+
+	std::array<glm::vec4, 6> planeArr
+	{
+		viewProjection[3] + viewProjection[0],
+		viewProjection[3] - viewProjection[0],
+		viewProjection[3] + viewProjection[1],
+		viewProjection[3] - viewProjection[1],
+		viewProjection[3] + viewProjection[2],
+		viewProjection[3] - viewProjection[2]
+	};
+
+	for (auto& plane : planeArr)
+	{
+		plane /= glm::length(glm::vec3{ plane });
+	}
+
+	return planeArr;
+}
@@ -16,6 +16,10 @@ namespace ave
 		const glm::mat4& GetViewMatrix() const;
 		const glm::mat4& GetProjectionMatrix() const;
 		const glm::vec3& GetCameraPosition() const;
+		//pixels an object of size one covers at a distance of one, divide by the distance for the size on screen
+		float GetProjectionScale(float viewportHeight) const;
+		//normalized planes (xyz normal pointing inwards, w distance) in the order left, right, bottom, top, near, far
+		std::array<glm::vec4, 6> GetFrustumPlanes() const;
 	private:
 		glm::vec3 m_Origin{};
 		float m_FovAngle{ 45.f };
@@ -0,0 +1,209 @@
+#include "CookedAsset.h"
+#include <filesystem>
+
+namespace
+{
+	//"AVEC" read as a little endian uint32
+	constexpr uint32_t CookedMagic{ 0x43455641 };
+	constexpr std::uint64_t CookedChunkAlignment{ 16 };
+
+	std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+std::string vkUtil::GetCookedFileName(std::string const& sourceFileName, uint32_t flags)
+{
+	return sourceFileName + ((flags & CookedFlags::CompressedVertices) ? ".cv3d.ave" : ".ave");
+}
+
+uint32_t vkUtil::GetMipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t mipLevels{ 1 };
+	for (uint32_t size{ std::max(width, height) }; size > 1; size /= 2)
+	{
+		++mipLevels;
+	}
+	return mipLevels;
+}
+
+std::uint64_t vkUtil::GetMipChainSize(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t texelSize)
+{
+	std::uint64_t size{};
+	for (uint32_t level{}; level < mipLevels; ++level)
+	{
+		size += static_cast<std::uint64_t>(std::max(width >> level, 1u)) * std::max(height >> level, 1u) * texelSize;
+	}
+	return size;
+}
+
+std::vector<unsigned char> vkUtil::GenerateMipChain(unsigned char const* pixelPtr, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+	std::vector<unsigned char> levelVec(static_cast<std::size_t>(GetMipChainSize(width, height, mipLevels, 4)));
+	std::copy_n(pixelPtr, static_cast<std::size_t>(width) * height * 4, levelVec.begin());
+
+	std::size_t srcOffset{};
+	std::size_t dstOffset{ static_cast<std::size_t>(width) * height * 4 };
+	for (uint32_t mipLevel{ 1 }; mipLevel < mipLevels; ++mipLevel)
+	{
+		uint32_t const srcWidth{ std::max(width >> (mipLevel - 1), 1u) };
+		uint32_t const srcHeight{ std::max(height >> (mipLevel - 1), 1u) };
+		uint32_t const dstWidth{ std::max(width >> mipLevel, 1u) };
+		uint32_t const dstHeight{ std::max(height >> mipLevel, 1u) };
+
+		for (uint32_t y{}; y < dstHeight; ++y)
+		{
+			uint32_t const y0{ std::min(y * 2, srcHeight - 1) };
+			uint32_t const y1{ std::min(y * 2 + 1, srcHeight - 1) };
+			for (uint32_t x{}; x < dstWidth; ++x)
+			{
+				uint32_t const x0{ std::min(x * 2, srcWidth - 1) };
+				uint32_t const x1{ std::min(x * 2 + 1, srcWidth - 1) };
+				for (uint32_t channel{}; channel < 4; ++channel)
+				{
+					uint32_t const sum
+					{
+						static_cast<uint32_t>(levelVec[srcOffset + (static_cast<std::size_t>(y0) * srcWidth + x0) * 4 + channel]) +
+						levelVec[srcOffset + (static_cast<std::size_t>(y0) * srcWidth + x1) * 4 + channel] +
+						levelVec[srcOffset + (static_cast<std::size_t>(y1) * srcWidth + x0) * 4 + channel] +
+						levelVec[srcOffset + (static_cast<std::size_t>(y1) * srcWidth + x1) * 4 + channel]
+					};
+					levelVec[dstOffset + (static_cast<std::size_t>(y) * dstWidth + x) * 4 + channel] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+
+		srcOffset = dstOffset;
+		dstOffset += static_cast<std::size_t>(dstWidth) * dstHeight * 4;
+	}
+	return levelVec;
+}
+
+bool vkUtil::WriteCookedAsset(std::string const& cookedFileName, std::string const& sourceFileName, uint32_t flags, std::vector<CookedChunkData> const& chunkVec)
+{
+	std::error_code errorCode{};
+	std::uint64_t const sourceSize{ std::filesystem::file_size(sourceFileName, errorCode) };
+	if (errorCode)
+	{
+		return false;
+	}
+
+	CookedHeader header{};
+	header.Magic = CookedMagic;
+	header.Version = CookedAssetVersion;
+	header.Flags = flags;
+	header.ChunkCount = static_cast<uint32_t>(chunkVec.size());
+	header.SourceSize = sourceSize;
+
+	std::vector<CookedChunk> chunkTableVec{};
+	std::uint64_t offset{ AlignUp(sizeof(CookedHeader) + sizeof(CookedChunk) * chunkVec.size(), CookedChunkAlignment) };
+	for (const auto& chunk : chunkVec)
+	{
+		chunkTableVec.emplace_back(CookedChunk{ chunk.Type, chunk.ElementSize, offset, chunk.Data.size() });
+		offset = AlignUp(offset + chunk.Data.size(), CookedChunkAlignment);
+	}
+
+	//written next to the old file and swapped in, a crash never leaves half a file that looks current
+	std::string const tempFileName{ cookedFileName + ".tmp" };
+	{
+		std::ofstream file{ tempFileName, std::ios::binary | std::ios::trunc };
+		if (not file)
+		{
+			return false;
+		}
+
+		file.write(reinterpret_cast<char const*>(&header), sizeof(CookedHeader));
+		file.write(reinterpret_cast<char const*>(chunkTableVec.data()), static_cast<std::streamsize>(sizeof(CookedChunk) * chunkTableVec.size()));
+
+		char const padding[CookedChunkAlignment]{};
+		for (std::size_t chunkIdx{}; chunkIdx < chunkVec.size(); ++chunkIdx)
+		{
+			file.write(padding, static_cast<std::streamsize>(chunkTableVec[chunkIdx].Offset - static_cast<std::uint64_t>(file.tellp())));
+			file.write(reinterpret_cast<char const*>(chunkVec[chunkIdx].Data.data()), static_cast<std::streamsize>(chunkVec[chunkIdx].Data.size()));
+		}
+
+		if (not file)
+		{
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tempFileName, cookedFileName, errorCode);
+	return not errorCode;
+}
+
+vkUtil::CookedAsset::CookedAsset(std::string const& cookedFileName, std::string const& sourceFileName, uint32_t flags)
+	: m_File{ cookedFileName }
+{
+	m_IsValid = Validate(cookedFileName, sourceFileName, flags);
+}
+
+bool vkUtil::CookedAsset::IsValid() const
+{
+	return m_IsValid;
+}
+
+bool vkUtil::CookedAsset::Validate(std::string const& cookedFileName, std::string const& sourceFileName, uint32_t flags)
+{
+	std::span<std::byte const> const data{ m_File.GetData() };
+	if (data.size() < sizeof(CookedHeader))
+	{
+		return false;
+	}
+
+	CookedHeader const& header{ *reinterpret_cast<CookedHeader const*>(data.data()) };
+	if (header.Magic != CookedMagic or header.Version != CookedAssetVersion or header.Flags != flags)
+	{
+		return false;
+	}
+
+	std::uint64_t const chunkTableEnd{ sizeof(CookedHeader) + static_cast<std::uint64_t>(header.ChunkCount) * sizeof(CookedChunk) };
+	if (chunkTableEnd > data.size())
+	{
+		return false;
+	}
+
+	m_ChunkSpan = std::span<CookedChunk const>{ reinterpret_cast<CookedChunk const*>(data.data() + sizeof(CookedHeader)), header.ChunkCount };
+	for (const auto& chunk : m_ChunkSpan)
+	{
+		if (chunk.Offset % CookedChunkAlignment != 0 or chunk.Offset > data.size() or chunk.Size > data.size() - chunk.Offset)
+		{
+			return false;
+		}
+	}
+
+	//the source is only compared when it is there
+	std::error_code errorCode{};
+	if (not std::filesystem::exists(sourceFileName, errorCode))
+	{
+		return true;
+	}
+
+	std::uint64_t const sourceSize{ std::filesystem::file_size(sourceFileName, errorCode) };
+	if (errorCode or sourceSize != header.SourceSize)
+	{
+		return false;
+	}
+
+	auto const sourceWriteTime{ std::filesystem::last_write_time(sourceFileName, errorCode) };
+	auto const cookedWriteTime{ std::filesystem::last_write_time(cookedFileName, errorCode) };
+	return not errorCode and sourceWriteTime <= cookedWriteTime;
+}
+
+std::span<std::byte const> vkUtil::CookedAsset::FindChunk(CookedChunkType type, std::size_t elementSize) const
+{
+	if (not m_IsValid)
+	{
+		return {};
+	}
+
+	for (const auto& chunk : m_ChunkSpan)
+	{
+		if (chunk.Type == type and chunk.ElementSize == elementSize and chunk.Size % elementSize == 0)
+		{
+			return m_File.GetData().subspan(static_cast<std::size_t>(chunk.Offset), static_cast<std::size_t>(chunk.Size));
+		}
+	}
+	return {};
+}
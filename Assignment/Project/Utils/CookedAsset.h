@@ -0,0 +1,218 @@
+#ifndef VK_COOKED_ASSET_H
+#define VK_COOKED_ASSET_H
+#include "Engine/Configuration.h"
+#include "Utils/MappedFile.h"
+#include "Utils/FileReader.h"
+#include "Utils/Bounds.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/MeshSimplifier.h"
+#include "Utils/VertexCompression.h"
+
+namespace vkUtil
+{
+
+	//bumped whenever the layout of the file or of a chunk changes, older files are cooked again
+	//2: meshes are welded and optimized for the vertex cache, overdraw and vertex fetch
+	//3: meshes carry their lod chain, the indices of every lod follow those of the full mesh
+	constexpr uint32_t CookedAssetVersion{ 3 };
+
+	enum class CookedChunkType : uint32_t
+	{
+		Vertices,
+		Indices,
+		Bounds,
+		TextureHeader,
+		//every mip level packed after the previous one, rgba8
+		TextureLevels,
+		//ranges of the index chunk, the first one is the full mesh
+		Lods,
+		//only in files cooked with compressed vertices
+		Quantization
+	};
+
+	//how the source was converted, a file cooked with other flags than requested counts as stale
+	enum CookedFlags : uint32_t
+	{
+		None = 0b0000,
+		FlipAxisAndWinding = 0b0001,
+		//the vertices are CompressedVertex3D
+		CompressedVertices = 0b0010
+	};
+
+	//the file starts with the header followed by ChunkCount chunk entries, chunk data is aligned to 16 bytes
+	struct CookedHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t Flags;
+		uint32_t ChunkCount;
+		//size of the file the asset was cooked from
+		std::uint64_t SourceSize;
+		std::uint64_t Padding;
+	};
+
+	struct CookedChunk
+	{
+		CookedChunkType Type;
+		//size of one element, a chunk read as another type is rejected
+		uint32_t ElementSize;
+		std::uint64_t Offset;
+		std::uint64_t Size;
+	};
+
+	struct CookedTextureHeader
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t MipLevels;
+		uint32_t Padding;
+	};
+
+	struct CookedChunkData
+	{
+		CookedChunkType Type;
+		uint32_t ElementSize;
+		std::span<std::byte const> Data;
+	};
+
+	//the cooked file lives next to its source, "Resources/ferrari.obj" becomes "Resources/ferrari.obj.ave"
+	//meshes cooked with compressed vertices get their own file, "Resources/ferrari.obj.cv3d.ave", so both vertex formats can be cooked side by side
+	std::string GetCookedFileName(std::string const& sourceFileName, uint32_t flags = CookedFlags::None);
+
+	//amount of levels down to 1x1 and the bytes of all of them together
+	uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+	std::uint64_t GetMipChainSize(uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t texelSize);
+
+	//rgba8 levels packed one after the other, every level is a 2x2 box filter of the previous one and an odd edge repeats its last texel
+	std::vector<unsigned char> GenerateMipChain(unsigned char const* pixelPtr, uint32_t width, uint32_t height, uint32_t mipLevels);
+
+	bool WriteCookedAsset(std::string const& cookedFileName, std::string const& sourceFileName, uint32_t flags, std::vector<CookedChunkData> const& chunkVec);
+
+	//maps a cooked file, the chunks point straight into the mapping so nothing is parsed or copied
+	class CookedAsset final
+	{
+	public:
+		//only valid when the file is intact, has the current version and flags and the source did not change after cooking
+		//a missing source is fine, the cooked file can be shipped on its own
+		CookedAsset(std::string const& cookedFileName, std::string const& sourceFileName, uint32_t flags);
+		~CookedAsset() = default;
+
+		CookedAsset(CookedAsset const& other) = delete;
+		CookedAsset(CookedAsset&& other) = delete;
+		CookedAsset& operator=(CookedAsset const& other) = delete;
+		CookedAsset& operator=(CookedAsset&& other) = delete;
+
+		bool IsValid() const;
+
+		//empty when the chunk is missing or holds another element type
+		template<typename T>
+		std::span<T const> GetChunk(CookedChunkType type) const
+		{
+			std::span<std::byte const> const data{ FindChunk(type, sizeof(T)) };
+			return std::span<T const>{ reinterpret_cast<T const*>(data.data()), data.size() / sizeof(T) };
+		}
+	private:
+		MappedFile m_File;
+		std::span<CookedChunk const> m_ChunkSpan;
+		bool m_IsValid{ false };
+
+		bool Validate(std::string const& cookedFileName, std::string const& sourceFileName, uint32_t flags);
+		std::span<std::byte const> FindChunk(CookedChunkType type, std::size_t elementSize) const;
+	};
+
+	//parses the obj, optimizes it and appends its lods, shared by LoadMesh and the asset cooker
+	template<typename VertexStruct>
+	bool ParseMesh(std::string const& fileName, std::vector<VertexStruct>& vertexVec, std::vector<uint32_t>& indexVec, std::vector<MeshLod>& lodVec, MeshBounds& bounds, bool flipAxisAndWinding)
+	{
+		if (not ParseOBJ<VertexStruct>(fileName, vertexVec, indexVec, flipAxisAndWinding))
+		{
+			return false;
+		}
+		PrintMeshOptimizationReport(fileName, OptimizeMesh<VertexStruct>(vertexVec, indexVec));
+
+		bounds = ComputeBounds<VertexStruct>(vertexVec);
+		lodVec = BuildLods<VertexStruct>(indexVec, vertexVec, bounds.Radius);
+		PrintLodReport(fileName, lodVec);
+		return true;
+	}
+
+	//the vertices and indices either point into a cooked file or into the vectors filled by parsing the obj
+	//CompressedVertex3D meshes are parsed as Vertex3D and compressed afterwards, the quantization of every other mesh is the identity
+	template<typename VertexStruct>
+	struct MeshData
+	{
+		std::unique_ptr<CookedAsset> CookedAssetUPtr{ nullptr };
+		std::vector<VertexStruct> VertexVec;
+		std::vector<uint32_t> IndexVec;
+		std::vector<MeshLod> LodVec;
+
+		std::span<VertexStruct const> Vertices;
+		std::span<uint32_t const> Indices;
+		std::span<MeshLod const> Lods;
+		MeshBounds Bounds{};
+		VertexQuantization Quantization{};
+	};
+
+	//maps the cooked version of the obj, falls back to parsing and optimizing the obj when it is missing or stale
+	template<typename VertexStruct>
+	bool LoadMesh(std::string const& fileName, MeshData<VertexStruct>& meshData, bool flipAxisAndWinding)
+	{
+		constexpr bool compressVertices{ std::is_same_v<VertexStruct, CompressedVertex3D> };
+
+		uint32_t flags{ flipAxisAndWinding ? CookedFlags::FlipAxisAndWinding : CookedFlags::None };
+		if constexpr (compressVertices)
+		{
+			flags |= CookedFlags::CompressedVertices;
+		}
+		meshData.CookedAssetUPtr = std::make_unique<CookedAsset>(GetCookedFileName(fileName, flags), fileName, flags);
+
+		CookedAsset const& cookedAsset{ *meshData.CookedAssetUPtr };
+		if (cookedAsset.IsValid())
+		{
+			std::span<MeshBounds const> const boundsSpan{ cookedAsset.GetChunk<MeshBounds>(CookedChunkType::Bounds) };
+			std::span<VertexQuantization const> const quantizationSpan{ cookedAsset.GetChunk<VertexQuantization>(CookedChunkType::Quantization) };
+			meshData.Vertices = cookedAsset.GetChunk<VertexStruct>(CookedChunkType::Vertices);
+			meshData.Indices = cookedAsset.GetChunk<uint32_t>(CookedChunkType::Indices);
+			meshData.Lods = cookedAsset.GetChunk<MeshLod>(CookedChunkType::Lods);
+
+			if (boundsSpan.size() == 1 and not meshData.Vertices.empty() and not meshData.Lods.empty() and (not compressVertices or quantizationSpan.size() == 1))
+			{
+				meshData.Bounds = boundsSpan[0];
+				if constexpr (compressVertices)
+				{
+					meshData.Quantization = quantizationSpan[0];
+				}
+				return true;
+			}
+		}
+		meshData.CookedAssetUPtr.reset();
+
+		std::cout << "No current cooked file for " << fileName << ", parsing it\n";
+		if constexpr (compressVertices)
+		{
+			std::vector<Vertex3D> vertexVec{};
+			if (not ParseMesh<Vertex3D>(fileName, vertexVec, meshData.IndexVec, meshData.LodVec, meshData.Bounds, flipAxisAndWinding))
+			{
+				return false;
+			}
+			meshData.Quantization = ComputeQuantization(meshData.Bounds);
+			meshData.VertexVec = CompressVertices(vertexVec, meshData.Quantization);
+			PrintCompressionReport(fileName, vertexVec, meshData.VertexVec, meshData.Quantization);
+		}
+		else
+		{
+			if (not ParseMesh<VertexStruct>(fileName, meshData.VertexVec, meshData.IndexVec, meshData.LodVec, meshData.Bounds, flipAxisAndWinding))
+			{
+				return false;
+			}
+		}
+
+		meshData.Vertices = meshData.VertexVec;
+		meshData.Indices = meshData.IndexVec;
+		meshData.Lods = meshData.LodVec;
+		return true;
+	}
+
+}
+
+#endif
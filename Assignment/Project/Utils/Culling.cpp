@@ -0,0 +1,224 @@
+#include "Culling.h"
+#include "Engine/ThreadPool.h"
+#include <bit>
+#include <cstring>
+
+//AVE_CULL_SCALAR forces the plain c++ path, otherwise the widest instruction set the compiler targets is used
+#if defined(AVE_CULL_SCALAR)
+#elif defined(__AVX2__)
+#define AVE_CULL_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+#define AVE_CULL_SSE
+#include <xmmintrin.h>
+#endif
+
+std::int64_t vkUtil::InstanceCuller::Cull(std::array<glm::vec4, 6> const& frustumPlaneArr, MeshBounds const& bounds, std::span<glm::mat4 const> worldMatrixVec, uint32_t firstInstance, LodCullInBundle const& lodIn,
+	uint32_t* visibleIdxPtr, std::array<uint32_t, MaxLodCount>& lodVisibleCountArr)
+{
+	lodVisibleCountArr.fill(0);
+	std::int64_t const instanceCount{ std::ssize(worldMatrixVec) };
+	if (instanceCount == 0)
+	{
+		return 0;
+	}
+
+	Resize(instanceCount);
+
+	ave::ThreadPool::GetInstance().ParallelFor(instanceCount, m_ChunkSize,
+		[&](std::int64_t begin, std::int64_t end)
+		{
+			TransformSpheres(bounds, worldMatrixVec, begin, end);
+			m_ChunkVisibleCountVec[begin / m_ChunkSize] = TestSpheres(frustumPlaneArr, begin, end, firstInstance);
+			SelectLods(bounds, lodIn, begin, end, firstInstance);
+		});
+
+	std::int64_t visibleCount{};
+	for (std::int64_t chunkIdx{}; chunkIdx < std::ssize(m_ChunkVisibleCountVec); ++chunkIdx)
+	{
+		std::int64_t const chunkVisibleCount{ m_ChunkVisibleCountVec[chunkIdx] };
+		if (lodIn.LodDistanceSpan.size() <= 1)
+		{
+			memcpy(visibleIdxPtr + visibleCount, m_ChunkIdxVec.data() + chunkIdx * m_ChunkSize, static_cast<std::size_t>(chunkVisibleCount) * sizeof(uint32_t));
+		}
+		else
+		{
+			//the chunks are packed in order, so the indices of every lod keep the order of the instances
+			for (std::int64_t idx{ chunkIdx * m_ChunkSize }; idx < chunkIdx * m_ChunkSize + chunkVisibleCount; ++idx)
+			{
+				uint32_t const lod{ m_ChunkLodVec[idx] };
+				visibleIdxPtr[lod * lodIn.LodStride + lodVisibleCountArr[lod]++] = m_ChunkIdxVec[idx];
+			}
+		}
+		visibleCount += chunkVisibleCount;
+	}
+
+	if (lodIn.LodDistanceSpan.size() <= 1)
+	{
+		lodVisibleCountArr[0] = static_cast<uint32_t>(visibleCount);
+	}
+	return visibleCount;
+}
+
+char const* vkUtil::InstanceCuller::GetInstructionSetName()
+{
+#if defined(AVE_CULL_AVX2)
+	return "avx2";
+#elif defined(AVE_CULL_SSE)
+	return "sse";
+#else
+	return "scalar";
+#endif
+}
+
+void vkUtil::InstanceCuller::Resize(std::int64_t instanceCount)
+{
+	std::size_t const size{ static_cast<std::size_t>(instanceCount) };
+	m_CenterXVec.resize(size);
+	m_CenterYVec.resize(size);
+	m_CenterZVec.resize(size);
+	m_RadiusVec.resize(size);
+	m_ChunkIdxVec.resize(size);
+	m_ChunkLodVec.resize(size);
+	m_ChunkVisibleCountVec.assign(static_cast<std::size_t>((instanceCount + m_ChunkSize - 1) / m_ChunkSize), 0);
+}
+
+void vkUtil::InstanceCuller::TransformSpheres(MeshBounds const& bounds, std::span<glm::mat4 const> worldMatrixVec, std::int64_t begin, std::int64_t end)
+{
+	glm::vec4 const localCenter{ bounds.Center, 1.f };
+	for (std::int64_t idx{ begin }; idx < end; ++idx)
+	{
+		glm::mat4 const& worldMatrix{ worldMatrixVec[idx] };
+		glm::vec4 const center{ worldMatrix * localCenter };
+
+		//the sphere has to keep enclosing the mesh under non uniform scale
+		float const scaleSquared{ std::max({ glm::dot(glm::vec3{ worldMatrix[0] }, glm::vec3{ worldMatrix[0] }),
+			glm::dot(glm::vec3{ worldMatrix[1] }, glm::vec3{ worldMatrix[1] }),
+			glm::dot(glm::vec3{ worldMatrix[2] }, glm::vec3{ worldMatrix[2] }) }) };
+
+		m_CenterXVec[idx] = center.x;
+		m_CenterYVec[idx] = center.y;
+		m_CenterZVec[idx] = center.z;
+		m_RadiusVec[idx] = bounds.Radius * std::sqrt(scaleSquared);
+	}
+}
+
+std::int64_t vkUtil::InstanceCuller::TestSpheres(std::array<glm::vec4, 6> const& frustumPlaneArr, std::int64_t begin, std::int64_t end, uint32_t firstInstance)
+{
+	uint32_t* const chunkIdxPtr{ m_ChunkIdxVec.data() + begin };
+	std::int64_t visibleCount{};
+	std::int64_t idx{ begin };
+
+#if defined(AVE_CULL_AVX2)
+	__m256 planeXArr[6];
+	__m256 planeYArr[6];
+	__m256 planeZArr[6];
+	__m256 planeWArr[6];
+	for (int planeIdx{}; planeIdx < 6; ++planeIdx)
+	{
+		planeXArr[planeIdx] = _mm256_set1_ps(frustumPlaneArr[planeIdx].x);
+		planeYArr[planeIdx] = _mm256_set1_ps(frustumPlaneArr[planeIdx].y);
+		planeZArr[planeIdx] = _mm256_set1_ps(frustumPlaneArr[planeIdx].z);
+		planeWArr[planeIdx] = _mm256_set1_ps(frustumPlaneArr[planeIdx].w);
+	}
+
+	for (; idx + 8 <= end; idx += 8)
+	{
+		__m256 const centerX{ _mm256_loadu_ps(m_CenterXVec.data() + idx) };
+		__m256 const centerY{ _mm256_loadu_ps(m_CenterYVec.data() + idx) };
+		__m256 const centerZ{ _mm256_loadu_ps(m_CenterZVec.data() + idx) };
+		__m256 const negativeRadius{ _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(m_RadiusVec.data() + idx)) };
+
+		__m256 inside{ _mm256_castsi256_ps(_mm256_set1_epi32(-1)) };
+		for (int planeIdx{}; planeIdx < 6; ++planeIdx)
+		{
+			__m256 distance{ _mm256_add_ps(_mm256_mul_ps(planeXArr[planeIdx], centerX), planeWArr[planeIdx]) };
+			distance = _mm256_add_ps(_mm256_mul_ps(planeYArr[planeIdx], centerY), distance);
+			distance = _mm256_add_ps(_mm256_mul_ps(planeZArr[planeIdx], centerZ), distance);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+
+		for (unsigned int mask{ static_cast<unsigned int>(_mm256_movemask_ps(inside)) }; mask != 0; mask &= mask - 1)
+		{
+			chunkIdxPtr[visibleCount++] = firstInstance + static_cast<uint32_t>(idx + std::countr_zero(mask));
+		}
+	}
+#elif defined(AVE_CULL_SSE)
+	__m128 planeXArr[6];
+	__m128 planeYArr[6];
+	__m128 planeZArr[6];
+	__m128 planeWArr[6];
+	for (int planeIdx{}; planeIdx < 6; ++planeIdx)
+	{
+		planeXArr[planeIdx] = _mm_set1_ps(frustumPlaneArr[planeIdx].x);
+		planeYArr[planeIdx] = _mm_set1_ps(frustumPlaneArr[planeIdx].y);
+		planeZArr[planeIdx] = _mm_set1_ps(frustumPlaneArr[planeIdx].z);
+		planeWArr[planeIdx] = _mm_set1_ps(frustumPlaneArr[planeIdx].w);
+	}
+
+	for (; idx + 4 <= end; idx += 4)
+	{
+		__m128 const centerX{ _mm_loadu_ps(m_CenterXVec.data() + idx) };
+		__m128 const centerY{ _mm_loadu_ps(m_CenterYVec.data() + idx) };
+		__m128 const centerZ{ _mm_loadu_ps(m_CenterZVec.data() + idx) };
+		__m128 const negativeRadius{ _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(m_RadiusVec.data() + idx)) };
+
+		__m128 inside{ _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()) };
+		for (int planeIdx{}; planeIdx < 6; ++planeIdx)
+		{
+			__m128 distance{ _mm_add_ps(_mm_mul_ps(planeXArr[planeIdx], centerX), planeWArr[planeIdx]) };
+			distance = _mm_add_ps(_mm_mul_ps(planeYArr[planeIdx], centerY), distance);
+			distance = _mm_add_ps(_mm_mul_ps(planeZArr[planeIdx], centerZ), distance);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		for (unsigned int mask{ static_cast<unsigned int>(_mm_movemask_ps(inside)) }; mask != 0; mask &= mask - 1)
+		{
+			chunkIdxPtr[visibleCount++] = firstInstance + static_cast<uint32_t>(idx + std::countr_zero(mask));
+		}
+	}
+#endif
+
+	//scalar path and the tail the vector width does not divide
+	for (; idx < end; ++idx)
+	{
+		bool inside{ true };
+		for (int planeIdx{}; planeIdx < 6 and inside; ++planeIdx)
+		{
+			//same order of operations as the vector paths so an instance in the tail is culled the same way
+			glm::vec4 const& plane{ frustumPlaneArr[planeIdx] };
+			inside = plane.x * m_CenterXVec[idx] + plane.w + plane.y * m_CenterYVec[idx] + plane.z * m_CenterZVec[idx] >= -m_RadiusVec[idx];
+		}
+
+		if (inside)
+		{
+			chunkIdxPtr[visibleCount++] = firstInstance + static_cast<uint32_t>(idx);
+		}
+	}
+
+	return visibleCount;
+}
+
+void vkUtil::InstanceCuller::SelectLods(MeshBounds const& bounds, LodCullInBundle const& lodIn, std::int64_t begin, std::int64_t end, uint32_t firstInstance)
+{
+	if (lodIn.LodDistanceSpan.size() <= 1)
+	{
+		return;
+	}
+
+	//every instance keeps its lod up to date, a culled one comes back in with the right one
+	for (std::int64_t idx{ begin }; idx < end; ++idx)
+	{
+		glm::vec3 const toCamera{ m_CenterXVec[idx] - lodIn.CameraPosition.x, m_CenterYVec[idx] - lodIn.CameraPosition.y, m_CenterZVec[idx] - lodIn.CameraPosition.z };
+		float const scale{ bounds.Radius > 0.f ? m_RadiusVec[idx] / bounds.Radius : 1.f };
+		float const scaledDistance{ std::sqrt(glm::dot(toCamera, toCamera)) / std::max(scale, 1e-6f) };
+		lodIn.LodStatePtr[idx] = SelectLod(lodIn.LodDistanceSpan, scaledDistance, lodIn.LodStatePtr[idx], lodIn.Hysteresis);
+	}
+
+	//the compacted indices carry the instance offset, the state does not
+	std::int64_t const chunkVisibleCount{ m_ChunkVisibleCountVec[begin / m_ChunkSize] };
+	for (std::int64_t idx{ begin }; idx < begin + chunkVisibleCount; ++idx)
+	{
+		m_ChunkLodVec[idx] = static_cast<uint8_t>(lodIn.LodStatePtr[m_ChunkIdxVec[idx] - firstInstance]);
+	}
+}
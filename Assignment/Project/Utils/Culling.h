@@ -0,0 +1,65 @@
+#ifndef VK_CULLING_H
+#define VK_CULLING_H
+#include "Engine/Configuration.h"
+#include "Utils/Bounds.h"
+#include "Utils/MeshLod.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	enum class CullingMode
+	{
+		Gpu,
+		Cpu,
+		Disabled
+	};
+
+	struct LodCullInBundle
+	{
+		//distance from which each lod is used, scaled like the push constants of Cull.comp
+		std::span<float const> LodDistanceSpan;
+		float Hysteresis;
+		glm::vec3 CameraPosition;
+		//lod of every instance of the mesh from the last selection, overwritten with the new one
+		uint32_t* LodStatePtr;
+		//the visible indices of lod n are written n * LodStride entries after those of lod 0
+		std::int64_t LodStride;
+	};
+
+	//frustum culling of instances on the cpu, the bounding spheres are kept in structure of arrays layout so a plane is tested against several instances at once
+	//the instruction set is picked at compile time: avx2, sse or scalar
+	class InstanceCuller final
+	{
+	public:
+		//selects the lod of every instance and writes the indices of the visible ones, offset by firstInstance, to the region of their lod starting at visibleIdxPtr
+		//returns how many are visible and fills in how many of them each lod got
+		//the instances are split over the thread pool, the order of the indices stays the order of the instances
+		std::int64_t Cull(std::array<glm::vec4, 6> const& frustumPlaneArr, MeshBounds const& bounds, std::span<glm::mat4 const> worldMatrixVec, uint32_t firstInstance, LodCullInBundle const& lodIn,
+			uint32_t* visibleIdxPtr, std::array<uint32_t, MaxLodCount>& lodVisibleCountArr);
+
+		static char const* GetInstructionSetName();
+	private:
+		//instances per task of the thread pool
+		static constexpr std::int64_t m_ChunkSize{ 4096 };
+
+		std::vector<float> m_CenterXVec;
+		std::vector<float> m_CenterYVec;
+		std::vector<float> m_CenterZVec;
+		std::vector<float> m_RadiusVec;
+
+		//every chunk compacts its visible indices at its own start, they are packed together afterwards
+		std::vector<uint32_t> m_ChunkIdxVec;
+		std::vector<std::int64_t> m_ChunkVisibleCountVec;
+		//the lod of every compacted index
+		std::vector<uint8_t> m_ChunkLodVec;
+
+		void Resize(std::int64_t instanceCount);
+		void TransformSpheres(MeshBounds const& bounds, std::span<glm::mat4 const> worldMatrixVec, std::int64_t begin, std::int64_t end);
+		std::int64_t TestSpheres(std::array<glm::vec4, 6> const& frustumPlaneArr, std::int64_t begin, std::int64_t end, uint32_t firstInstance);
+		void SelectLods(MeshBounds const& bounds, LodCullInBundle const& lodIn, std::int64_t begin, std::int64_t end, uint32_t firstInstance);
+	};
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "DirtyRanges.h"
+#include <algorithm>
+
+void vkUtil::DirtyRangeTracker::SetFrameCount(int frameCount, std::int64_t instanceCount)
+{
+	m_FrameRangeVec.clear();
+	m_FrameRangeVec.resize(frameCount);
+
+	//fresh frame buffers have never seen any instance
+	MarkDirty(0, instanceCount);
+}
+
+void vkUtil::DirtyRangeTracker::MarkDirty(std::int64_t begin, std::int64_t end)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+
+	for (auto& rangeVec : m_FrameRangeVec)
+	{
+		if (not rangeVec.empty() and rangeVec.back().End >= begin and rangeVec.back().Begin <= end)
+		{
+			rangeVec.back().Begin = std::min(rangeVec.back().Begin, begin);
+			rangeVec.back().End = std::max(rangeVec.back().End, end);
+			continue;
+		}
+
+		rangeVec.emplace_back(InstanceRange{ begin, end });
+
+		if (rangeVec.size() > m_MaxPendingRanges)
+		{
+			CoarsenRanges(rangeVec, m_MaxPendingRanges / 2);
+		}
+	}
+}
+
+bool vkUtil::DirtyRangeTracker::IsDirty(int frameIdx) const
+{
+	return not m_FrameRangeVec[frameIdx].empty();
+}
+
+std::vector<vkUtil::InstanceRange> vkUtil::DirtyRangeTracker::ConsumeRanges(int frameIdx)
+{
+	std::vector<InstanceRange> rangeVec{};
+	rangeVec.swap(m_FrameRangeVec[frameIdx]);
+
+	MergeRanges(rangeVec);
+
+	return rangeVec;
+}
+
+void vkUtil::DirtyRangeTracker::MergeRanges(std::vector<InstanceRange>& rangeVec)
+{
+	if (rangeVec.size() < 2)
+	{
+		return;
+	}
+
+	std::sort(rangeVec.begin(), rangeVec.end(),
+		[](InstanceRange const& lhs, InstanceRange const& rhs)
+		{
+			return lhs.Begin < rhs.Begin;
+		});
+
+	std::size_t writeIdx{};
+	for (std::size_t readIdx{ 1 }; readIdx < rangeVec.size(); ++readIdx)
+	{
+		if (rangeVec[readIdx].Begin <= rangeVec[writeIdx].End)
+		{
+			rangeVec[writeIdx].End = std::max(rangeVec[writeIdx].End, rangeVec[readIdx].End);
+		}
+		else
+		{
+			rangeVec[++writeIdx] = rangeVec[readIdx];
+		}
+	}
+	rangeVec.resize(writeIdx + 1);
+}
+
+void vkUtil::DirtyRangeTracker::CoarsenRanges(std::vector<InstanceRange>& rangeVec, std::size_t maxRanges)
+{
+	MergeRanges(rangeVec);
+	if (rangeVec.size() <= maxRanges)
+	{
+		return;
+	}
+
+	//the gap in front of every range but the first, closing the smallest ones uploads the fewest clean instances
+	std::vector<std::int64_t> gapVec(rangeVec.size() - 1);
+	for (std::size_t gapIdx{}; gapIdx < gapVec.size(); ++gapIdx)
+	{
+		gapVec[gapIdx] = rangeVec[gapIdx + 1].Begin - rangeVec[gapIdx].End;
+	}
+
+	std::size_t const closeCount{ rangeVec.size() - maxRanges };
+	std::vector<std::int64_t> sortedGapVec{ gapVec };
+	std::nth_element(sortedGapVec.begin(), sortedGapVec.begin() + (closeCount - 1), sortedGapVec.end());
+	std::int64_t const maxClosedGap{ sortedGapVec[closeCount - 1] };
+
+	//gaps equal to the largest closed one are only closed until closeCount is reached
+	std::size_t equalGapsToClose{ closeCount - static_cast<std::size_t>(std::ranges::count_if(gapVec,
+		[maxClosedGap](std::int64_t gap)
+		{
+			return gap < maxClosedGap;
+		})) };
+
+	std::size_t writeIdx{};
+	for (std::size_t readIdx{ 1 }; readIdx < rangeVec.size(); ++readIdx)
+	{
+		std::int64_t const gap{ gapVec[readIdx - 1] };
+		bool const close{ gap < maxClosedGap or (gap == maxClosedGap and equalGapsToClose > 0) };
+		if (close)
+		{
+			if (gap == maxClosedGap)
+			{
+				--equalGapsToClose;
+			}
+			rangeVec[writeIdx].End = rangeVec[readIdx].End;
+		}
+		else
+		{
+			rangeVec[++writeIdx] = rangeVec[readIdx];
+		}
+	}
+	rangeVec.resize(writeIdx + 1);
+}
@@ -0,0 +1,40 @@
+#ifndef VK_DIRTY_RANGES_H
+#define VK_DIRTY_RANGES_H
+#include "Engine/Configuration.h"
+
+namespace vkUtil
+{
+
+	//half open range of instances [Begin, End)
+	struct InstanceRange
+	{
+		std::int64_t Begin{};
+		std::int64_t End{};
+	};
+
+	//every frame owns its own instance buffer, so a range is only cleaned for the frame that uploaded it
+	class DirtyRangeTracker final
+	{
+	public:
+		void SetFrameCount(int frameCount, std::int64_t instanceCount);
+
+		void MarkDirty(std::int64_t begin, std::int64_t end);
+
+		bool IsDirty(int frameIdx) const;
+
+		//returns the sorted and merged ranges of the frame and cleans them
+		std::vector<InstanceRange> ConsumeRanges(int frameIdx);
+	private:
+		//past this many pending ranges a frame is coarsened to half of it, a few clean instances are uploaded again to keep marking cheap
+		static constexpr std::size_t m_MaxPendingRanges{ 256 };
+
+		std::vector<std::vector<InstanceRange>> m_FrameRangeVec;
+
+		static void MergeRanges(std::vector<InstanceRange>& rangeVec);
+		//merges neighbours across the smallest gaps until at most maxRanges are left
+		static void CoarsenRanges(std::vector<InstanceRange>& rangeVec, std::size_t maxRanges);
+	};
+
+}
+
+#endif
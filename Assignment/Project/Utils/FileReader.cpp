@@ -0,0 +1,323 @@
+#include "FileReader.h"
+#include "Utils/MappedFile.h"
+#include <charconv>
+#include <atomic>
+#include <filesystem>
+
+namespace
+{
+	//bytes of the file per parse task, chunks are moved to the next line start
+	constexpr std::size_t ChunkSize{ 1 << 20 };
+
+	//a corner as written in the file, a relative (negative) index is already turned into an index into the pool of its own chunk
+	//it only becomes global once the sizes of the chunks in front of it are known
+	struct RawCorner
+	{
+		std::int64_t IdxArr[3];
+		uint8_t PresentMask;
+		uint8_t RelativeMask;
+	};
+
+	struct ChunkData
+	{
+		std::vector<glm::vec3> PositionVec;
+		std::vector<glm::vec2> UVVec;
+		std::vector<glm::vec3> NormalVec;
+		std::vector<RawCorner> CornerVec;
+		bool Failed{ false };
+	};
+
+	bool IsSpace(char character)
+	{
+		return character == ' ' or character == '\t' or character == '\r';
+	}
+
+	char const* SkipSpaces(char const* ptr, char const* endPtr)
+	{
+		while (ptr < endPtr and IsSpace(*ptr))
+		{
+			++ptr;
+		}
+		return ptr;
+	}
+
+	char const* ParseFloat(char const* ptr, char const* endPtr, float& value)
+	{
+		ptr = SkipSpaces(ptr, endPtr);
+		//from_chars does not accept a leading plus
+		if (ptr < endPtr and *ptr == '+')
+		{
+			++ptr;
+		}
+
+		auto const [resultPtr, errorCode] { std::from_chars(ptr, endPtr, value) };
+		if (errorCode != std::errc{})
+		{
+			value = 0.f;
+		}
+		return resultPtr;
+	}
+
+	//returns nullptr when the token is not a number
+	char const* ParseIndex(char const* ptr, char const* endPtr, std::int64_t& value)
+	{
+		auto const [resultPtr, errorCode] { std::from_chars(ptr, endPtr, value) };
+		return errorCode == std::errc{} ? resultPtr : nullptr;
+	}
+
+	//one v/vt/vn group of a face, positions are required, texture coordinates and normals are optional
+	char const* ParseCorner(char const* ptr, char const* endPtr, ChunkData const& chunkData, RawCorner& corner)
+	{
+		std::int64_t const poolSizeArr[3]{ std::ssize(chunkData.PositionVec), std::ssize(chunkData.UVVec), std::ssize(chunkData.NormalVec) };
+
+		corner = RawCorner{};
+		for (int attributeIdx{}; attributeIdx < 3; ++attributeIdx)
+		{
+			if (attributeIdx > 0)
+			{
+				if (ptr >= endPtr or *ptr != '/')
+				{
+					break;
+				}
+				++ptr;
+				//an empty group like the texture coordinate in "1//3" or a trailing slash
+				if (ptr >= endPtr or *ptr == '/' or IsSpace(*ptr))
+				{
+					continue;
+				}
+			}
+
+			std::int64_t idx{};
+			ptr = ParseIndex(ptr, endPtr, idx);
+			if (ptr == nullptr or idx == 0)
+			{
+				return nullptr;
+			}
+
+			corner.PresentMask |= 1 << attributeIdx;
+			if (idx > 0)
+			{
+				//obj format uses 1-based arrays
+				corner.IdxArr[attributeIdx] = idx - 1;
+			}
+			else
+			{
+				corner.IdxArr[attributeIdx] = poolSizeArr[attributeIdx] + idx;
+				corner.RelativeMask |= 1 << attributeIdx;
+			}
+		}
+		return ptr;
+	}
+
+	void ParseLine(char const* ptr, char const* endPtr, ChunkData& chunkData, std::vector<RawCorner>& polygonVec)
+	{
+		ptr = SkipSpaces(ptr, endPtr);
+		if (ptr >= endPtr)
+		{
+			return;
+		}
+
+		char const* keywordEndPtr{ ptr };
+		while (keywordEndPtr < endPtr and not IsSpace(*keywordEndPtr))
+		{
+			++keywordEndPtr;
+		}
+		std::string_view const keyword{ ptr, static_cast<std::size_t>(keywordEndPtr - ptr) };
+		ptr = keywordEndPtr;
+
+		if (keyword == "v")
+		{
+			glm::vec3 position{};
+			ptr = ParseFloat(ptr, endPtr, position.x);
+			ptr = ParseFloat(ptr, endPtr, position.y);
+			ParseFloat(ptr, endPtr, position.z);
+			chunkData.PositionVec.emplace_back(position);
+		}
+		else if (keyword == "vt")
+		{
+			float u{}, v{};
+			ptr = ParseFloat(ptr, endPtr, u);
+			ParseFloat(ptr, endPtr, v);
+			chunkData.UVVec.emplace_back(u, 1 - v);
+		}
+		else if (keyword == "vn")
+		{
+			glm::vec3 normal{};
+			ptr = ParseFloat(ptr, endPtr, normal.x);
+			ptr = ParseFloat(ptr, endPtr, normal.y);
+			ParseFloat(ptr, endPtr, normal.z);
+			chunkData.NormalVec.emplace_back(normal);
+		}
+		else if (keyword == "f")
+		{
+			polygonVec.clear();
+			for (ptr = SkipSpaces(ptr, endPtr); ptr < endPtr; ptr = SkipSpaces(ptr, endPtr))
+			{
+				RawCorner corner{};
+				ptr = ParseCorner(ptr, endPtr, chunkData, corner);
+				if (ptr == nullptr)
+				{
+					chunkData.Failed = true;
+					return;
+				}
+				polygonVec.emplace_back(corner);
+			}
+
+			//quads and n-gons are fanned around their first corner
+			for (std::size_t cornerIdx{ 2 }; cornerIdx < polygonVec.size(); ++cornerIdx)
+			{
+				chunkData.CornerVec.emplace_back(polygonVec[0]);
+				chunkData.CornerVec.emplace_back(polygonVec[cornerIdx - 1]);
+				chunkData.CornerVec.emplace_back(polygonVec[cornerIdx]);
+			}
+		}
+		//comments, groups, materials and smoothing groups are ignored
+	}
+
+	void ParseChunk(char const* ptr, char const* endPtr, ChunkData& chunkData)
+	{
+		std::vector<RawCorner> polygonVec{};
+		while (ptr < endPtr and not chunkData.Failed)
+		{
+			char const* lineEndPtr{ static_cast<char const*>(memchr(ptr, '\n', static_cast<std::size_t>(endPtr - ptr))) };
+			if (lineEndPtr == nullptr)
+			{
+				lineEndPtr = endPtr;
+			}
+
+			ParseLine(ptr, lineEndPtr, chunkData, polygonVec);
+			ptr = lineEndPtr + 1;
+		}
+	}
+
+	//moves a byte offset to the start of the line it is in the middle of
+	std::size_t AlignToLine(char const* dataPtr, std::size_t size, std::size_t offset)
+	{
+		if (offset == 0 or offset >= size)
+		{
+			return std::min(offset, size);
+		}
+
+		void const* newLinePtr{ memchr(dataPtr + offset - 1, '\n', size - offset + 1) };
+		return newLinePtr == nullptr ? size : static_cast<std::size_t>(static_cast<char const*>(newLinePtr) - dataPtr) + 1;
+	}
+}
+
+bool vkUtil::ParseOBJData(const std::string& filename, ObjData& objData)
+{
+	objData = ObjData{};
+
+	MappedFile const file{ filename };
+	if (not file.IsOpen())
+	{
+		//an empty file maps to nothing but is still a valid obj
+		std::error_code errorCode{};
+		return std::filesystem::exists(filename, errorCode) and std::filesystem::file_size(filename, errorCode) == 0;
+	}
+
+	char const* const dataPtr{ reinterpret_cast<char const*>(file.GetData().data()) };
+	std::size_t const size{ file.GetData().size() };
+
+	std::int64_t const chunkCount{ static_cast<std::int64_t>((size + ChunkSize - 1) / ChunkSize) };
+	std::vector<ChunkData> chunkDataVec(static_cast<std::size_t>(chunkCount));
+
+	ave::ThreadPool::GetInstance().ParallelFor(chunkCount, 1,
+		[&](std::int64_t begin, std::int64_t end)
+		{
+			for (std::int64_t chunkIdx{ begin }; chunkIdx < end; ++chunkIdx)
+			{
+				std::size_t const chunkBegin{ AlignToLine(dataPtr, size, static_cast<std::size_t>(chunkIdx) * ChunkSize) };
+				std::size_t const chunkEnd{ AlignToLine(dataPtr, size, static_cast<std::size_t>(chunkIdx + 1) * ChunkSize) };
+				ParseChunk(dataPtr + chunkBegin, dataPtr + chunkEnd, chunkDataVec[chunkIdx]);
+			}
+		});
+
+	//where the pools and corners of every chunk start in the merged arrays
+	struct ChunkOffsets
+	{
+		std::int64_t PoolArr[3];
+		std::int64_t Corner;
+	};
+	std::vector<ChunkOffsets> offsetVec(chunkDataVec.size());
+	ChunkOffsets total{};
+	for (std::size_t chunkIdx{}; chunkIdx < chunkDataVec.size(); ++chunkIdx)
+	{
+		ChunkData const& chunkData{ chunkDataVec[chunkIdx] };
+		if (chunkData.Failed)
+		{
+			std::cout << "Failed to parse a face in " << filename << "\n";
+			return false;
+		}
+
+		offsetVec[chunkIdx] = total;
+		total.PoolArr[0] += std::ssize(chunkData.PositionVec);
+		total.PoolArr[1] += std::ssize(chunkData.UVVec);
+		total.PoolArr[2] += std::ssize(chunkData.NormalVec);
+		total.Corner += std::ssize(chunkData.CornerVec);
+	}
+
+	objData.PositionVec.resize(static_cast<std::size_t>(total.PoolArr[0]));
+	objData.UVVec.resize(static_cast<std::size_t>(total.PoolArr[1]));
+	objData.NormalVec.resize(static_cast<std::size_t>(total.PoolArr[2]));
+	objData.CornerVec.resize(static_cast<std::size_t>(total.Corner));
+
+	std::atomic<bool> outOfRange{ false };
+	ave::ThreadPool::GetInstance().ParallelFor(chunkCount, 1,
+		[&](std::int64_t begin, std::int64_t end)
+		{
+			for (std::int64_t chunkIdx{ begin }; chunkIdx < end; ++chunkIdx)
+			{
+				ChunkData const& chunkData{ chunkDataVec[chunkIdx] };
+				ChunkOffsets const& offsets{ offsetVec[chunkIdx] };
+
+				std::copy(chunkData.PositionVec.begin(), chunkData.PositionVec.end(), objData.PositionVec.begin() + offsets.PoolArr[0]);
+				std::copy(chunkData.UVVec.begin(), chunkData.UVVec.end(), objData.UVVec.begin() + offsets.PoolArr[1]);
+				std::copy(chunkData.NormalVec.begin(), chunkData.NormalVec.end(), objData.NormalVec.begin() + offsets.PoolArr[2]);
+
+				for (std::size_t cornerIdx{}; cornerIdx < chunkData.CornerVec.size(); ++cornerIdx)
+				{
+					RawCorner const& rawCorner{ chunkData.CornerVec[cornerIdx] };
+
+					uint32_t idxArr[3]{ ObjCorner::MissingIdx, ObjCorner::MissingIdx, ObjCorner::MissingIdx };
+					for (int attributeIdx{}; attributeIdx < 3; ++attributeIdx)
+					{
+						if ((rawCorner.PresentMask & (1 << attributeIdx)) == 0)
+						{
+							continue;
+						}
+
+						std::int64_t idx{ rawCorner.IdxArr[attributeIdx] };
+						if (rawCorner.RelativeMask & (1 << attributeIdx))
+						{
+							idx += offsets.PoolArr[attributeIdx];
+						}
+
+						if (idx < 0 or idx >= total.PoolArr[attributeIdx])
+						{
+							outOfRange = true;
+							idx = 0;
+						}
+						idxArr[attributeIdx] = static_cast<uint32_t>(idx);
+					}
+
+					//a face has to reference a position
+					if (idxArr[0] == ObjCorner::MissingIdx)
+					{
+						outOfRange = true;
+						idxArr[0] = 0;
+					}
+
+					objData.CornerVec[offsets.Corner + cornerIdx] = ObjCorner{ idxArr[0], idxArr[1], idxArr[2] };
+				}
+			}
+		});
+
+	if (outOfRange)
+	{
+		std::cout << "Face index out of range in " << filename << "\n";
+		objData = ObjData{};
+		return false;
+	}
+
+	return true;
+}
@@ -2,152 +2,83 @@
 #define VK_FILEREADER_OBJ_H
 #include "Engine/Configuration.h"
 #include "RenderStructs.h"
+#include "Engine/ThreadPool.h"
 namespace vkUtil
 {
-	template<typename VertexStruct>
-	bool ParseOBJ(const std::string& filename, std::vector<VertexStruct>& vertexVec, std::vector<uint32_t>& indexVec, bool flipAxisAndWinding)
+	//one corner of a triangle, indices into the merged pools of ObjData, MissingIdx when the face left it out
+	struct ObjCorner
 	{
-		std::ifstream file{ filename };
-		if (!file)
-		{
-			return false;
-		}
+		static constexpr uint32_t MissingIdx{ UINT32_MAX };
+
+		uint32_t PositionIdx;
+		uint32_t UVIdx;
+		uint32_t NormalIdx;
+	};
+
+	//the obj as read from the file, polygons are already fanned into triangles, three corners per triangle
+	struct ObjData
+	{
+		std::vector<glm::vec3> PositionVec;
+		//v is already flipped to the vulkan convention
+		std::vector<glm::vec2> UVVec;
+		std::vector<glm::vec3> NormalVec;
+		std::vector<ObjCorner> CornerVec;
+	};
 
-		std::vector<glm::vec3> positionVec{};
-		std::vector<glm::vec3> normalVec{};
-		std::vector<glm::vec2> uvVec{};
+	//maps the file and parses line aligned chunks of it on the thread pool
+	//supports triangles, quads and n-gons and negative (relative) indices, returns false when the file can not be read or an index is out of range
+	bool ParseOBJData(const std::string& filename, ObjData& objData);
 
+	//every corner becomes its own vertex, z is flipped because vulkan uses inverted depth
+	template<typename VertexStruct>
+	bool ParseOBJ(const std::string& filename, std::vector<VertexStruct>& vertexVec, std::vector<uint32_t>& indexVec, bool flipAxisAndWinding)
+	{
 		vertexVec.clear();
 		indexVec.clear();
 
-		std::string scommand;
-		// start a while iteration ending when the end of file is reached (ios::eof)
-		while (!file.eof())
+		ObjData objData{};
+		if (not ParseOBJData(filename, objData))
 		{
-			//read the first word of the string, use the >> operator (istream::operator>>) 
-			file >> scommand;
-			//use conditional statements to process the different commands	
-			if (scommand == "#")
-			{
-				// ignore comment
-			}
-			else if (scommand == "v")
-			{
-				//vertex
-				float x, y, z;
-				file >> x >> y >> z;
+			return false;
+		}
 
-				positionVec.emplace_back(glm::vec3{ x, y, z });
-			}
-			else if (scommand == "vt")
-			{
-				// vertex texcoord
-				float u, v;
-				file >> u >> v;
-				uvVec.emplace_back(u, 1 - v);
-			}
-			else if (scommand == "vn")
-			{
-				// vertex normal
-				float x, y, z;
-				file >> x >> y >> z;
+		std::int64_t const triangleCount{ std::ssize(objData.CornerVec) / 3 };
+		vertexVec.resize(objData.CornerVec.size());
+		indexVec.resize(objData.CornerVec.size());
 
-				normalVec.emplace_back(glm::vec3{ x, y, z });
-			}
-			else if (scommand == "f")
+		//triangles per task of the thread pool
+		constexpr std::int64_t chunkSize{ 1 << 16 };
+		ave::ThreadPool::GetInstance().ParallelFor(triangleCount, chunkSize,
+			[&](std::int64_t begin, std::int64_t end)
 			{
-				//if a face is read:
-				//construct the 3 vertices, add them to the vertex array
-				//add three indices to the index array
-				//add the material index as attibute to the attribute array
-				//
-				// faces or triangles
-				VertexStruct vertex{};
-				size_t idxPosition, idxTexCoord, idxNormal;
-
-				uint32_t tempindexvec[3];
-				for (size_t idxface = 0; idxface < 3; idxface++)
+				for (std::int64_t triangleIdx{ begin }; triangleIdx < end; ++triangleIdx)
 				{
-					// obj format uses 1-based arrays
-					file >> idxPosition;
-
-					vertex.Position = positionVec[idxPosition - 1];
-					//flip z because vulkan uses inverted depth
-					vertex.Position.z *= -1.f;
-
-					if ('/' == file.peek())//is next in buffer ==  '/' ?
+					for (std::int64_t cornerIdx{ triangleIdx * 3 }; cornerIdx < triangleIdx * 3 + 3; ++cornerIdx)
 					{
-						file.ignore();//read and ignore one element ('/')
+						ObjCorner const& corner{ objData.CornerVec[cornerIdx] };
 
-						if ('/' != file.peek())
+						VertexStruct vertex{};
+						vertex.Position = objData.PositionVec[corner.PositionIdx];
+						vertex.Position.z *= -1.f;
+						if (corner.UVIdx != ObjCorner::MissingIdx)
 						{
-							// optional texture coordinate
-							file >> idxTexCoord;
-							vertex.UV = uvVec[idxTexCoord - 1];
+							vertex.UV = objData.UVVec[corner.UVIdx];
 						}
-
-						if ('/' == file.peek())
+						if (corner.NormalIdx != ObjCorner::MissingIdx)
 						{
-							file.ignore();
-
-							// optional vertex normal
-							file >> idxNormal;
-							vertex.Normal = normalVec[idxNormal - 1];
+							vertex.Normal = objData.NormalVec[corner.NormalIdx];
 						}
+						vertexVec[cornerIdx] = vertex;
 					}
 
-					vertexVec.emplace_back(vertex);
-					tempindexvec[idxface] = uint32_t(vertexVec.size()) - 1;
+					uint32_t const firstVertex{ static_cast<uint32_t>(triangleIdx * 3) };
+					indexVec[triangleIdx * 3] = firstVertex;
+					indexVec[triangleIdx * 3 + 1] = flipAxisAndWinding ? firstVertex + 2 : firstVertex + 1;
+					indexVec[triangleIdx * 3 + 2] = flipAxisAndWinding ? firstVertex + 1 : firstVertex + 2;
 				}
+			});
 
-				indexVec.emplace_back(tempindexvec[0]);
-				if (flipAxisAndWinding)
-				{
-					indexVec.emplace_back(tempindexvec[2]);
-					indexVec.emplace_back(tempindexvec[1]);
-				}
-				else
-				{
-					indexVec.emplace_back(tempindexvec[1]);
-					indexVec.emplace_back(tempindexvec[2]);
-				}
-			}
-			//read till end of line and ignore all remaining chars
-			file.ignore(1000, '\n');
-		}
-
-		//cheap tangent calculations
-		//for (uint32_t i = 0; i < indexvec.size(); i += 3)
-		//{
-		//	uint32_t index0 = indexvec[i];
-		//	uint32_t index1 = indexvec[size_t(i) + 1];
-		//	uint32_t index2 = indexvec[size_t(i) + 2];
-		//
-		//	const glm::vec3& p0 = vertexvec[index0].position;
-		//	const glm::vec3& p1 = vertexvec[index1].position;
-		//	const glm::vec3& p2 = vertexvec[index2].position;
-		//	//const vector2& uv0 = vertexvec[index0].uv;
-		//	//const vector2& uv1 = vertexvec[index1].uv;
-		//	//const vector2& uv2 = vertexvec[index2].uv;
-		//
-		//	//const glm::vec3 edge0 = p1 - p0;
-		//	//const glm::vec3 edge1 = p2 - p0;
-		//	//const vector2 diffx = vector2(uv1.x - uv0.x, uv2.x - uv0.x);
-		//	//const vector2 diffy = vector2(uv1.y - uv0.y, uv2.y - uv0.y);
-		//	//float r = 1.f / vector2::cross(diffx, diffy);
-		//
-		//	//vector3 tangent = (edge0 * diffy.y - edge1 * diffy.x) * r;
-		//	//vertexvec[index0].tangent += tangent;
-		//	//vertexvec[index1].tangent += tangent;
-		//	//vertexvec[index2].tangent += tangent;
-		//}
-
-		//fix the tangents per vertex now because we accumulated
-		//for (auto& v : vertexVec)
-		//{
-		//	//	v.tangent = vector3::reject(v.tangent, v.normal).normalized();
-		//}
 		return true;
 	}
 }
-#endif
\ No newline at end of file
+#endif
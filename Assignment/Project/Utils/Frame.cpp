@@ -1,8 +1,9 @@
 #include "Frame.h"
 #include "Rendering/Image.h"
+#include "Utils/InstanceLayout.h"
 #include <execution>
 
-void vkUtil::SwapchainFrame::CreateDescriptorResources(std::int64_t const& nrWorldMatrices)
+void vkUtil::FrameContext::CreateDescriptorResources(std::int64_t const& nrWorldMatrices, std::int64_t const& nrDrawCommands)
 {
 	BufferInBundle inputUBO;
 	inputUBO.Device = Device;
@@ -12,32 +13,239 @@ void vkUtil::SwapchainFrame::CreateDescriptorResources(std::int64_t const& nrWor
 	inputUBO.UsageFlags = vk::BufferUsageFlagBits::eUniformBuffer;
 
 	VPBuffer = vkUtil::CreateBuffer(inputUBO);
-	VPWriteLocationPtr = Device.mapMemory(VPBuffer.BufferMemory, 0, inputUBO.Size);
+	VPWriteLocationPtr = VPBuffer.Allocation.MappedPtr;
 
 	UBODescriptorInfo.buffer = VPBuffer.Buffer;
 	UBODescriptorInfo.offset = 0;
 	UBODescriptorInfo.range = sizeof(UBO);
 
+	CreateInstanceResources(nrWorldMatrices);
+	CreateDrawCommandResources(nrDrawCommands);
+}
+
+void vkUtil::FrameContext::CreateDrawCommandResources(std::int64_t const& drawCommandCapacity)
+{
+	DrawCommandCapacity = std::max(drawCommandCapacity, MinDrawCommandCapacity);
+
+	BufferInBundle inputDrawCommand;
+	inputDrawCommand.Device = Device;
+	inputDrawCommand.PhysicalDevice = PhysicalDevice;
+	inputDrawCommand.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	inputDrawCommand.Size = DrawCommandCapacity * sizeof(vk::DrawIndexedIndirectCommand);
+	inputDrawCommand.UsageFlags = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer;
+
+	DrawCommandBuffer = vkUtil::CreateBuffer(inputDrawCommand);
+	DrawCommandWriteLocationPtr = static_cast<vk::DrawIndexedIndirectCommand*>(DrawCommandBuffer.Allocation.MappedPtr);
+	DrawCommandCount = 0;
+	CulledInstanceCount = 0;
+
+	DrawCommandDescriptorInfo.buffer = DrawCommandBuffer.Buffer;
+	DrawCommandDescriptorInfo.offset = 0;
+	DrawCommandDescriptorInfo.range = inputDrawCommand.Size;
+
+	BufferInBundle inputDrawData;
+	inputDrawData.Device = Device;
+	inputDrawData.PhysicalDevice = PhysicalDevice;
+	inputDrawData.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	inputDrawData.Size = DrawCommandCapacity * sizeof(vkUtil::DrawData);
+	inputDrawData.UsageFlags = vk::BufferUsageFlagBits::eStorageBuffer;
+
+	DrawDataBuffer = vkUtil::CreateBuffer(inputDrawData);
+	DrawDataWriteLocationPtr = static_cast<vkUtil::DrawData*>(DrawDataBuffer.Allocation.MappedPtr);
+
+	DrawDataDescriptorInfo.buffer = DrawDataBuffer.Buffer;
+	DrawDataDescriptorInfo.offset = 0;
+	DrawDataDescriptorInfo.range = inputDrawData.Size;
+}
+
+void vkUtil::FrameContext::RetireDrawCommandResources(int framesInFlight)
+{
+	RetiredBufferVec.emplace_back(RetiredBuffer{ DrawCommandBuffer, framesInFlight });
+	RetiredBufferVec.emplace_back(RetiredBuffer{ DrawDataBuffer, framesInFlight });
+
+	DrawCommandBuffer = DataBuffer{};
+	DrawCommandWriteLocationPtr = nullptr;
+	DrawDataBuffer = DataBuffer{};
+	DrawDataWriteLocationPtr = nullptr;
+}
+
+bool vkUtil::FrameContext::ResizeInstanceResources(std::int64_t const& instanceCount, int framesInFlight)
+{
+	std::int64_t newCapacity{ InstanceCapacity };
+	if (instanceCount > InstanceCapacity)
+	{
+		newCapacity = std::max(InstanceCapacity, MinInstanceCapacity);
+		while (newCapacity < instanceCount)
+		{
+			newCapacity *= 2;
+		}
+	}
+	else if (instanceCount < InstanceCapacity / 4 and InstanceCapacity > MinInstanceCapacity)
+	{
+		//shrinking right away would reallocate every frame for a count that jumps around a boundary
+		if (++PreparesBelowShrinkThreshold >= ShrinkDelay)
+		{
+			newCapacity = std::max(instanceCount * 2, MinInstanceCapacity);
+		}
+	}
+	else
+	{
+		PreparesBelowShrinkThreshold = 0;
+	}
+
+	if (newCapacity == InstanceCapacity)
+	{
+		return false;
+	}
+
+	RetireInstanceResources(framesInFlight);
+	CreateInstanceResources(newCapacity);
+	PreparesBelowShrinkThreshold = 0;
+	DescriptorSetDirty = true;
+
+	return true;
+}
+
+bool vkUtil::FrameContext::ResizeDrawCommandResources(std::int64_t const& drawCommandCount, int framesInFlight)
+{
+	if (drawCommandCount <= DrawCommandCapacity)
+	{
+		return false;
+	}
+
+	std::int64_t newCapacity{ std::max(DrawCommandCapacity, MinDrawCommandCapacity) };
+	while (newCapacity < drawCommandCount)
+	{
+		newCapacity *= 2;
+	}
+
+	RetireDrawCommandResources(framesInFlight);
+	CreateDrawCommandResources(newCapacity);
+	DescriptorSetDirty = true;
+
+	return true;
+}
+
+void vkUtil::FrameContext::AdvanceRetiredBuffers()
+{
+	for (auto& retired : RetiredBufferVec)
+	{
+		--retired.FramesLeft;
+	}
+
+	auto const releaseIt{ std::partition(RetiredBufferVec.begin(), RetiredBufferVec.end(),
+		[](RetiredBuffer const& retired)
+		{
+			return retired.FramesLeft > 0;
+		}) };
+
+	for (auto retiredIt{ releaseIt }; retiredIt != RetiredBufferVec.end(); ++retiredIt)
+	{
+		vkUtil::DestroyBuffer(Device, retiredIt->Buffer);
+	}
+	RetiredBufferVec.erase(releaseIt, RetiredBufferVec.end());
+}
+
+std::size_t vkUtil::FrameContext::GetInstanceBufferBytes() const
+{
+	return static_cast<std::size_t>(InstanceCapacity) * (sizeof(vkUtil::DefaultInstanceLayout::GPUInstance) + (2 * MaxLodCount + 1) * sizeof(uint32_t));
+}
+
+void vkUtil::FrameContext::CreateInstanceResources(std::int64_t const& instanceCapacity)
+{
+	InstanceCapacity = std::max(instanceCapacity, MinInstanceCapacity);
+
 	BufferInBundle inputStorage;
 	inputStorage.Device = Device;
 	inputStorage.PhysicalDevice = PhysicalDevice;
 	inputStorage.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
-	//TODO make input parameter out of 1069
-	inputStorage.Size = nrWorldMatrices * sizeof(glm::mat4);
+	inputStorage.Size = InstanceCapacity * sizeof(vkUtil::DefaultInstanceLayout::GPUInstance);
 	inputStorage.UsageFlags = vk::BufferUsageFlagBits::eStorageBuffer;
 
 	WBuffer = vkUtil::CreateBuffer(inputStorage);
-	WBufferWriteLocationPtr = Device.mapMemory(WBuffer.BufferMemory, 0, inputStorage.Size);
-
-	WMatrixVec.resize(inputStorage.Size, glm::mat4(1.0f));
+	WBufferWriteLocationPtr = WBuffer.Allocation.MappedPtr;
 
 	WDescriptorInfo.buffer = WBuffer.Buffer;
 	WDescriptorInfo.offset = 0;
 	WDescriptorInfo.range = inputStorage.Size;
+
+	BufferInBundle inputVisible;
+	inputVisible.Device = Device;
+	inputVisible.PhysicalDevice = PhysicalDevice;
+	inputVisible.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
+	inputVisible.Size = InstanceCapacity * MaxLodCount * sizeof(uint32_t);
+	inputVisible.UsageFlags = vk::BufferUsageFlagBits::eStorageBuffer;
+
+	VisibleBuffer = vkUtil::CreateBuffer(inputVisible);
+
+	VisibleDescriptorInfo.buffer = VisibleBuffer.Buffer;
+	VisibleDescriptorInfo.offset = 0;
+	VisibleDescriptorInfo.range = inputVisible.Size;
+
+	BufferInBundle inputCpuVisible{ inputVisible };
+	inputCpuVisible.MemoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+	CpuVisibleBuffer = vkUtil::CreateBuffer(inputCpuVisible);
+	CpuVisibleWriteLocationPtr = static_cast<uint32_t*>(CpuVisibleBuffer.Allocation.MappedPtr);
+
+	CpuVisibleDescriptorInfo.buffer = CpuVisibleBuffer.Buffer;
+	CpuVisibleDescriptorInfo.offset = 0;
+	CpuVisibleDescriptorInfo.range = inputCpuVisible.Size;
+
+	BufferInBundle inputLod{ inputStorage };
+	inputLod.Size = InstanceCapacity * sizeof(uint32_t);
+
+	LodBuffer = vkUtil::CreateBuffer(inputLod);
+	LodWriteLocationPtr = static_cast<uint32_t*>(LodBuffer.Allocation.MappedPtr);
+	//every instance starts at the full mesh, the first selection moves it to its lod right away
+	std::fill_n(LodWriteLocationPtr, InstanceCapacity, 0);
+
+	LodDescriptorInfo.buffer = LodBuffer.Buffer;
+	LodDescriptorInfo.offset = 0;
+	LodDescriptorInfo.range = inputLod.Size;
+}
+
+void vkUtil::FrameContext::RetireInstanceResources(int framesInFlight)
+{
+	RetiredBufferVec.emplace_back(RetiredBuffer{ WBuffer, framesInFlight });
+	RetiredBufferVec.emplace_back(RetiredBuffer{ VisibleBuffer, framesInFlight });
+	RetiredBufferVec.emplace_back(RetiredBuffer{ CpuVisibleBuffer, framesInFlight });
+	RetiredBufferVec.emplace_back(RetiredBuffer{ LodBuffer, framesInFlight });
+
+	WBuffer = DataBuffer{};
+	WBufferWriteLocationPtr = nullptr;
+	VisibleBuffer = DataBuffer{};
+	CpuVisibleBuffer = DataBuffer{};
+	CpuVisibleWriteLocationPtr = nullptr;
+	LodBuffer = DataBuffer{};
+	LodWriteLocationPtr = nullptr;
+}
+
+std::int64_t vkUtil::FrameContext::ReadVisibleInstanceCount() const
+{
+	std::int64_t visibleInstances{};
+	for (std::int64_t commandIdx{}; commandIdx < DrawCommandCount; ++commandIdx)
+	{
+		visibleInstances += DrawCommandWriteLocationPtr[commandIdx].instanceCount;
+	}
+	return visibleInstances;
+}
+
+std::int64_t vkUtil::FrameContext::ReadVisibleTriangleCount() const
+{
+	std::int64_t visibleTriangles{};
+	for (std::int64_t commandIdx{}; commandIdx < DrawCommandCount; ++commandIdx)
+	{
+		vk::DrawIndexedIndirectCommand const& command{ DrawCommandWriteLocationPtr[commandIdx] };
+		visibleTriangles += static_cast<std::int64_t>(command.instanceCount) * (command.indexCount / 3);
+	}
+	return visibleTriangles;
 }
 
-void vkUtil::SwapchainFrame::WriteDescriptorSet()
+void vkUtil::FrameContext::WriteDescriptorSet()
 {
+	DescriptorSetDirty = false;
+
 	vk::WriteDescriptorSet writeInfoUBO{};
 	writeInfoUBO.dstSet = DescriptorSet;
 	writeInfoUBO.dstBinding = 0;
@@ -57,6 +265,46 @@ void vkUtil::SwapchainFrame::WriteDescriptorSet()
 	writeInfoStorage.pBufferInfo = &WDescriptorInfo;
 
 	Device.updateDescriptorSets(writeInfoStorage, nullptr);
+
+	vk::WriteDescriptorSet writeInfoVisible{};
+	writeInfoVisible.dstSet = DescriptorSet;
+	writeInfoVisible.dstBinding = 2;
+	writeInfoVisible.dstArrayElement = 0;
+	writeInfoVisible.descriptorCount = 1;
+	writeInfoVisible.descriptorType = vk::DescriptorType::eStorageBuffer;
+	writeInfoVisible.pBufferInfo = CpuCulling ? &CpuVisibleDescriptorInfo : &VisibleDescriptorInfo;
+
+	Device.updateDescriptorSets(writeInfoVisible, nullptr);
+
+	vk::WriteDescriptorSet writeInfoDrawCommand{};
+	writeInfoDrawCommand.dstSet = DescriptorSet;
+	writeInfoDrawCommand.dstBinding = 3;
+	writeInfoDrawCommand.dstArrayElement = 0;
+	writeInfoDrawCommand.descriptorCount = 1;
+	writeInfoDrawCommand.descriptorType = vk::DescriptorType::eStorageBuffer;
+	writeInfoDrawCommand.pBufferInfo = &DrawCommandDescriptorInfo;
+
+	Device.updateDescriptorSets(writeInfoDrawCommand, nullptr);
+
+	vk::WriteDescriptorSet writeInfoDrawData{};
+	writeInfoDrawData.dstSet = DescriptorSet;
+	writeInfoDrawData.dstBinding = 4;
+	writeInfoDrawData.dstArrayElement = 0;
+	writeInfoDrawData.descriptorCount = 1;
+	writeInfoDrawData.descriptorType = vk::DescriptorType::eStorageBuffer;
+	writeInfoDrawData.pBufferInfo = &DrawDataDescriptorInfo;
+
+	Device.updateDescriptorSets(writeInfoDrawData, nullptr);
+
+	vk::WriteDescriptorSet writeInfoLod{};
+	writeInfoLod.dstSet = DescriptorSet;
+	writeInfoLod.dstBinding = 5;
+	writeInfoLod.dstArrayElement = 0;
+	writeInfoLod.descriptorCount = 1;
+	writeInfoLod.descriptorType = vk::DescriptorType::eStorageBuffer;
+	writeInfoLod.pBufferInfo = &LodDescriptorInfo;
+
+	Device.updateDescriptorSets(writeInfoLod, nullptr);
 }
 
 void vkUtil::SwapchainFrame::CreateDepthResources()
@@ -81,7 +329,7 @@ void vkUtil::SwapchainFrame::CreateDepthResources()
 	imgInput.Extent = DepthExtent;
 	imgInput.Format = DepthFormat;
 	DepthBuffer = vkInit::CreateImage(imgInput);
-	DepthBufferMemory = vkInit::CreateImageMemory(imgInput, DepthBuffer);
+	DepthBufferAllocation = vkInit::CreateImageMemory(imgInput, DepthBuffer);
 	DepthBufferView = vkInit::CreateImageView
 	(
 		Device, DepthBuffer, DepthFormat, vk::ImageAspectFlagBits::eDepth
@@ -91,17 +339,36 @@ void vkUtil::SwapchainFrame::CreateDepthResources()
 void vkUtil::SwapchainFrame::Destroy()
 {
 	Device.destroyImage(DepthBuffer);
-	Device.freeMemory(DepthBufferMemory);
+	vkUtil::MemoryAllocator::GetInstance().Free(DepthBufferAllocation);
 	Device.destroyImageView(DepthBufferView);
 	Device.destroySemaphore(SemaphoreRenderingFinished);
-	Device.destroySemaphore(SemaphoreImageAvailable);
-	Device.destroyFence(InFlightFence);
 	Device.destroyFramebuffer(Framebuffer);
 	Device.destroyImageView(ImageView);
-	Device.unmapMemory(VPBuffer.BufferMemory);
-	Device.freeMemory(VPBuffer.BufferMemory);
-	Device.destroyBuffer(VPBuffer.Buffer);
-	Device.unmapMemory(WBuffer.BufferMemory);
-	Device.freeMemory(WBuffer.BufferMemory);
-	Device.destroyBuffer(WBuffer.Buffer);
 }
+
+void vkUtil::FrameContext::Destroy()
+{
+	Device.destroySemaphore(SemaphoreImageAvailable);
+	Device.destroyFence(InFlightFence);
+	//frees the secondary command buffers as well
+	for (auto const& commandPool : RecordingCommandPoolVec)
+	{
+		Device.destroyCommandPool(commandPool);
+	}
+	RecordingCommandPoolVec.clear();
+	SecondaryCommandBufferVec.clear();
+	vkUtil::DestroyBuffer(Device, VPBuffer);
+	vkUtil::DestroyBuffer(Device, WBuffer);
+	vkUtil::DestroyBuffer(Device, VisibleBuffer);
+	vkUtil::DestroyBuffer(Device, CpuVisibleBuffer);
+	vkUtil::DestroyBuffer(Device, LodBuffer);
+	vkUtil::DestroyBuffer(Device, DrawCommandBuffer);
+	vkUtil::DestroyBuffer(Device, DrawDataBuffer);
+
+	//only called once the device is idle
+	for (auto& retired : RetiredBufferVec)
+	{
+		vkUtil::DestroyBuffer(Device, retired.Buffer);
+	}
+	RetiredBufferVec.clear();
+}
\ No newline at end of file
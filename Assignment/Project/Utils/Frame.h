@@ -2,6 +2,7 @@
 #define VK_FRAME_H
 #include "Engine/Configuration.h"
 #include "Buffer.h"
+#include "RenderStructs.h"
 
 namespace vkUtil
 {
@@ -10,8 +11,46 @@ namespace vkUtil
 	{
 		glm::mat4 ViewMatrix;
 		glm::mat4 ProjectionMatrix;
+		glm::vec4 FrustumPlaneArr[6];
+		//w is unused, the culling pass measures the lod distances from it
+		glm::vec4 CameraPosition;
+	};
+
+	struct FrameStatistics
+	{
+		std::size_t UploadedInstanceBytes{};
+		//read back from the gpu culling pass, a few frames behind the current one
+		std::int64_t VisibleInstances{};
+		std::int64_t TotalInstances{};
+		//triangles of the lods the visible instances were drawn with, read back like VisibleInstances
+		std::int64_t VisibleTriangles{};
+		double CpuCullMilliseconds{};
+		//measured with timestamps on the gpu, the render pass time is where the texture filtering shows
+		double GpuCullMilliseconds{};
+		double GpuRenderPassMilliseconds{};
+		//instance, visible index buffers of every frame together and the transforms the scene keeps on the host
+		std::int64_t InstanceCapacity{};
+		std::size_t InstanceBufferBytes{};
+		std::size_t HostInstanceBytes{};
+		//summed over the device local heaps of the memory allocator
+		vk::DeviceSize DeviceLocalUsedBytes{};
+		vk::DeviceSize DeviceLocalAllocatedBytes{};
+		//images of the streamed texture levels against the budget of the texture loader
+		vk::DeviceSize TextureResidentBytes{};
+		vk::DeviceSize TextureBudgetBytes{};
+		//cpu time of recording the draws of the render pass and the batches it was split in, 0 records them into the primary command buffer
+		double RecordMilliseconds{};
+		int RecordingThreads{};
 	};
 	
+	//buffer that might still be read by a frame in flight, destroyed once every frame has been waited on
+	struct RetiredBuffer
+	{
+		DataBuffer Buffer;
+		int FramesLeft;
+	};
+
+	//what belongs to one image of the swapchain, the image index picks it
 	struct SwapchainFrame
 	{
 		vk::Device Device;
@@ -23,14 +62,40 @@ namespace vkUtil
 
 		vk::Image DepthBuffer;
 		vk::ImageView DepthBufferView;
-		vk::DeviceMemory DepthBufferMemory;
+		vkUtil::MemoryAllocation DepthBufferAllocation;
 		vk::Format DepthFormat;
 		vk::Extent2D DepthExtent;
 
+		//signaled by the submit that renders into the image and waited on by its present
+		//the image is only acquired again once that present is done with it, a frame in flight can not reuse it too early
+		vk::Semaphore SemaphoreRenderingFinished;
+
+		void CreateDepthResources();
+
+		void Destroy();
+	};
+
+	//everything the cpu writes or records for one frame in flight, the frame number picks it and its fence guards all of it
+	//there are fewer of them than swapchain images, a frame renders into whichever image was acquired
+	struct FrameContext
+	{
+		//instance buffers never get smaller than this
+		static constexpr std::int64_t MinInstanceCapacity{ 1024 };
+		//prepares in a row the instance count has to stay below a quarter of the capacity before the buffers shrink
+		static constexpr int ShrinkDelay{ 300 };
+		//draw command buffers never get smaller than this
+		static constexpr std::int64_t MinDrawCommandCapacity{ 64 };
+
+		vk::Device Device;
+		vk::PhysicalDevice PhysicalDevice;
+
 		vk::CommandBuffer CommandBuffer;
+		//one pool and one secondary command buffer per recording batch, a batch only ever runs on one thread at a time
+		//the pools are reset as a whole once the fence of the frame was waited on
+		std::vector<vk::CommandPool> RecordingCommandPoolVec;
+		std::vector<vk::CommandBuffer> SecondaryCommandBufferVec;
 
 		vk::Semaphore SemaphoreImageAvailable;
-		vk::Semaphore SemaphoreRenderingFinished;
 		vk::Fence InFlightFence;
 
 		UBO VPMatrix{};
@@ -39,22 +104,81 @@ namespace vkUtil
 
 		vk::DescriptorBufferInfo UBODescriptorInfo;
 
-		std::vector<glm::mat4> WMatrixVec;
+		//WBuffer and LodBuffer hold this many instances, VisibleBuffer and CpuVisibleBuffer this many per lod
+		std::int64_t InstanceCapacity{};
+		int PreparesBelowShrinkThreshold{};
+
 		vkUtil::DataBuffer WBuffer;
 		void* WBufferWriteLocationPtr{ nullptr };
+		//bytes of instance data written into WBuffer during the last prepare of this frame
+		std::size_t UploadedInstanceBytes{};
 
 		vk::DescriptorBufferInfo WDescriptorInfo;
 
-		//shared by WDescriptorInfo and VPDescriptorInfo
+		vkUtil::DataBuffer VisibleBuffer;
+		vk::DescriptorBufferInfo VisibleDescriptorInfo;
+
+		//filled by the cpu culler instead of the compute pass, bound in place of VisibleBuffer while CpuCulling is set
+		vkUtil::DataBuffer CpuVisibleBuffer;
+		uint32_t* CpuVisibleWriteLocationPtr{ nullptr };
+		vk::DescriptorBufferInfo CpuVisibleDescriptorInfo;
+		bool CpuCulling{ false };
+
+		//the lod every instance was selected for the last time this frame was culled, the hysteresis of the next selection starts from it
+		//host visible so the cpu culler can use the same state as the compute pass
+		vkUtil::DataBuffer LodBuffer;
+		uint32_t* LodWriteLocationPtr{ nullptr };
+		vk::DescriptorBufferInfo LodDescriptorInfo;
+
+		//DrawCommandBuffer and DrawDataBuffer hold this many commands
+		std::int64_t DrawCommandCapacity{};
+
+		//host visible so the culled instance counts can be read back once the frame is done
+		vkUtil::DataBuffer DrawCommandBuffer;
+		vk::DrawIndexedIndirectCommand* DrawCommandWriteLocationPtr{ nullptr };
+		vk::DescriptorBufferInfo DrawCommandDescriptorInfo;
+		std::int64_t DrawCommandCount{};
+
+		//one entry per draw command, read by the vertex shader through gl_DrawID
+		vkUtil::DataBuffer DrawDataBuffer;
+		vkUtil::DrawData* DrawDataWriteLocationPtr{ nullptr };
+		vk::DescriptorBufferInfo DrawDataDescriptorInfo;
+
+		std::int64_t CulledInstanceCount{};
+
+		//shared by the graphics and the culling pipeline
 		vk::DescriptorSet DescriptorSet;
+		//only written again after a buffer was reallocated or the visible index buffer was swapped
+		bool DescriptorSetDirty{ true };
 
-		void CreateDescriptorResources(std::int64_t const& nrWorldMatrices);
+		std::vector<RetiredBuffer> RetiredBufferVec;
 
-		void WriteDescriptorSet();
+		void CreateDescriptorResources(std::int64_t const& nrWorldMatrices, std::int64_t const& nrDrawCommands);
 
-		void CreateDepthResources();
+		//grows the instance buffers geometrically and shrinks them after a sustained drop, returns true when they were reallocated
+		//the old buffers are retired for framesInFlight frames because a frame in flight can still read them
+		bool ResizeInstanceResources(std::int64_t const& instanceCount, int framesInFlight);
+		//grows the draw command buffers geometrically, a mesh adds a command per lod so they only grow with the meshes
+		//returns true when they were reallocated, the old buffers are retired like the instance buffers
+		bool ResizeDrawCommandResources(std::int64_t const& drawCommandCount, int framesInFlight);
+
+		//has to be called once per rendered frame after waiting for its fence
+		void AdvanceRetiredBuffers();
+
+		std::size_t GetInstanceBufferBytes() const;
+
+		//sum of the instance counts the culling pass wrote the last time this frame was rendered
+		std::int64_t ReadVisibleInstanceCount() const;
+		std::int64_t ReadVisibleTriangleCount() const;
+
+		void WriteDescriptorSet();
 
 		void Destroy();
+	private:
+		void CreateInstanceResources(std::int64_t const& instanceCapacity);
+		void RetireInstanceResources(int framesInFlight);
+		void CreateDrawCommandResources(std::int64_t const& drawCommandCapacity);
+		void RetireDrawCommandResources(int framesInFlight);
 	};
 
 }
@@ -0,0 +1,102 @@
+#include "FreeListAllocator.h"
+
+vkUtil::FreeListAllocator::FreeListAllocator(std::uint64_t capacity)
+	: m_Capacity{ capacity }
+	, m_FreeSize{ capacity }
+{
+	if (capacity > 0)
+	{
+		m_FreeBlockMap.emplace(0, capacity);
+	}
+}
+
+std::optional<std::uint64_t> vkUtil::FreeListAllocator::Allocate(std::uint64_t size, std::uint64_t alignment)
+{
+	if (size == 0)
+	{
+		return std::nullopt;
+	}
+	alignment = std::max<std::uint64_t>(alignment, 1);
+
+	for (auto blockIt{ m_FreeBlockMap.begin() }; blockIt != m_FreeBlockMap.end(); ++blockIt)
+	{
+		auto const [blockOffset, blockSize] { *blockIt };
+
+		std::uint64_t const alignedOffset{ (blockOffset + alignment - 1) / alignment * alignment };
+		std::uint64_t const padding{ alignedOffset - blockOffset };
+		if (padding + size > blockSize)
+		{
+			continue;
+		}
+
+		m_FreeBlockMap.erase(blockIt);
+
+		//the padding in front and the rest behind the allocation stay free
+		if (padding > 0)
+		{
+			m_FreeBlockMap.emplace(blockOffset, padding);
+		}
+		std::uint64_t const tailSize{ blockSize - padding - size };
+		if (tailSize > 0)
+		{
+			m_FreeBlockMap.emplace(alignedOffset + size, tailSize);
+		}
+
+		m_FreeSize -= size;
+		return alignedOffset;
+	}
+
+	return std::nullopt;
+}
+
+void vkUtil::FreeListAllocator::Free(std::uint64_t offset, std::uint64_t size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+	m_FreeSize += size;
+
+	auto nextIt{ m_FreeBlockMap.lower_bound(offset) };
+
+	//merge with the block in front
+	if (nextIt != m_FreeBlockMap.begin())
+	{
+		auto previousIt{ std::prev(nextIt) };
+		if (previousIt->first + previousIt->second == offset)
+		{
+			offset = previousIt->first;
+			size += previousIt->second;
+			m_FreeBlockMap.erase(previousIt);
+		}
+	}
+
+	//merge with the block behind
+	if (nextIt != m_FreeBlockMap.end() and offset + size == nextIt->first)
+	{
+		size += nextIt->second;
+		m_FreeBlockMap.erase(nextIt);
+	}
+
+	m_FreeBlockMap.emplace(offset, size);
+}
+
+std::uint64_t vkUtil::FreeListAllocator::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+std::uint64_t vkUtil::FreeListAllocator::GetFreeSize() const
+{
+	return m_FreeSize;
+}
+
+std::uint64_t vkUtil::FreeListAllocator::GetLargestFreeBlock() const
+{
+	std::uint64_t largestBlock{};
+	for (const auto& [blockOffset, blockSize] : m_FreeBlockMap)
+	{
+		largestBlock = std::max(largestBlock, blockSize);
+	}
+	return largestBlock;
+}
@@ -0,0 +1,35 @@
+#ifndef VK_FREE_LIST_ALLOCATOR_H
+#define VK_FREE_LIST_ALLOCATOR_H
+#include "Engine/Configuration.h"
+#include <map>
+
+namespace vkUtil
+{
+
+	//first fit allocator over the offsets [0, capacity), it only hands out offsets and never touches memory itself
+	//neighbouring free blocks are merged again when an allocation is freed
+	class FreeListAllocator final
+	{
+	public:
+		explicit FreeListAllocator(std::uint64_t capacity);
+
+		//alignment does not have to be a power of two, vertex offsets are aligned to the vertex size
+		std::optional<std::uint64_t> Allocate(std::uint64_t size, std::uint64_t alignment);
+
+		//size has to be the size that was passed to Allocate
+		void Free(std::uint64_t offset, std::uint64_t size);
+
+		std::uint64_t GetCapacity() const;
+		std::uint64_t GetFreeSize() const;
+		std::uint64_t GetLargestFreeBlock() const;
+	private:
+		std::uint64_t m_Capacity;
+		std::uint64_t m_FreeSize;
+
+		//offset to size of every free block
+		std::map<std::uint64_t, std::uint64_t> m_FreeBlockMap;
+	};
+
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef VK_HASH_H
+#define VK_HASH_H
+#include "Engine/Configuration.h"
+
+namespace vkUtil
+{
+
+	constexpr std::uint64_t HashSeed{ 14695981039346656037ull };
+
+	//fnv-1a, pass the hash of the previous bytes as the seed to hash several ranges as one
+	inline std::uint64_t HashBytes(void const* dataPtr, std::size_t size, std::uint64_t seed = HashSeed)
+	{
+		std::uint64_t hash{ seed };
+		unsigned char const* bytePtr{ static_cast<unsigned char const*>(dataPtr) };
+		for (std::size_t byteIdx{}; byteIdx < size; ++byteIdx)
+		{
+			hash ^= bytePtr[byteIdx];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	//the size goes in first, so two strings hashed one after the other can not trade characters and keep the hash
+	inline std::uint64_t HashString(std::string const& text, std::uint64_t seed = HashSeed)
+	{
+		std::size_t const size{ text.size() };
+		return HashBytes(text.data(), size, HashBytes(&size, sizeof(std::size_t), seed));
+	}
+
+}
+
+#endif
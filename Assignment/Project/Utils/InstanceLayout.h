@@ -0,0 +1,114 @@
+#ifndef VK_INSTANCE_LAYOUT_H
+#define VK_INSTANCE_LAYOUT_H
+#include "Engine/Configuration.h"
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
+
+namespace vkUtil
+{
+	//how one instance transform is stored in the instance storage buffer, every layout has a matching decode in Shaders/InstanceLayout.glsl
+	template<typename T>
+	concept InstanceLayout = requires(glm::mat4 const& worldMatrix)
+	{
+		typename T::GPUInstance;
+		{ T::Encode(worldMatrix) } -> std::same_as<typename T::GPUInstance>;
+	};
+
+	//full matrix, 64 bytes
+	struct InstanceLayoutMat4
+	{
+		using GPUInstance = glm::mat4;
+
+		static GPUInstance Encode(glm::mat4 const& worldMatrix)
+		{
+			return worldMatrix;
+		}
+	};
+
+	//first three rows of the matrix, the last one is always (0, 0, 0, 1), 48 bytes
+	struct InstanceLayoutAffine
+	{
+		struct GPUInstance
+		{
+			glm::vec4 RowArr[3];
+		};
+
+		static GPUInstance Encode(glm::mat4 const& worldMatrix)
+		{
+			GPUInstance instance{};
+			for (int rowIdx{}; rowIdx < 3; ++rowIdx)
+			{
+				instance.RowArr[rowIdx] = glm::vec4{ worldMatrix[0][rowIdx], worldMatrix[1][rowIdx], worldMatrix[2][rowIdx], worldMatrix[3][rowIdx] };
+			}
+			return instance;
+		}
+	};
+
+	//position + uniform scale and a rotation quaternion, 32 bytes
+	//non uniform scale can not be represented, the length of the first axis is used
+	//a zero scale collapses the instance, it has no rotation left to recover and gets the identity
+	struct InstanceLayoutTRS
+	{
+		struct GPUInstance
+		{
+			glm::vec4 PositionScale;
+			glm::vec4 Rotation;
+		};
+
+		static GPUInstance Encode(glm::mat4 const& worldMatrix)
+		{
+			float const scale{ glm::length(glm::vec3{ worldMatrix[0] }) };
+			glm::quat const rotation{ scale > 0.f ? glm::quat_cast(glm::mat3{ worldMatrix } / scale) : glm::quat{ 1.f, 0.f, 0.f, 0.f } };
+
+			GPUInstance instance{};
+			instance.PositionScale = glm::vec4{ glm::vec3{ worldMatrix[3] }, scale };
+			instance.Rotation = glm::vec4{ rotation.x, rotation.y, rotation.z, rotation.w };
+			return instance;
+		}
+	};
+
+	//same as the TRS layout but position and scale are half floats and the rotation is snorm16, 16 bytes
+	//half floats only have 11 bits of mantissa, beyond 2048 units from the origin positions snap to steps of 2 units or more
+	//the bundled grid scene reaches z = 8910 where the step is 8 units, large scenes need one of the other layouts
+	struct InstanceLayoutHalfTRS
+	{
+		struct GPUInstance
+		{
+			uint32_t PositionXY;
+			uint32_t PositionZScale;
+			uint32_t RotationXY;
+			uint32_t RotationZW;
+		};
+
+		static GPUInstance Encode(glm::mat4 const& worldMatrix)
+		{
+			InstanceLayoutTRS::GPUInstance const trs{ InstanceLayoutTRS::Encode(worldMatrix) };
+
+			GPUInstance instance{};
+			instance.PositionXY = glm::packHalf2x16(glm::vec2{ trs.PositionScale.x, trs.PositionScale.y });
+			instance.PositionZScale = glm::packHalf2x16(glm::vec2{ trs.PositionScale.z, trs.PositionScale.w });
+			instance.RotationXY = glm::packSnorm2x16(glm::vec2{ trs.Rotation.x, trs.Rotation.y });
+			instance.RotationZW = glm::packSnorm2x16(glm::vec2{ trs.Rotation.z, trs.Rotation.w });
+			return instance;
+		}
+	};
+
+	static_assert(sizeof(InstanceLayoutMat4::GPUInstance) == 64);
+	static_assert(sizeof(InstanceLayoutAffine::GPUInstance) == 48);
+	static_assert(sizeof(InstanceLayoutTRS::GPUInstance) == 32);
+	static_assert(sizeof(InstanceLayoutHalfTRS::GPUInstance) == 16);
+
+	//picked by the AVE_INSTANCE_LAYOUT cmake option, the shaders are compiled with the same define
+#if defined(AVE_INSTANCE_LAYOUT_AFFINE)
+	using DefaultInstanceLayout = InstanceLayoutAffine;
+#elif defined(AVE_INSTANCE_LAYOUT_TRS)
+	using DefaultInstanceLayout = InstanceLayoutTRS;
+#elif defined(AVE_INSTANCE_LAYOUT_HALFTRS)
+	using DefaultInstanceLayout = InstanceLayoutHalfTRS;
+#else
+	using DefaultInstanceLayout = InstanceLayoutMat4;
+#endif
+
+}
+
+#endif
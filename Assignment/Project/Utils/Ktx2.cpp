@@ -0,0 +1,301 @@
+#include "Ktx2.h"
+#include "Utils/BlockCompression.h"
+#include "Utils/CookedAsset.h"
+#include "Utils/MappedFile.h"
+#include <cstring>
+#include <filesystem>
+
+#if defined(AVE_ENABLE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace
+{
+	//«KTX 20»\r\n\x1A\n
+	constexpr std::array<unsigned char, 12> Ktx2Identifier{ 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	//the header and the index that follows it, every field is little endian
+	struct Ktx2Header
+	{
+		std::array<unsigned char, 12> Identifier;
+		uint32_t VkFormat;
+		uint32_t TypeSize;
+		uint32_t PixelWidth;
+		uint32_t PixelHeight;
+		uint32_t PixelDepth;
+		uint32_t LayerCount;
+		uint32_t FaceCount;
+		uint32_t LevelCount;
+		uint32_t SupercompressionScheme;
+		uint32_t DfdByteOffset;
+		uint32_t DfdByteLength;
+		uint32_t KvdByteOffset;
+		uint32_t KvdByteLength;
+		std::uint64_t SgdByteOffset;
+		std::uint64_t SgdByteLength;
+	};
+	static_assert(sizeof(Ktx2Header) == 80);
+
+	//one entry per level right after the header, the full resolution level first
+	struct Ktx2Level
+	{
+		std::uint64_t ByteOffset;
+		std::uint64_t ByteLength;
+		std::uint64_t UncompressedByteLength;
+	};
+
+	//data format descriptor values of the khronos data format specification
+	constexpr uint32_t DfdModelBC1A{ 128 };
+	constexpr uint32_t DfdModelBC7{ 135 };
+	constexpr uint32_t DfdPrimariesBT709{ 1 };
+	constexpr uint32_t DfdTransferLinear{ 1 };
+
+	//cooking is offline, so the level is traded for size, decoding is as fast at any level
+	constexpr int ZstdLevel{ 19 };
+
+	//decompresses a level into the end of the vector, false when the level is damaged or the scheme is not built in
+	bool AppendLevel(std::span<std::byte const> levelSpan, std::uint64_t uncompressedSize, vkUtil::Ktx2Supercompression supercompression, std::vector<unsigned char>& levelVec)
+	{
+		std::size_t const levelOffset{ levelVec.size() };
+		levelVec.resize(levelOffset + static_cast<std::size_t>(uncompressedSize));
+
+		if (supercompression == vkUtil::Ktx2Supercompression::None)
+		{
+			if (levelSpan.size() != uncompressedSize)
+			{
+				return false;
+			}
+			std::memcpy(levelVec.data() + levelOffset, levelSpan.data(), levelSpan.size());
+			return true;
+		}
+
+#if defined(AVE_ENABLE_ZSTD)
+		if (supercompression == vkUtil::Ktx2Supercompression::Zstandard)
+		{
+			std::size_t const decompressedSize{ ZSTD_decompress(levelVec.data() + levelOffset, static_cast<std::size_t>(uncompressedSize), levelSpan.data(), levelSpan.size()) };
+			return not ZSTD_isError(decompressedSize) and decompressedSize == uncompressedSize;
+		}
+#endif
+		return false;
+	}
+}
+
+std::string vkUtil::GetKtx2FileName(std::string const& sourceFileName)
+{
+	return sourceFileName + ".ktx2";
+}
+
+bool vkUtil::IsKtx2Current(std::string const& ktx2FileName, std::string const& sourceFileName)
+{
+	std::error_code errorCode{};
+	if (not std::filesystem::exists(ktx2FileName, errorCode))
+	{
+		return false;
+	}
+	if (not std::filesystem::exists(sourceFileName, errorCode))
+	{
+		return true;
+	}
+
+	auto const sourceWriteTime{ std::filesystem::last_write_time(sourceFileName, errorCode) };
+	auto const ktx2WriteTime{ std::filesystem::last_write_time(ktx2FileName, errorCode) };
+	return not errorCode and sourceWriteTime <= ktx2WriteTime;
+}
+
+std::optional<vkUtil::Ktx2Texture> vkUtil::ReadKtx2(std::string const& fileName)
+{
+	MappedFile const file{ fileName };
+	std::span<std::byte const> const data{ file.GetData() };
+	if (data.size() < sizeof(Ktx2Header))
+	{
+		return std::nullopt;
+	}
+
+	Ktx2Header header{};
+	std::memcpy(&header, data.data(), sizeof(Ktx2Header));
+	if (header.Identifier != Ktx2Identifier)
+	{
+		return std::nullopt;
+	}
+
+	//only plain 2d textures, the layer count of a texture that is no array is 0
+	if (header.PixelWidth == 0 or header.PixelHeight == 0 or header.PixelDepth != 0 or header.LayerCount > 1 or header.FaceCount != 1)
+	{
+		std::cout << "Texture " << fileName << " is no 2d texture\n";
+		return std::nullopt;
+	}
+
+	Ktx2Texture texture{};
+	texture.Format = static_cast<vk::Format>(header.VkFormat);
+	texture.Width = header.PixelWidth;
+	texture.Height = header.PixelHeight;
+	//a level count of 0 asks for the levels to be generated at load, only the full resolution one is stored
+	//block compressed levels can not be generated on the gpu, so such a texture is loaded with that one level only
+	texture.MipLevels = std::max(header.LevelCount, 1u);
+	//more levels than down to 1x1 would shift the extent by the bit width or more
+	if (texture.MipLevels > GetMipLevelCount(texture.Width, texture.Height))
+	{
+		std::cout << "Texture " << fileName << " has " << header.LevelCount << " levels, more than its extent allows\n";
+		return std::nullopt;
+	}
+
+	std::optional<FormatBlock> const block{ GetFormatBlock(texture.Format) };
+	if (not block)
+	{
+		std::cout << "Texture " << fileName << " has unsupported format " << header.VkFormat << "\n";
+		return std::nullopt;
+	}
+
+	auto const supercompression{ static_cast<Ktx2Supercompression>(header.SupercompressionScheme) };
+	if (supercompression != Ktx2Supercompression::None
+#if defined(AVE_ENABLE_ZSTD)
+		and supercompression != Ktx2Supercompression::Zstandard
+#endif
+		)
+	{
+		std::cout << "Texture " << fileName << " uses supercompression scheme " << header.SupercompressionScheme << " which this build can not decode\n";
+		return std::nullopt;
+	}
+
+	std::uint64_t const levelIndexEnd{ sizeof(Ktx2Header) + static_cast<std::uint64_t>(texture.MipLevels) * sizeof(Ktx2Level) };
+	if (levelIndexEnd > data.size())
+	{
+		return std::nullopt;
+	}
+
+	texture.LevelVec.reserve(static_cast<std::size_t>(GetMipChainSize(*block, texture.Width, texture.Height, texture.MipLevels)));
+	for (uint32_t mipLevel{}; mipLevel < texture.MipLevels; ++mipLevel)
+	{
+		Ktx2Level level{};
+		std::memcpy(&level, data.data() + sizeof(Ktx2Header) + mipLevel * sizeof(Ktx2Level), sizeof(Ktx2Level));
+
+		std::uint64_t const levelSize{ GetLevelSize(*block, std::max(texture.Width >> mipLevel, 1u), std::max(texture.Height >> mipLevel, 1u)) };
+		if (level.UncompressedByteLength != levelSize or level.ByteOffset > data.size() or level.ByteLength > data.size() - level.ByteOffset)
+		{
+			return std::nullopt;
+		}
+
+		if (not AppendLevel(data.subspan(static_cast<std::size_t>(level.ByteOffset), static_cast<std::size_t>(level.ByteLength)), levelSize, supercompression, texture.LevelVec))
+		{
+			std::cout << "Texture " << fileName << " has a damaged level " << mipLevel << "\n";
+			return std::nullopt;
+		}
+	}
+	return texture;
+}
+
+bool vkUtil::WriteKtx2(std::string const& fileName, vk::Format format, uint32_t width, uint32_t height, uint32_t mipLevels, std::span<unsigned char const> levelSpan, Ktx2Supercompression supercompression)
+{
+	bool const isBC1{ format == vk::Format::eBc1RgbUnormBlock or format == vk::Format::eBc1RgbaUnormBlock };
+	std::optional<FormatBlock> const block{ GetFormatBlock(format) };
+	if (not block or (not isBC1 and format != vk::Format::eBc7UnormBlock) or levelSpan.size() != GetMipChainSize(*block, width, height, mipLevels))
+	{
+		return false;
+	}
+
+#if not defined(AVE_ENABLE_ZSTD)
+	supercompression = Ktx2Supercompression::None;
+#endif
+	if (supercompression != Ktx2Supercompression::None and supercompression != Ktx2Supercompression::Zstandard)
+	{
+		return false;
+	}
+
+	//the basic descriptor block, one sample covering the whole 4x4 block
+	std::array<uint32_t, 11> const dfdArr
+	{
+		static_cast<uint32_t>(sizeof(uint32_t) * 11),
+		0u,
+		2u | ((6u * 4u + 16u) << 16),
+		(isBC1 ? DfdModelBC1A : DfdModelBC7) | (DfdPrimariesBT709 << 8) | (DfdTransferLinear << 16),
+		(block->Width - 1) | ((block->Height - 1) << 8),
+		block->Size,
+		0u,
+		(block->Size * 8 - 1) << 16,
+		0u,
+		0u,
+		0xFFFFFFFFu
+	};
+
+	//every level is supercompressed on its own so the reader can stop at any of them
+	std::vector<std::vector<unsigned char>> levelDataVec(mipLevels);
+	std::vector<Ktx2Level> levelIndexVec(mipLevels);
+	std::size_t levelOffset{};
+	for (uint32_t mipLevel{}; mipLevel < mipLevels; ++mipLevel)
+	{
+		std::size_t const levelSize{ static_cast<std::size_t>(GetLevelSize(*block, std::max(width >> mipLevel, 1u), std::max(height >> mipLevel, 1u))) };
+		std::span<unsigned char const> const level{ levelSpan.subspan(levelOffset, levelSize) };
+		levelOffset += levelSize;
+
+		levelIndexVec[mipLevel].UncompressedByteLength = levelSize;
+#if defined(AVE_ENABLE_ZSTD)
+		if (supercompression == Ktx2Supercompression::Zstandard)
+		{
+			std::vector<unsigned char>& compressedVec{ levelDataVec[mipLevel] };
+			compressedVec.resize(ZSTD_compressBound(levelSize));
+			std::size_t const compressedSize{ ZSTD_compress(compressedVec.data(), compressedVec.size(), level.data(), level.size(), ZstdLevel) };
+			if (ZSTD_isError(compressedSize))
+			{
+				return false;
+			}
+			compressedVec.resize(compressedSize);
+			continue;
+		}
+#endif
+		levelDataVec[mipLevel].assign(level.begin(), level.end());
+	}
+
+	Ktx2Header header{};
+	header.Identifier = Ktx2Identifier;
+	header.VkFormat = static_cast<uint32_t>(format);
+	//block compressed formats have no type
+	header.TypeSize = 1;
+	header.PixelWidth = width;
+	header.PixelHeight = height;
+	header.FaceCount = 1;
+	header.LevelCount = mipLevels;
+	header.SupercompressionScheme = static_cast<uint32_t>(supercompression);
+	header.DfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + sizeof(Ktx2Level) * mipLevels);
+	header.DfdByteLength = static_cast<uint32_t>(sizeof(dfdArr));
+
+	//the smallest level comes first, without supercompression every level is aligned to a block
+	std::uint64_t const alignment{ supercompression == Ktx2Supercompression::None ? block->Size : 1u };
+	std::uint64_t offset{ header.DfdByteOffset + header.DfdByteLength };
+	for (uint32_t mipLevel{ mipLevels }; mipLevel-- > 0;)
+	{
+		offset = (offset + alignment - 1) / alignment * alignment;
+		levelIndexVec[mipLevel].ByteOffset = offset;
+		levelIndexVec[mipLevel].ByteLength = levelDataVec[mipLevel].size();
+		offset += levelDataVec[mipLevel].size();
+	}
+
+	//written next to the old file and swapped in like the cooked assets
+	std::string const tempFileName{ fileName + ".tmp" };
+	{
+		std::ofstream file{ tempFileName, std::ios::binary | std::ios::trunc };
+		if (not file)
+		{
+			return false;
+		}
+
+		file.write(reinterpret_cast<char const*>(&header), sizeof(Ktx2Header));
+		file.write(reinterpret_cast<char const*>(levelIndexVec.data()), static_cast<std::streamsize>(sizeof(Ktx2Level) * levelIndexVec.size()));
+		file.write(reinterpret_cast<char const*>(dfdArr.data()), sizeof(dfdArr));
+
+		char const padding[16]{};
+		for (uint32_t mipLevel{ mipLevels }; mipLevel-- > 0;)
+		{
+			file.write(padding, static_cast<std::streamsize>(levelIndexVec[mipLevel].ByteOffset - static_cast<std::uint64_t>(file.tellp())));
+			file.write(reinterpret_cast<char const*>(levelDataVec[mipLevel].data()), static_cast<std::streamsize>(levelDataVec[mipLevel].size()));
+		}
+
+		if (not file)
+		{
+			return false;
+		}
+	}
+
+	std::error_code errorCode{};
+	std::filesystem::rename(tempFileName, fileName, errorCode);
+	return not errorCode;
+}
@@ -0,0 +1,45 @@
+#ifndef VK_KTX2_H
+#define VK_KTX2_H
+#include "Engine/Configuration.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	//how the levels of a ktx2 file are compressed on top of their format
+	enum class Ktx2Supercompression : uint32_t
+	{
+		None = 0,
+		BasisLZ = 1,
+		//only read and written when the build has AVE_ENABLE_ZSTD
+		Zstandard = 2,
+		ZLib = 3
+	};
+
+	//a 2d texture read from a ktx2 file, the levels are decompressed and packed from the full resolution one down
+	struct Ktx2Texture
+	{
+		vk::Format Format{ vk::Format::eUndefined };
+		uint32_t Width{};
+		uint32_t Height{};
+		uint32_t MipLevels{ 1 };
+		std::vector<unsigned char> LevelVec;
+	};
+
+	//the block compressed version lives next to its source, "Resources/ferrari.png" becomes "Resources/ferrari.png.ktx2"
+	std::string GetKtx2FileName(std::string const& sourceFileName);
+
+	//the file is current when it was written after its source, a missing source is fine
+	bool IsKtx2Current(std::string const& ktx2FileName, std::string const& sourceFileName);
+
+	//empty for a missing or malformed file, for arrays, cube maps and 3d textures, for formats GetFormatBlock does not know
+	//and for supercompression this build can not decode
+	std::optional<Ktx2Texture> ReadKtx2(std::string const& fileName);
+
+	//writes a bc1 or bc7 mip chain packed from the full resolution level down, every level is supercompressed on its own
+	//falls back to no supercompression when the build has no zstd
+	bool WriteKtx2(std::string const& fileName, vk::Format format, uint32_t width, uint32_t height, uint32_t mipLevels, std::span<unsigned char const> levelSpan, Ktx2Supercompression supercompression);
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+vkUtil::MappedFile::MappedFile(std::string const& fileName)
+{
+	HANDLE const fileHandle{ CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	m_FileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize{};
+	if (not GetFileSizeEx(fileHandle, &fileSize) or fileSize.QuadPart == 0)
+	{
+		return;
+	}
+
+	m_MappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_MappingHandle == nullptr)
+	{
+		return;
+	}
+
+	m_DataPtr = static_cast<std::byte const*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (m_DataPtr != nullptr)
+	{
+		m_Size = static_cast<std::size_t>(fileSize.QuadPart);
+	}
+}
+
+vkUtil::MappedFile::~MappedFile()
+{
+	if (m_DataPtr != nullptr)
+	{
+		UnmapViewOfFile(m_DataPtr);
+	}
+	if (m_MappingHandle != nullptr)
+	{
+		CloseHandle(m_MappingHandle);
+	}
+	if (m_FileHandle != nullptr)
+	{
+		CloseHandle(m_FileHandle);
+	}
+}
+
+#else
+
+vkUtil::MappedFile::MappedFile(std::string const& fileName)
+{
+	int const fileDescriptor{ open(fileName.c_str(), O_RDONLY) };
+	if (fileDescriptor < 0)
+	{
+		return;
+	}
+
+	struct stat fileStat{};
+	if (fstat(fileDescriptor, &fileStat) == 0 and fileStat.st_size > 0)
+	{
+		void* const mappedPtr{ mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0) };
+		if (mappedPtr != MAP_FAILED)
+		{
+			m_DataPtr = static_cast<std::byte const*>(mappedPtr);
+			m_Size = static_cast<std::size_t>(fileStat.st_size);
+
+			//the data is read front to back once, straight into staging memory
+			madvise(mappedPtr, m_Size, MADV_SEQUENTIAL);
+		}
+	}
+
+	//the mapping keeps its own reference to the file
+	close(fileDescriptor);
+}
+
+vkUtil::MappedFile::~MappedFile()
+{
+	if (m_DataPtr != nullptr)
+	{
+		munmap(const_cast<std::byte*>(m_DataPtr), m_Size);
+	}
+}
+
+#endif
+
+bool vkUtil::MappedFile::IsOpen() const
+{
+	return m_DataPtr != nullptr;
+}
+
+std::span<std::byte const> vkUtil::MappedFile::GetData() const
+{
+	return std::span<std::byte const>{ m_DataPtr, m_Size };
+}
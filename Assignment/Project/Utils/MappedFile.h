@@ -0,0 +1,37 @@
+#ifndef VK_MAPPED_FILE_H
+#define VK_MAPPED_FILE_H
+#include "Engine/Configuration.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	//read only view of a whole file through the page cache, nothing is read until a page is touched
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(std::string const& fileName);
+		~MappedFile();
+
+		MappedFile(MappedFile const& other) = delete;
+		MappedFile(MappedFile&& other) = delete;
+		MappedFile& operator=(MappedFile const& other) = delete;
+		MappedFile& operator=(MappedFile&& other) = delete;
+
+		//false for a missing or empty file
+		bool IsOpen() const;
+
+		std::span<std::byte const> GetData() const;
+	private:
+		std::byte const* m_DataPtr{ nullptr };
+		std::size_t m_Size{};
+
+#if defined(_WIN32)
+		void* m_FileHandle{ nullptr };
+		void* m_MappingHandle{ nullptr };
+#endif
+	};
+
+}
+
+#endif
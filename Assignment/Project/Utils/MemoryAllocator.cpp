@@ -0,0 +1,363 @@
+#include "MemoryAllocator.h"
+
+void vkUtil::MemoryAllocator::Initialize(vk::Device const& device, vk::PhysicalDevice const& physicalDevice)
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	m_Device = device;
+	m_MemoryProperties = physicalDevice.getMemoryProperties();
+	m_BufferImageGranularity = physicalDevice.getProperties().limits.bufferImageGranularity;
+
+	m_HeapStatisticsVec.clear();
+	m_HeapStatisticsVec.resize(m_MemoryProperties.memoryHeapCount);
+	for (uint32_t heapIdx{}; heapIdx < m_MemoryProperties.memoryHeapCount; ++heapIdx)
+	{
+		m_HeapStatisticsVec[heapIdx].Flags = m_MemoryProperties.memoryHeaps[heapIdx].flags;
+		m_HeapStatisticsVec[heapIdx].HeapSize = m_MemoryProperties.memoryHeaps[heapIdx].size;
+	}
+}
+
+void vkUtil::MemoryAllocator::Destroy()
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	for (auto const& heapStatistics : m_HeapStatisticsVec)
+	{
+		if (heapStatistics.AllocationCount > 0)
+		{
+			std::cout << "Memory allocator destroyed with " << heapStatistics.AllocationCount << " live allocations\n";
+		}
+	}
+
+	for (auto& block : m_BlockVec)
+	{
+		if (block.Memory)
+		{
+			m_Device.freeMemory(block.Memory);
+		}
+	}
+
+	m_BlockVec.clear();
+	m_HeapStatisticsVec.clear();
+	m_Device = nullptr;
+}
+
+vkUtil::MemoryAllocation vkUtil::MemoryAllocator::Allocate(vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags propertyFlags, ResourceTiling tiling)
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	return AllocateLocked(requirements, propertyFlags, tiling, nullptr);
+}
+
+vkUtil::MemoryAllocation vkUtil::MemoryAllocator::AllocateForBuffer(vk::Buffer const& buffer, vk::MemoryPropertyFlags propertyFlags)
+{
+	vk::BufferMemoryRequirementsInfo2 requirementsInfo{};
+	requirementsInfo.buffer = buffer;
+
+	auto const requirementsChain{ m_Device.getBufferMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(requirementsInfo) };
+	vk::MemoryDedicatedRequirements const& dedicatedRequirements{ requirementsChain.get<vk::MemoryDedicatedRequirements>() };
+
+	vk::MemoryDedicatedAllocateInfo dedicatedInfo{};
+	dedicatedInfo.buffer = buffer;
+	bool const dedicated{ dedicatedRequirements.prefersDedicatedAllocation or dedicatedRequirements.requiresDedicatedAllocation };
+
+	MemoryAllocation allocation{};
+	{
+		std::scoped_lock lock{ m_Mutex };
+		allocation = AllocateLocked(requirementsChain.get<vk::MemoryRequirements2>().memoryRequirements, propertyFlags, ResourceTiling::Linear, dedicated ? &dedicatedInfo : nullptr);
+	}
+
+	if (allocation.Memory)
+	{
+		m_Device.bindBufferMemory(buffer, allocation.Memory, allocation.Offset);
+	}
+	return allocation;
+}
+
+vkUtil::MemoryAllocation vkUtil::MemoryAllocator::AllocateForImage(vk::Image const& image, vk::MemoryPropertyFlags propertyFlags, vk::ImageTiling tiling)
+{
+	vk::ImageMemoryRequirementsInfo2 requirementsInfo{};
+	requirementsInfo.image = image;
+
+	auto const requirementsChain{ m_Device.getImageMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(requirementsInfo) };
+	vk::MemoryDedicatedRequirements const& dedicatedRequirements{ requirementsChain.get<vk::MemoryDedicatedRequirements>() };
+
+	vk::MemoryDedicatedAllocateInfo dedicatedInfo{};
+	dedicatedInfo.image = image;
+	bool const dedicated{ dedicatedRequirements.prefersDedicatedAllocation or dedicatedRequirements.requiresDedicatedAllocation };
+
+	ResourceTiling const resourceTiling{ tiling == vk::ImageTiling::eLinear ? ResourceTiling::Linear : ResourceTiling::Optimal };
+
+	MemoryAllocation allocation{};
+	{
+		std::scoped_lock lock{ m_Mutex };
+		allocation = AllocateLocked(requirementsChain.get<vk::MemoryRequirements2>().memoryRequirements, propertyFlags, resourceTiling, dedicated ? &dedicatedInfo : nullptr);
+	}
+
+	if (allocation.Memory)
+	{
+		m_Device.bindImageMemory(image, allocation.Memory, allocation.Offset);
+	}
+	return allocation;
+}
+
+void vkUtil::MemoryAllocator::Free(MemoryAllocation const& allocation)
+{
+	if (not allocation.Memory)
+	{
+		return;
+	}
+
+	std::scoped_lock lock{ m_Mutex };
+
+	MemoryHeapStatistics& heapStatistics{ GetHeapStatistics(allocation.MemoryTypeIdx) };
+	heapStatistics.UsedBytes -= allocation.Size;
+	--heapStatistics.AllocationCount;
+
+	if (allocation.BlockIdx < 0)
+	{
+		heapStatistics.AllocatedBytes -= allocation.Size;
+		--heapStatistics.DedicatedAllocationCount;
+		m_Device.freeMemory(allocation.Memory);
+		return;
+	}
+
+	MemoryBlock& block{ m_BlockVec[allocation.BlockIdx] };
+	block.AllocatorUPtr->Free(allocation.Offset);
+
+	if (block.AllocatorUPtr->GetAllocationCount() > 0)
+	{
+		return;
+	}
+
+	//one empty block per memory type is kept around so short lived staging buffers do not allocate a block every time
+	bool const otherBlockExists{ std::ranges::any_of(m_BlockVec,
+		[&](MemoryBlock const& otherBlock)
+		{
+			return &otherBlock != &block and otherBlock.Memory
+				and otherBlock.MemoryTypeIdx == block.MemoryTypeIdx and otherBlock.Tiling == block.Tiling;
+		}) };
+
+	if (otherBlockExists)
+	{
+		ReleaseBlock(allocation.BlockIdx);
+	}
+}
+
+std::vector<vkUtil::MemoryHeapStatistics> vkUtil::MemoryAllocator::GetHeapStatistics() const
+{
+	std::scoped_lock lock{ m_Mutex };
+
+	return m_HeapStatisticsVec;
+}
+
+void vkUtil::MemoryAllocator::PrintHeapStatistics() const
+{
+	std::vector<MemoryHeapStatistics> const heapStatisticsVec{ GetHeapStatistics() };
+
+	constexpr double megaByte{ 1024.0 * 1024.0 };
+	for (std::size_t heapIdx{}; heapIdx < heapStatisticsVec.size(); ++heapIdx)
+	{
+		MemoryHeapStatistics const& heapStatistics{ heapStatisticsVec[heapIdx] };
+		std::cout << "Heap " << heapIdx << (heapStatistics.Flags & vk::MemoryHeapFlagBits::eDeviceLocal ? " (device local)" : "")
+			<< ": " << heapStatistics.UsedBytes / megaByte << " MB used of " << heapStatistics.AllocatedBytes / megaByte << " MB allocated"
+			<< ", heap size " << heapStatistics.HeapSize / megaByte << " MB"
+			<< ", " << heapStatistics.AllocationCount << " allocations in " << heapStatistics.BlockCount << " blocks"
+			<< " + " << heapStatistics.DedicatedAllocationCount << " dedicated\n";
+	}
+}
+
+std::optional<uint32_t> vkUtil::MemoryAllocator::FindMemoryTypeIndex(uint32_t supportedMemoryIndices, vk::MemoryPropertyFlags requestedProperties) const
+{
+	for (uint32_t idx{}; idx < m_MemoryProperties.memoryTypeCount; idx++)
+	{
+		bool supported{ static_cast<bool>(supportedMemoryIndices & (1 << idx)) };
+
+		bool sufficient{ (m_MemoryProperties.memoryTypes[idx].propertyFlags & requestedProperties) == requestedProperties };
+
+		if (supported and sufficient)
+		{
+			return idx;
+		}
+	}
+
+	return std::nullopt;
+}
+
+bool vkUtil::MemoryAllocator::IsHostVisible(uint32_t memoryTypeIdx) const
+{
+	return static_cast<bool>(m_MemoryProperties.memoryTypes[memoryTypeIdx].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible);
+}
+
+vkUtil::MemoryHeapStatistics& vkUtil::MemoryAllocator::GetHeapStatistics(uint32_t memoryTypeIdx)
+{
+	return m_HeapStatisticsVec[m_MemoryProperties.memoryTypes[memoryTypeIdx].heapIndex];
+}
+
+vkUtil::MemoryAllocation vkUtil::MemoryAllocator::AllocateLocked(vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags propertyFlags, ResourceTiling tiling, vk::MemoryDedicatedAllocateInfo const* dedicatedInfoPtr)
+{
+	std::optional<uint32_t> const memoryTypeIdx{ FindMemoryTypeIndex(requirements.memoryTypeBits, propertyFlags) };
+	if (not memoryTypeIdx)
+	{
+		std::cout << "No memory type with the requested properties\n";
+		return MemoryAllocation{};
+	}
+
+	if (dedicatedInfoPtr or requirements.size >= m_DedicatedThreshold)
+	{
+		return AllocateDedicated(requirements, *memoryTypeIdx, dedicatedInfoPtr);
+	}
+
+	//when no block can be created anymore the smaller dedicated allocation might still fit
+	std::optional<MemoryAllocation> const allocation{ AllocateFromBlocks(requirements, *memoryTypeIdx, tiling) };
+	if (allocation)
+	{
+		return *allocation;
+	}
+	return AllocateDedicated(requirements, *memoryTypeIdx, nullptr);
+}
+
+vkUtil::MemoryAllocation vkUtil::MemoryAllocator::AllocateDedicated(vk::MemoryRequirements const& requirements, uint32_t memoryTypeIdx, vk::MemoryDedicatedAllocateInfo const* dedicatedInfoPtr)
+{
+	vk::MemoryAllocateInfo allocateInfo{};
+	allocateInfo.allocationSize = requirements.size;
+	allocateInfo.memoryTypeIndex = memoryTypeIdx;
+	allocateInfo.pNext = dedicatedInfoPtr;
+
+	MemoryAllocation allocation{};
+	try
+	{
+		allocation.Memory = m_Device.allocateMemory(allocateInfo);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+		return MemoryAllocation{};
+	}
+
+	allocation.Offset = 0;
+	allocation.Size = requirements.size;
+	allocation.MemoryTypeIdx = memoryTypeIdx;
+	allocation.BlockIdx = -1;
+	if (IsHostVisible(memoryTypeIdx))
+	{
+		allocation.MappedPtr = m_Device.mapMemory(allocation.Memory, 0, VK_WHOLE_SIZE);
+	}
+
+	MemoryHeapStatistics& heapStatistics{ GetHeapStatistics(memoryTypeIdx) };
+	heapStatistics.AllocatedBytes += allocation.Size;
+	heapStatistics.UsedBytes += allocation.Size;
+	++heapStatistics.DedicatedAllocationCount;
+	++heapStatistics.AllocationCount;
+
+	return allocation;
+}
+
+std::optional<vkUtil::MemoryAllocation> vkUtil::MemoryAllocator::AllocateFromBlocks(vk::MemoryRequirements const& requirements, uint32_t memoryTypeIdx, ResourceTiling tiling)
+{
+	//without a granularity restriction linear and optimal resources can sit next to each other
+	ResourceTiling const blockTiling{ m_BufferImageGranularity > 1 ? tiling : ResourceTiling::Linear };
+
+	auto const allocateFromBlock{ [&](std::int32_t blockIdx) -> std::optional<MemoryAllocation>
+		{
+			MemoryBlock& block{ m_BlockVec[blockIdx] };
+			std::optional<std::uint64_t> const offset{ block.AllocatorUPtr->Allocate(requirements.size, requirements.alignment) };
+			if (not offset)
+			{
+				return std::nullopt;
+			}
+
+			MemoryAllocation allocation{};
+			allocation.Memory = block.Memory;
+			allocation.Offset = *offset;
+			allocation.Size = requirements.size;
+			allocation.MappedPtr = block.MappedPtr ? block.MappedPtr + *offset : nullptr;
+			allocation.MemoryTypeIdx = memoryTypeIdx;
+			allocation.BlockIdx = blockIdx;
+
+			MemoryHeapStatistics& heapStatistics{ GetHeapStatistics(memoryTypeIdx) };
+			heapStatistics.UsedBytes += allocation.Size;
+			++heapStatistics.AllocationCount;
+
+			return allocation;
+		} };
+
+	for (std::int32_t blockIdx{}; blockIdx < std::ssize(m_BlockVec); ++blockIdx)
+	{
+		MemoryBlock const& block{ m_BlockVec[blockIdx] };
+		if (not block.Memory or block.MemoryTypeIdx != memoryTypeIdx or block.Tiling != blockTiling)
+		{
+			continue;
+		}
+
+		std::optional<MemoryAllocation> const allocation{ allocateFromBlock(blockIdx) };
+		if (allocation)
+		{
+			return allocation;
+		}
+	}
+
+	std::optional<std::int32_t> const blockIdx{ CreateBlock(memoryTypeIdx, blockTiling) };
+	if (not blockIdx)
+	{
+		return std::nullopt;
+	}
+	return allocateFromBlock(*blockIdx);
+}
+
+std::optional<std::int32_t> vkUtil::MemoryAllocator::CreateBlock(uint32_t memoryTypeIdx, ResourceTiling tiling)
+{
+	vk::MemoryAllocateInfo allocateInfo{};
+	allocateInfo.allocationSize = m_BlockSize;
+	allocateInfo.memoryTypeIndex = memoryTypeIdx;
+
+	MemoryBlock block{};
+	try
+	{
+		block.Memory = m_Device.allocateMemory(allocateInfo);
+	}
+	catch (const vk::SystemError& systemError)
+	{
+		std::cout << systemError.what() << "\n";
+		return std::nullopt;
+	}
+
+	block.MemoryTypeIdx = memoryTypeIdx;
+	block.Tiling = tiling;
+	block.AllocatorUPtr = std::make_unique<TlsfAllocator>(m_BlockSize);
+	if (IsHostVisible(memoryTypeIdx))
+	{
+		block.MappedPtr = static_cast<char*>(m_Device.mapMemory(block.Memory, 0, VK_WHOLE_SIZE));
+	}
+
+	MemoryHeapStatistics& heapStatistics{ GetHeapStatistics(memoryTypeIdx) };
+	heapStatistics.AllocatedBytes += m_BlockSize;
+	++heapStatistics.BlockCount;
+
+	auto const emptySlotIt{ std::ranges::find_if(m_BlockVec,
+		[](MemoryBlock const& slot)
+		{
+			return not slot.Memory;
+		}) };
+
+	if (emptySlotIt != m_BlockVec.end())
+	{
+		*emptySlotIt = std::move(block);
+		return static_cast<std::int32_t>(emptySlotIt - m_BlockVec.begin());
+	}
+
+	m_BlockVec.emplace_back(std::move(block));
+	return static_cast<std::int32_t>(m_BlockVec.size() - 1);
+}
+
+void vkUtil::MemoryAllocator::ReleaseBlock(std::int32_t blockIdx)
+{
+	MemoryBlock& block{ m_BlockVec[blockIdx] };
+
+	MemoryHeapStatistics& heapStatistics{ GetHeapStatistics(block.MemoryTypeIdx) };
+	heapStatistics.AllocatedBytes -= m_BlockSize;
+	--heapStatistics.BlockCount;
+
+	m_Device.freeMemory(block.Memory);
+	block = MemoryBlock{};
+}
@@ -0,0 +1,105 @@
+#ifndef VK_MEMORY_ALLOCATOR_H
+#define VK_MEMORY_ALLOCATOR_H
+#include "Engine/Configuration.h"
+#include "Engine/Singleton.h"
+#include "Utils/TlsfAllocator.h"
+#include <mutex>
+
+namespace vkUtil
+{
+
+	//linear and optimal resources only share a block when the device has no bufferImageGranularity restriction
+	enum class ResourceTiling
+	{
+		Linear,
+		Optimal
+	};
+
+	struct MemoryAllocation
+	{
+		vk::DeviceMemory Memory;
+		vk::DeviceSize Offset{};
+		vk::DeviceSize Size{};
+		//already offset to the start of the allocation, null when the memory is not host visible
+		void* MappedPtr{ nullptr };
+		uint32_t MemoryTypeIdx{};
+		//-1 when the allocation owns its device memory
+		std::int32_t BlockIdx{ -1 };
+	};
+
+	struct MemoryHeapStatistics
+	{
+		vk::MemoryHeapFlags Flags;
+		vk::DeviceSize HeapSize{};
+		//device memory taken from the heap by blocks and dedicated allocations
+		vk::DeviceSize AllocatedBytes{};
+		//part of the allocated bytes handed out to resources
+		vk::DeviceSize UsedBytes{};
+		std::int64_t BlockCount{};
+		std::int64_t DedicatedAllocationCount{};
+		std::int64_t AllocationCount{};
+	};
+
+	//hands out ranges of large device memory blocks instead of one allocateMemory per resource
+	//every block belongs to one memory type and is split with a tlsf allocator, host visible blocks stay mapped
+	class MemoryAllocator final : public ave::Singleton<MemoryAllocator>
+	{
+	public:
+		void Initialize(vk::Device const& device, vk::PhysicalDevice const& physicalDevice);
+
+		//frees every block, all resources allocated from it have to be destroyed before
+		void Destroy();
+
+		//returns an empty allocation when the memory could not be allocated
+		MemoryAllocation Allocate(vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags propertyFlags, ResourceTiling tiling);
+
+		//allocate and bind, resources the driver prefers to own their memory get a dedicated allocation
+		MemoryAllocation AllocateForBuffer(vk::Buffer const& buffer, vk::MemoryPropertyFlags propertyFlags);
+		MemoryAllocation AllocateForImage(vk::Image const& image, vk::MemoryPropertyFlags propertyFlags, vk::ImageTiling tiling);
+
+		void Free(MemoryAllocation const& allocation);
+
+		//one entry per memory heap of the physical device
+		std::vector<MemoryHeapStatistics> GetHeapStatistics() const;
+		void PrintHeapStatistics() const;
+	private:
+		friend class ave::Singleton<MemoryAllocator>;
+		MemoryAllocator() = default;
+
+		static constexpr vk::DeviceSize m_BlockSize{ 64ull * 1024 * 1024 };
+		//anything from this size on skips the blocks, it would mostly waste the rest of one
+		static constexpr vk::DeviceSize m_DedicatedThreshold{ m_BlockSize / 2 };
+
+		struct MemoryBlock
+		{
+			vk::DeviceMemory Memory;
+			char* MappedPtr{ nullptr };
+			uint32_t MemoryTypeIdx{};
+			ResourceTiling Tiling{};
+			std::unique_ptr<TlsfAllocator> AllocatorUPtr;
+		};
+
+		vk::Device m_Device;
+		vk::PhysicalDeviceMemoryProperties m_MemoryProperties;
+		vk::DeviceSize m_BufferImageGranularity{ 1 };
+
+		mutable std::mutex m_Mutex;
+		//released blocks leave an empty slot so the block index of live allocations stays valid
+		std::vector<MemoryBlock> m_BlockVec;
+		std::vector<MemoryHeapStatistics> m_HeapStatisticsVec;
+
+		std::optional<uint32_t> FindMemoryTypeIndex(uint32_t supportedMemoryIndices, vk::MemoryPropertyFlags requestedProperties) const;
+		bool IsHostVisible(uint32_t memoryTypeIdx) const;
+		MemoryHeapStatistics& GetHeapStatistics(uint32_t memoryTypeIdx);
+
+		//the lock has to be held, a dedicated info forces a dedicated allocation for that resource
+		MemoryAllocation AllocateLocked(vk::MemoryRequirements const& requirements, vk::MemoryPropertyFlags propertyFlags, ResourceTiling tiling, vk::MemoryDedicatedAllocateInfo const* dedicatedInfoPtr);
+		MemoryAllocation AllocateDedicated(vk::MemoryRequirements const& requirements, uint32_t memoryTypeIdx, vk::MemoryDedicatedAllocateInfo const* dedicatedInfoPtr);
+		std::optional<MemoryAllocation> AllocateFromBlocks(vk::MemoryRequirements const& requirements, uint32_t memoryTypeIdx, ResourceTiling tiling);
+		std::optional<std::int32_t> CreateBlock(uint32_t memoryTypeIdx, ResourceTiling tiling);
+		void ReleaseBlock(std::int32_t blockIdx);
+	};
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef VK_MESH_LOD_H
+#define VK_MESH_LOD_H
+#include "Engine/Configuration.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	//has to match MAX_LOD_COUNT in Cull.comp
+	constexpr uint32_t MaxLodCount{ 5 };
+
+	//a range of the index buffer of a mesh, every lod indexes the same vertices
+	struct MeshLod
+	{
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+		//how far, in the units of the mesh, the surface of the lod is at most from the full mesh
+		float Error;
+	};
+
+	struct LodSettings
+	{
+		glm::vec3 CameraPosition{};
+		//turns the error of a lod into the distance from which it is used, the error then covers at most a pixel or so on screen
+		float DistanceScale{};
+		//a lod is only left once the distance is this fraction past the threshold, so an instance on the boundary does not flip every frame
+		float Hysteresis{ 0.1f };
+		bool Enabled{ true };
+	};
+
+	//starts from the lod of the last frame and only moves past a threshold when the distance clears it by the hysteresis, mirrored in Cull.comp
+	//the distance is divided by the scale of the instance, its error grows with it
+	inline uint32_t SelectLod(std::span<float const> lodDistanceSpan, float scaledDistance, uint32_t previousLod, float hysteresis)
+	{
+		uint32_t const lodCount{ static_cast<uint32_t>(lodDistanceSpan.size()) };
+		uint32_t lod{ std::min(previousLod, lodCount - 1) };
+		while (lod + 1 < lodCount and scaledDistance > lodDistanceSpan[lod + 1] * (1.f + hysteresis))
+		{
+			++lod;
+		}
+		while (lod > 0 and scaledDistance < lodDistanceSpan[lod] * (1.f - hysteresis))
+		{
+			--lod;
+		}
+		return lod;
+	}
+
+}
+
+#endif
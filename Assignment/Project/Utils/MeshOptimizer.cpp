@@ -0,0 +1,283 @@
+#include "MeshOptimizer.h"
+#include <iomanip>
+
+namespace
+{
+	//the triangles using every vertex, the triangles of vertex v are TriangleVec[OffsetVec[v]] up to TriangleVec[OffsetVec[v + 1]]
+	struct VertexAdjacency
+	{
+		std::vector<uint32_t> OffsetVec;
+		std::vector<uint32_t> TriangleVec;
+	};
+
+	VertexAdjacency BuildAdjacency(std::span<uint32_t const> indexSpan, std::size_t vertexCount)
+	{
+		VertexAdjacency adjacency{};
+		adjacency.OffsetVec.resize(vertexCount + 1);
+		for (uint32_t idx : indexSpan)
+		{
+			++adjacency.OffsetVec[idx + 1];
+		}
+		for (std::size_t vertexIdx{}; vertexIdx < vertexCount; ++vertexIdx)
+		{
+			adjacency.OffsetVec[vertexIdx + 1] += adjacency.OffsetVec[vertexIdx];
+		}
+
+		adjacency.TriangleVec.resize(indexSpan.size());
+		std::vector<uint32_t> fillVec(adjacency.OffsetVec.begin(), adjacency.OffsetVec.end() - 1);
+		for (std::size_t cornerIdx{}; cornerIdx < indexSpan.size(); ++cornerIdx)
+		{
+			adjacency.TriangleVec[fillVec[indexSpan[cornerIdx]]++] = static_cast<uint32_t>(cornerIdx / 3);
+		}
+		return adjacency;
+	}
+}
+
+float vkUtil::ComputeACMR(std::span<uint32_t const> indexSpan, std::size_t vertexCount, uint32_t cacheSize)
+{
+	if (indexSpan.size() < 3)
+	{
+		return 0.f;
+	}
+
+	//a vertex is in the fifo while fewer than cacheSize misses happened after its own
+	std::vector<std::uint64_t> missTimeVec(vertexCount, 0);
+	std::uint64_t missCount{};
+	for (uint32_t idx : indexSpan)
+	{
+		if (missTimeVec[idx] == 0 or missCount - missTimeVec[idx] >= cacheSize)
+		{
+			++missCount;
+			missTimeVec[idx] = missCount;
+		}
+	}
+	return static_cast<float>(missCount) / static_cast<float>(indexSpan.size() / 3);
+}
+
+void vkUtil::OptimizeVertexCache(std::vector<uint32_t>& indexVec, std::size_t vertexCount, uint32_t cacheSize)
+{
+	std::size_t const triangleCount{ indexVec.size() / 3 };
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	VertexAdjacency const adjacency{ BuildAdjacency(indexVec, vertexCount) };
+
+	std::vector<uint32_t> liveTriangleVec(vertexCount);
+	for (std::size_t vertexIdx{}; vertexIdx < vertexCount; ++vertexIdx)
+	{
+		liveTriangleVec[vertexIdx] = adjacency.OffsetVec[vertexIdx + 1] - adjacency.OffsetVec[vertexIdx];
+	}
+
+	//a vertex is in the cache while timeStamp - cacheTime <= cacheSize, the stamp starts high enough that nothing is
+	std::vector<std::uint64_t> cacheTimeVec(vertexCount, 0);
+	std::uint64_t timeStamp{ cacheSize + 1ull };
+	std::vector<bool> emittedVec(triangleCount, false);
+	std::vector<uint32_t> deadEndVec{};
+	std::vector<uint32_t> candidateVec{};
+
+	std::vector<uint32_t> outputVec{};
+	outputVec.reserve(indexVec.size());
+
+	std::int64_t fanningVertex{ 0 };
+	std::size_t nextVertex{ 1 };
+	while (fanningVertex >= 0)
+	{
+		candidateVec.clear();
+		for (uint32_t adjacencyIdx{ adjacency.OffsetVec[fanningVertex] }; adjacencyIdx < adjacency.OffsetVec[fanningVertex + 1]; ++adjacencyIdx)
+		{
+			uint32_t const triangleIdx{ adjacency.TriangleVec[adjacencyIdx] };
+			if (emittedVec[triangleIdx])
+			{
+				continue;
+			}
+			emittedVec[triangleIdx] = true;
+
+			for (std::size_t cornerIdx{ triangleIdx * 3ull }; cornerIdx < triangleIdx * 3ull + 3; ++cornerIdx)
+			{
+				uint32_t const vertexIdx{ indexVec[cornerIdx] };
+				outputVec.emplace_back(vertexIdx);
+				deadEndVec.emplace_back(vertexIdx);
+				candidateVec.emplace_back(vertexIdx);
+				--liveTriangleVec[vertexIdx];
+				if (timeStamp - cacheTimeVec[vertexIdx] > cacheSize)
+				{
+					cacheTimeVec[vertexIdx] = timeStamp++;
+				}
+			}
+		}
+
+		//the candidate that is still in the cache once its remaining triangles are fanned and has been in it the longest
+		fanningVertex = -1;
+		std::int64_t bestPriority{ -1 };
+		for (uint32_t vertexIdx : candidateVec)
+		{
+			if (liveTriangleVec[vertexIdx] == 0)
+			{
+				continue;
+			}
+
+			std::int64_t priority{ 0 };
+			std::uint64_t const age{ timeStamp - cacheTimeVec[vertexIdx] };
+			if (age + 2ull * liveTriangleVec[vertexIdx] <= cacheSize)
+			{
+				priority = static_cast<std::int64_t>(age);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				fanningVertex = vertexIdx;
+			}
+		}
+
+		//dead end, go back to the most recent vertex that still has triangles and else to the next one in the input
+		while (fanningVertex < 0 and not deadEndVec.empty())
+		{
+			uint32_t const vertexIdx{ deadEndVec.back() };
+			deadEndVec.pop_back();
+			if (liveTriangleVec[vertexIdx] > 0)
+			{
+				fanningVertex = vertexIdx;
+			}
+		}
+		while (fanningVertex < 0 and nextVertex < vertexCount)
+		{
+			if (liveTriangleVec[nextVertex] > 0)
+			{
+				fanningVertex = static_cast<std::int64_t>(nextVertex);
+			}
+			++nextVertex;
+		}
+	}
+
+	indexVec = std::move(outputVec);
+}
+
+void vkUtil::OptimizeOverdraw(std::vector<uint32_t>& indexVec, std::span<glm::vec3 const> positionSpan, std::span<glm::vec3 const> normalSpan, uint32_t cacheSize)
+{
+	std::size_t const triangleCount{ indexVec.size() / 3 };
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	struct Cluster
+	{
+		std::size_t FirstTriangle;
+		std::size_t TriangleCount;
+		//both area weighted
+		glm::vec3 Centroid;
+		glm::vec3 Normal;
+		float Area;
+		float SortKey;
+	};
+
+	//a triangle that misses the cache with every corner is where tipsify restarted after a dead end
+	std::vector<std::uint64_t> missTimeVec(positionSpan.size(), 0);
+	std::uint64_t missCount{};
+	std::vector<Cluster> clusterVec{};
+	glm::vec3 meshCentroid{};
+	float meshArea{};
+	float windingSign{};
+	for (std::size_t triangleIdx{}; triangleIdx < triangleCount; ++triangleIdx)
+	{
+		int triangleMisses{};
+		for (std::size_t cornerIdx{ triangleIdx * 3 }; cornerIdx < triangleIdx * 3 + 3; ++cornerIdx)
+		{
+			uint32_t const vertexIdx{ indexVec[cornerIdx] };
+			if (missTimeVec[vertexIdx] == 0 or missCount - missTimeVec[vertexIdx] >= cacheSize)
+			{
+				++missCount;
+				missTimeVec[vertexIdx] = missCount;
+				++triangleMisses;
+			}
+		}
+		if (triangleMisses == 3 or clusterVec.empty())
+		{
+			clusterVec.emplace_back(Cluster{ triangleIdx, 0, glm::vec3{}, glm::vec3{}, 0.f, 0.f });
+		}
+
+		glm::vec3 const& p0{ positionSpan[indexVec[triangleIdx * 3]] };
+		glm::vec3 const& p1{ positionSpan[indexVec[triangleIdx * 3 + 1]] };
+		glm::vec3 const& p2{ positionSpan[indexVec[triangleIdx * 3 + 2]] };
+		glm::vec3 const areaNormal{ glm::cross(p1 - p0, p2 - p0) };
+		float const area{ glm::length(areaNormal) };
+		glm::vec3 const centroid{ (p0 + p1 + p2) * (1.f / 3.f) };
+
+		Cluster& cluster{ clusterVec.back() };
+		++cluster.TriangleCount;
+		cluster.Centroid = cluster.Centroid + centroid * area;
+		cluster.Normal = cluster.Normal + areaNormal;
+		cluster.Area += area;
+		meshCentroid = meshCentroid + centroid * area;
+		meshArea += area;
+
+		if (not normalSpan.empty())
+		{
+			glm::vec3 const vertexNormal{ normalSpan[indexVec[triangleIdx * 3]] + normalSpan[indexVec[triangleIdx * 3 + 1]] + normalSpan[indexVec[triangleIdx * 3 + 2]] };
+			windingSign += glm::dot(areaNormal, vertexNormal);
+		}
+	}
+
+	if (clusterVec.size() < 2 or meshArea <= 0.f)
+	{
+		return;
+	}
+	meshCentroid = meshCentroid * (1.f / meshArea);
+	float const normalSign{ windingSign < 0.f ? -1.f : 1.f };
+
+	//how much a cluster faces away from the center of the mesh, outer clusters hide the inner ones from most view directions
+	for (auto& cluster : clusterVec)
+	{
+		float const normalLength{ glm::length(cluster.Normal) };
+		if (normalLength <= 0.f or cluster.Area <= 0.f)
+		{
+			continue;
+		}
+		glm::vec3 const clusterCentroid{ cluster.Centroid * (1.f / cluster.Area) };
+		cluster.SortKey = glm::dot(clusterCentroid - meshCentroid, cluster.Normal * (normalSign / normalLength));
+	}
+
+	std::stable_sort(clusterVec.begin(), clusterVec.end(),
+		[](Cluster const& lhs, Cluster const& rhs)
+		{
+			return lhs.SortKey > rhs.SortKey;
+		});
+
+	std::vector<uint32_t> outputVec{};
+	outputVec.reserve(indexVec.size());
+	for (auto const& cluster : clusterVec)
+	{
+		auto const firstIt{ indexVec.begin() + cluster.FirstTriangle * 3 };
+		outputVec.insert(outputVec.end(), firstIt, firstIt + cluster.TriangleCount * 3);
+	}
+	indexVec = std::move(outputVec);
+}
+
+std::vector<uint32_t> vkUtil::OptimizeVertexFetch(std::vector<uint32_t>& indexVec, std::size_t vertexCount, std::size_t& usedVertexCount)
+{
+	std::vector<uint32_t> remapVec(vertexCount, UINT32_MAX);
+	uint32_t nextIdx{};
+	for (auto& idx : indexVec)
+	{
+		if (remapVec[idx] == UINT32_MAX)
+		{
+			remapVec[idx] = nextIdx++;
+		}
+		idx = remapVec[idx];
+	}
+
+	usedVertexCount = nextIdx;
+	return remapVec;
+}
+
+void vkUtil::PrintMeshOptimizationReport(std::string const& fileName, MeshOptimizationReport const& report)
+{
+	float const reduction{ report.InputVertexCount == 0 ? 0.f : 100.f * (1.f - static_cast<float>(report.OutputVertexCount) / static_cast<float>(report.InputVertexCount)) };
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "Optimized " << fileName << ": " << report.InputVertexCount << " -> " << report.OutputVertexCount << " vertices (-" << reduction << "%), "
+		<< "acmr " << report.InputACMR << " -> " << report.WeldedACMR << " welded -> " << report.OutputACMR << "\n"
+		<< std::defaultfloat;
+}
@@ -0,0 +1,130 @@
+#ifndef VK_MESH_OPTIMIZER_H
+#define VK_MESH_OPTIMIZER_H
+#include "Engine/Configuration.h"
+#include "Utils/Hash.h"
+#include <span>
+#include <cstring>
+
+namespace vkUtil
+{
+
+	//entries of the simulated post transform cache, small enough to hold on every gpu the engine targets
+	constexpr uint32_t VertexCacheSize{ 16 };
+
+	//what the optimization of one mesh achieved, acmr is the average amount of cache misses per triangle
+	//3 means every corner is transformed again, a regular grid reaches about 0.5
+	struct MeshOptimizationReport
+	{
+		std::size_t InputVertexCount;
+		std::size_t OutputVertexCount;
+		float InputACMR;
+		float WeldedACMR;
+		float OutputACMR;
+	};
+
+	//simulates a fifo cache of cacheSize vertices over the triangle list
+	float ComputeACMR(std::span<uint32_t const> indexSpan, std::size_t vertexCount, uint32_t cacheSize = VertexCacheSize);
+
+	//reorders the triangles with tipsify (Sander et al. 2007) so neighbouring triangles reuse the transformed vertices
+	void OptimizeVertexCache(std::vector<uint32_t>& indexVec, std::size_t vertexCount, uint32_t cacheSize = VertexCacheSize);
+
+	//splits the cache optimized order into the clusters tipsify started on a dead end and draws the clusters facing outwards first
+	//so they occlude the ones behind them from most directions, the order inside a cluster and so its cache efficiency is kept
+	//the vertex normals are only used to tell which side the winding faces, an empty span trusts the winding
+	void OptimizeOverdraw(std::vector<uint32_t>& indexVec, std::span<glm::vec3 const> positionSpan, std::span<glm::vec3 const> normalSpan, uint32_t cacheSize = VertexCacheSize);
+
+	//numbers the vertices in the order the indices first use them so the vertex fetch walks memory forwards
+	//returns the new index of every old vertex, vertices no triangle uses get UINT32_MAX
+	std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indexVec, std::size_t vertexCount, std::size_t& usedVertexCount);
+
+	//merges the vertices that are equal byte for byte, the vertex can not have padding or equal vertices would not be found
+	template<typename VertexStruct>
+	void WeldVertices(std::vector<VertexStruct>& vertexVec, std::vector<uint32_t>& indexVec)
+	{
+		//open addressing table of indices into the welded vertices, at most half full
+		std::size_t tableSize{ 1 };
+		while (tableSize < vertexVec.size() * 2)
+		{
+			tableSize <<= 1;
+		}
+		constexpr uint32_t emptySlot{ UINT32_MAX };
+		std::vector<uint32_t> tableVec(tableSize, emptySlot);
+
+		std::vector<VertexStruct> weldedVec{};
+		weldedVec.reserve(vertexVec.size());
+		std::vector<uint32_t> remapVec(vertexVec.size());
+		for (std::size_t vertexIdx{}; vertexIdx < vertexVec.size(); ++vertexIdx)
+		{
+			VertexStruct const& vertex{ vertexVec[vertexIdx] };
+			std::size_t slot{ HashBytes(&vertex, sizeof(VertexStruct)) & (tableSize - 1) };
+			while (tableVec[slot] != emptySlot and std::memcmp(&weldedVec[tableVec[slot]], &vertex, sizeof(VertexStruct)) != 0)
+			{
+				slot = (slot + 1) & (tableSize - 1);
+			}
+
+			if (tableVec[slot] == emptySlot)
+			{
+				tableVec[slot] = static_cast<uint32_t>(weldedVec.size());
+				weldedVec.emplace_back(vertex);
+			}
+			remapVec[vertexIdx] = tableVec[slot];
+		}
+
+		for (auto& idx : indexVec)
+		{
+			idx = remapVec[idx];
+		}
+		vertexVec = std::move(weldedVec);
+	}
+
+	//welds the vertices, reorders the triangles for the vertex cache and for overdraw and then the vertices for the fetch
+	template<typename VertexStruct>
+	MeshOptimizationReport OptimizeMesh(std::vector<VertexStruct>& vertexVec, std::vector<uint32_t>& indexVec)
+	{
+		MeshOptimizationReport report{};
+		report.InputVertexCount = vertexVec.size();
+		report.InputACMR = ComputeACMR(indexVec, vertexVec.size());
+
+		WeldVertices<VertexStruct>(vertexVec, indexVec);
+		report.WeldedACMR = ComputeACMR(indexVec, vertexVec.size());
+
+		OptimizeVertexCache(indexVec, vertexVec.size());
+
+		std::vector<glm::vec3> positionVec(vertexVec.size());
+		std::vector<glm::vec3> normalVec{};
+		for (std::size_t vertexIdx{}; vertexIdx < vertexVec.size(); ++vertexIdx)
+		{
+			positionVec[vertexIdx] = vertexVec[vertexIdx].Position;
+		}
+		if constexpr (requires(VertexStruct vertex) { vertex.Normal; })
+		{
+			normalVec.resize(vertexVec.size());
+			for (std::size_t vertexIdx{}; vertexIdx < vertexVec.size(); ++vertexIdx)
+			{
+				normalVec[vertexIdx] = vertexVec[vertexIdx].Normal;
+			}
+		}
+		OptimizeOverdraw(indexVec, positionVec, normalVec);
+
+		std::size_t usedVertexCount{};
+		std::vector<uint32_t> const remapVec{ OptimizeVertexFetch(indexVec, vertexVec.size(), usedVertexCount) };
+		std::vector<VertexStruct> fetchOrderVec(usedVertexCount);
+		for (std::size_t vertexIdx{}; vertexIdx < vertexVec.size(); ++vertexIdx)
+		{
+			if (remapVec[vertexIdx] != UINT32_MAX)
+			{
+				fetchOrderVec[remapVec[vertexIdx]] = vertexVec[vertexIdx];
+			}
+		}
+		vertexVec = std::move(fetchOrderVec);
+
+		report.OutputVertexCount = vertexVec.size();
+		report.OutputACMR = ComputeACMR(indexVec, vertexVec.size());
+		return report;
+	}
+
+	void PrintMeshOptimizationReport(std::string const& fileName, MeshOptimizationReport const& report);
+
+}
+
+#endif
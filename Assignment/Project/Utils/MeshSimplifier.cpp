@@ -0,0 +1,419 @@
+#include "MeshSimplifier.h"
+#include "Utils/MeshOptimizer.h"
+#include <numeric>
+
+namespace
+{
+	//moving a border vertex off its edge costs this much more than moving it off its own triangle
+	constexpr double BorderWeight{ 10.0 };
+	//the coarsest lod may move its surface this far, relative to the radius of the mesh
+	constexpr float MaxLodError{ 0.1f };
+	//a lod has to leave out at least this fraction of the triangles of the previous one
+	constexpr float MinLodReduction{ 0.2f };
+	//a pass only collapses edges whose surroundings it did not change yet, so it takes several to reach the target
+	constexpr int MaxPassCount{ 128 };
+
+	//sum of squared distances to a set of planes, weighted by the area they came from
+	struct Quadric
+	{
+		double XX, XY, XZ, YY, YZ, ZZ;
+		double X, Y, Z;
+		double C;
+		double Weight;
+
+		void AddPlane(glm::vec3 const& normal, float distance, double weight)
+		{
+			double const nx{ normal.x }, ny{ normal.y }, nz{ normal.z }, d{ distance };
+			XX += weight * nx * nx; XY += weight * nx * ny; XZ += weight * nx * nz;
+			YY += weight * ny * ny; YZ += weight * ny * nz; ZZ += weight * nz * nz;
+			X += weight * nx * d; Y += weight * ny * d; Z += weight * nz * d;
+			C += weight * d * d;
+			Weight += weight;
+		}
+
+		void Add(Quadric const& other)
+		{
+			XX += other.XX; XY += other.XY; XZ += other.XZ;
+			YY += other.YY; YZ += other.YZ; ZZ += other.ZZ;
+			X += other.X; Y += other.Y; Z += other.Z;
+			C += other.C;
+			Weight += other.Weight;
+		}
+
+		//mean squared distance of the point to the planes
+		double GetError(glm::vec3 const& position) const
+		{
+			double const x{ position.x }, y{ position.y }, z{ position.z };
+			double const error
+			{
+				XX * x * x + YY * y * y + ZZ * z * z
+				+ 2 * (XY * x * y + XZ * x * z + YZ * y * z)
+				+ 2 * (X * x + Y * y + Z * z)
+				+ C
+			};
+			return Weight > 0 ? std::max(error / Weight, 0.0) : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		uint32_t From;
+		uint32_t To;
+		double Error;
+	};
+
+	//vertices that share a position share one id, the index of the first of them
+	std::vector<uint32_t> BuildPositionIds(std::span<glm::vec3 const> positionSpan)
+	{
+		std::size_t tableSize{ 1 };
+		while (tableSize < positionSpan.size() * 2)
+		{
+			tableSize <<= 1;
+		}
+		constexpr uint32_t emptySlot{ UINT32_MAX };
+		std::vector<uint32_t> tableVec(tableSize, emptySlot);
+
+		std::vector<uint32_t> positionIdVec(positionSpan.size());
+		for (std::size_t vertexIdx{}; vertexIdx < positionSpan.size(); ++vertexIdx)
+		{
+			glm::vec3 const& position{ positionSpan[vertexIdx] };
+			std::size_t slot{ vkUtil::HashBytes(&position, sizeof(glm::vec3)) & (tableSize - 1) };
+			while (tableVec[slot] != emptySlot and std::memcmp(&positionSpan[tableVec[slot]], &position, sizeof(glm::vec3)) != 0)
+			{
+				slot = (slot + 1) & (tableSize - 1);
+			}
+
+			if (tableVec[slot] == emptySlot)
+			{
+				tableVec[slot] = static_cast<uint32_t>(vertexIdx);
+			}
+			positionIdVec[vertexIdx] = tableVec[slot];
+		}
+		return positionIdVec;
+	}
+
+	//planes of every triangle and, perpendicular to them, of every edge only one triangle uses
+	std::vector<Quadric> BuildQuadrics(std::span<uint32_t const> indexSpan, std::span<glm::vec3 const> positionSpan, std::vector<uint32_t> const& positionIdVec)
+	{
+		std::vector<Quadric> quadricVec(positionSpan.size(), Quadric{});
+
+		struct Edge
+		{
+			std::uint64_t Key;
+			uint32_t CornerIdx;
+		};
+		std::vector<Edge> edgeVec{};
+		edgeVec.reserve(indexSpan.size());
+
+		for (std::size_t triangleIdx{}; triangleIdx < indexSpan.size() / 3; ++triangleIdx)
+		{
+			uint32_t const id0{ positionIdVec[indexSpan[triangleIdx * 3]] };
+			uint32_t const id1{ positionIdVec[indexSpan[triangleIdx * 3 + 1]] };
+			uint32_t const id2{ positionIdVec[indexSpan[triangleIdx * 3 + 2]] };
+
+			glm::vec3 const areaNormal{ glm::cross(positionSpan[id1] - positionSpan[id0], positionSpan[id2] - positionSpan[id0]) };
+			float const doubleArea{ glm::length(areaNormal) };
+			if (doubleArea > 0.f)
+			{
+				glm::vec3 const normal{ areaNormal * (1.f / doubleArea) };
+				float const distance{ -glm::dot(normal, positionSpan[id0]) };
+				for (uint32_t id : { id0, id1, id2 })
+				{
+					quadricVec[id].AddPlane(normal, distance, doubleArea * 0.5);
+				}
+			}
+
+			uint32_t const idArr[3]{ id0, id1, id2 };
+			for (uint32_t cornerIdx{}; cornerIdx < 3; ++cornerIdx)
+			{
+				uint32_t const from{ idArr[cornerIdx] };
+				uint32_t const to{ idArr[(cornerIdx + 1) % 3] };
+				std::uint64_t const key{ (static_cast<std::uint64_t>(std::min(from, to)) << 32) | std::max(from, to) };
+				edgeVec.emplace_back(Edge{ key, static_cast<uint32_t>(triangleIdx * 3 + cornerIdx) });
+			}
+		}
+
+		std::sort(edgeVec.begin(), edgeVec.end(), [](Edge const& lhs, Edge const& rhs) { return lhs.Key < rhs.Key; });
+		for (std::size_t edgeIdx{}; edgeIdx < edgeVec.size(); ++edgeIdx)
+		{
+			bool const sharedWithPrevious{ edgeIdx > 0 and edgeVec[edgeIdx - 1].Key == edgeVec[edgeIdx].Key };
+			bool const sharedWithNext{ edgeIdx + 1 < edgeVec.size() and edgeVec[edgeIdx + 1].Key == edgeVec[edgeIdx].Key };
+			if (sharedWithPrevious or sharedWithNext)
+			{
+				continue;
+			}
+
+			uint32_t const cornerIdx{ edgeVec[edgeIdx].CornerIdx };
+			uint32_t const firstCorner{ cornerIdx - cornerIdx % 3 };
+			glm::vec3 const& p0{ positionSpan[positionIdVec[indexSpan[cornerIdx]]] };
+			glm::vec3 const& p1{ positionSpan[positionIdVec[indexSpan[firstCorner + (cornerIdx + 1) % 3]]] };
+			glm::vec3 const& p2{ positionSpan[positionIdVec[indexSpan[firstCorner + (cornerIdx + 2) % 3]]] };
+
+			glm::vec3 const edgeNormal{ glm::cross(p1 - p0, glm::cross(p1 - p0, p2 - p0)) };
+			float const edgeNormalLength{ glm::length(edgeNormal) };
+			if (edgeNormalLength <= 0.f)
+			{
+				continue;
+			}
+
+			glm::vec3 const normal{ edgeNormal * (1.f / edgeNormalLength) };
+			float const distance{ -glm::dot(normal, p0) };
+			double const weight{ glm::dot(p1 - p0, p1 - p0) * BorderWeight };
+			quadricVec[positionIdVec[indexSpan[cornerIdx]]].AddPlane(normal, distance, weight);
+			quadricVec[positionIdVec[indexSpan[firstCorner + (cornerIdx + 1) % 3]]].AddPlane(normal, distance, weight);
+		}
+		return quadricVec;
+	}
+
+	//drops the triangles that lost a corner to a collapse, a triangle is gone once two of its corners share a position
+	void RemapTriangles(std::vector<uint32_t>& indexVec, std::vector<uint32_t> const& vertexRemapVec, std::vector<uint32_t> const& positionIdVec)
+	{
+		std::size_t writeIdx{};
+		for (std::size_t triangleIdx{}; triangleIdx < indexVec.size() / 3; ++triangleIdx)
+		{
+			uint32_t const v0{ vertexRemapVec[indexVec[triangleIdx * 3]] };
+			uint32_t const v1{ vertexRemapVec[indexVec[triangleIdx * 3 + 1]] };
+			uint32_t const v2{ vertexRemapVec[indexVec[triangleIdx * 3 + 2]] };
+			uint32_t const id0{ positionIdVec[v0] }, id1{ positionIdVec[v1] }, id2{ positionIdVec[v2] };
+			if (id0 == id1 or id1 == id2 or id0 == id2)
+			{
+				continue;
+			}
+
+			indexVec[writeIdx++] = v0;
+			indexVec[writeIdx++] = v1;
+			indexVec[writeIdx++] = v2;
+		}
+		indexVec.resize(writeIdx);
+	}
+}
+
+std::vector<uint32_t> vkUtil::SimplifyMesh(std::span<uint32_t const> indexSpan, std::span<glm::vec3 const> positionSpan, std::size_t targetIndexCount, float maxError, bool preserveSeams, float& resultError)
+{
+	resultError = 0.f;
+	std::vector<uint32_t> indexVec(indexSpan.begin(), indexSpan.end());
+	if (indexVec.size() <= targetIndexCount)
+	{
+		return indexVec;
+	}
+
+	std::vector<uint32_t> const positionIdVec{ BuildPositionIds(positionSpan) };
+	std::vector<Quadric> quadricVec{ BuildQuadrics(indexVec, positionSpan, positionIdVec) };
+	double const maxErrorSquared{ static_cast<double>(maxError) * maxError };
+
+	std::vector<uint32_t> vertexRemapVec(positionSpan.size());
+	std::vector<uint32_t> offsetVec(positionSpan.size() + 1);
+	std::vector<uint32_t> adjacentTriangleVec{};
+	std::vector<Collapse> collapseVec{};
+	std::vector<bool> lockedVec(positionSpan.size());
+	//vertices of the collapsing position and the vertex of the target position each of them moves to
+	std::vector<std::pair<uint32_t, uint32_t>> partnerVec{};
+
+	for (int passIdx{}; passIdx < MaxPassCount and indexVec.size() > targetIndexCount; ++passIdx)
+	{
+		std::size_t const triangleCount{ indexVec.size() / 3 };
+
+		//triangles around every position id
+		std::fill(offsetVec.begin(), offsetVec.end(), 0);
+		for (uint32_t idx : indexVec)
+		{
+			++offsetVec[positionIdVec[idx] + 1];
+		}
+		for (std::size_t idIdx{}; idIdx < positionSpan.size(); ++idIdx)
+		{
+			offsetVec[idIdx + 1] += offsetVec[idIdx];
+		}
+		adjacentTriangleVec.resize(indexVec.size());
+		{
+			std::vector<uint32_t> fillVec(offsetVec.begin(), offsetVec.end() - 1);
+			for (std::size_t cornerIdx{}; cornerIdx < indexVec.size(); ++cornerIdx)
+			{
+				adjacentTriangleVec[fillVec[positionIdVec[indexVec[cornerIdx]]]++] = static_cast<uint32_t>(cornerIdx / 3);
+			}
+		}
+
+		//both directions of every edge, a collapse keeps the position it moves to
+		collapseVec.clear();
+		for (std::size_t triangleIdx{}; triangleIdx < triangleCount; ++triangleIdx)
+		{
+			for (uint32_t cornerIdx{}; cornerIdx < 3; ++cornerIdx)
+			{
+				uint32_t const from{ positionIdVec[indexVec[triangleIdx * 3 + cornerIdx]] };
+				uint32_t const to{ positionIdVec[indexVec[triangleIdx * 3 + (cornerIdx + 1) % 3]] };
+				collapseVec.emplace_back(Collapse{ from, to, 0.0 });
+				collapseVec.emplace_back(Collapse{ to, from, 0.0 });
+			}
+		}
+		std::sort(collapseVec.begin(), collapseVec.end(), [](Collapse const& lhs, Collapse const& rhs) { return lhs.From != rhs.From ? lhs.From < rhs.From : lhs.To < rhs.To; });
+		collapseVec.erase(std::unique(collapseVec.begin(), collapseVec.end(), [](Collapse const& lhs, Collapse const& rhs) { return lhs.From == rhs.From and lhs.To == rhs.To; }), collapseVec.end());
+
+		for (auto& collapse : collapseVec)
+		{
+			collapse.Error = quadricVec[collapse.From].GetError(positionSpan[collapse.To]);
+		}
+		std::stable_sort(collapseVec.begin(), collapseVec.end(), [](Collapse const& lhs, Collapse const& rhs) { return lhs.Error < rhs.Error; });
+
+		std::iota(vertexRemapVec.begin(), vertexRemapVec.end(), 0);
+		std::fill(lockedVec.begin(), lockedVec.end(), false);
+
+		std::size_t const trianglesToRemove{ (indexVec.size() - targetIndexCount) / 3 };
+		std::size_t removedTriangles{};
+		std::size_t collapseCount{};
+		for (auto const& collapse : collapseVec)
+		{
+			if (removedTriangles >= trianglesToRemove or collapse.Error > maxErrorSquared)
+			{
+				break;
+			}
+			if (lockedVec[collapse.From] or lockedVec[collapse.To])
+			{
+				continue;
+			}
+
+			//every vertex of the collapsing position needs an edge to a vertex of the target, otherwise its attributes would be torn
+			partnerVec.clear();
+			std::size_t collapsedTriangles{};
+			bool valid{ true };
+			for (uint32_t adjacencyIdx{ offsetVec[collapse.From] }; adjacencyIdx < offsetVec[collapse.From + 1] and valid; ++adjacencyIdx)
+			{
+				uint32_t const triangleIdx{ adjacentTriangleVec[adjacencyIdx] };
+				uint32_t fromVertex{ UINT32_MAX };
+				uint32_t toVertex{ UINT32_MAX };
+				for (uint32_t cornerIdx{}; cornerIdx < 3; ++cornerIdx)
+				{
+					uint32_t const vertexIdx{ indexVec[triangleIdx * 3 + cornerIdx] };
+					if (positionIdVec[vertexIdx] == collapse.From)
+					{
+						fromVertex = vertexIdx;
+					}
+					else if (positionIdVec[vertexIdx] == collapse.To)
+					{
+						toVertex = vertexIdx;
+					}
+				}
+
+				auto partnerIt{ std::find_if(partnerVec.begin(), partnerVec.end(), [&](auto const& partner) { return partner.first == fromVertex; }) };
+				if (partnerIt == partnerVec.end())
+				{
+					partnerVec.emplace_back(fromVertex, UINT32_MAX);
+					partnerIt = partnerVec.end() - 1;
+				}
+
+				if (toVertex != UINT32_MAX)
+				{
+					partnerIt->second = toVertex;
+					++collapsedTriangles;
+					continue;
+				}
+
+				//the triangle stays, it may not turn over
+				glm::vec3 cornerArr[3]{};
+				glm::vec3 movedCornerArr[3]{};
+				for (uint32_t cornerIdx{}; cornerIdx < 3; ++cornerIdx)
+				{
+					uint32_t const positionId{ positionIdVec[indexVec[triangleIdx * 3 + cornerIdx]] };
+					cornerArr[cornerIdx] = positionSpan[positionId];
+					movedCornerArr[cornerIdx] = positionId == collapse.From ? positionSpan[collapse.To] : cornerArr[cornerIdx];
+				}
+				glm::vec3 const normal{ glm::cross(cornerArr[1] - cornerArr[0], cornerArr[2] - cornerArr[0]) };
+				glm::vec3 const movedNormal{ glm::cross(movedCornerArr[1] - movedCornerArr[0], movedCornerArr[2] - movedCornerArr[0]) };
+				valid = glm::dot(normal, movedNormal) > 0.f;
+			}
+
+			auto const anyPartnerIt{ std::find_if(partnerVec.begin(), partnerVec.end(), [](auto const& partner) { return partner.second != UINT32_MAX; }) };
+			if (not valid or anyPartnerIt == partnerVec.end())
+			{
+				continue;
+			}
+			for (auto& partner : partnerVec)
+			{
+				if (partner.second == UINT32_MAX)
+				{
+					if (preserveSeams)
+					{
+						valid = false;
+						break;
+					}
+					//the vertex takes the attributes of another side of the seam
+					partner.second = anyPartnerIt->second;
+				}
+			}
+			if (not valid)
+			{
+				continue;
+			}
+
+			for (auto const& [fromVertex, toVertex] : partnerVec)
+			{
+				vertexRemapVec[fromVertex] = toVertex;
+			}
+			quadricVec[collapse.To].Add(quadricVec[collapse.From]);
+
+			//the errors and flip tests of the neighbours assumed the old positions, they wait for the next pass
+			for (uint32_t adjacencyIdx{ offsetVec[collapse.From] }; adjacencyIdx < offsetVec[collapse.From + 1]; ++adjacencyIdx)
+			{
+				uint32_t const triangleIdx{ adjacentTriangleVec[adjacencyIdx] };
+				for (uint32_t cornerIdx{}; cornerIdx < 3; ++cornerIdx)
+				{
+					lockedVec[positionIdVec[indexVec[triangleIdx * 3 + cornerIdx]]] = true;
+				}
+			}
+
+			resultError = std::max(resultError, static_cast<float>(std::sqrt(collapse.Error)));
+			removedTriangles += collapsedTriangles;
+			++collapseCount;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+		RemapTriangles(indexVec, vertexRemapVec, positionIdVec);
+	}
+
+	return indexVec;
+}
+
+std::vector<vkUtil::MeshLod> vkUtil::BuildLods(std::vector<uint32_t>& indexVec, std::span<glm::vec3 const> positionSpan, float meshRadius)
+{
+	std::vector<MeshLod> lodVec{};
+	lodVec.emplace_back(MeshLod{ 0, static_cast<uint32_t>(indexVec.size()), 0.f });
+
+	std::vector<uint32_t> previousLodVec(indexVec.begin(), indexVec.end());
+	for (uint32_t lodIdx{ 1 }; lodIdx < MaxLodCount; ++lodIdx)
+	{
+		std::size_t const targetIndexCount{ previousLodVec.size() / 6 * 3 };
+		float const maxError{ meshRadius * MaxLodError };
+
+		//seams are kept while that still gets close to the target, a far lod can do without them
+		float error{};
+		std::vector<uint32_t> lodIndexVec{ SimplifyMesh(previousLodVec, positionSpan, targetIndexCount, maxError, true, error) };
+		if (lodIndexVec.size() > targetIndexCount + targetIndexCount / 4)
+		{
+			lodIndexVec = SimplifyMesh(previousLodVec, positionSpan, targetIndexCount, maxError, false, error);
+		}
+
+		if (lodIndexVec.empty() or static_cast<float>(lodIndexVec.size()) > static_cast<float>(previousLodVec.size()) * (1.f - MinLodReduction))
+		{
+			break;
+		}
+
+		OptimizeVertexCache(lodIndexVec, positionSpan.size());
+
+		//simplified from the previous lod, so the errors add up
+		lodVec.emplace_back(MeshLod{ static_cast<uint32_t>(indexVec.size()), static_cast<uint32_t>(lodIndexVec.size()), lodVec.back().Error + error });
+		indexVec.insert(indexVec.end(), lodIndexVec.begin(), lodIndexVec.end());
+		previousLodVec = std::move(lodIndexVec);
+	}
+	return lodVec;
+}
+
+void vkUtil::PrintLodReport(std::string const& fileName, std::span<MeshLod const> lodSpan)
+{
+	std::cout << "Lods of " << fileName << ":";
+	for (auto const& lod : lodSpan)
+	{
+		std::cout << " " << lod.IndexCount / 3 << " (" << lod.Error << ")";
+	}
+	std::cout << " triangles (error)\n";
+}
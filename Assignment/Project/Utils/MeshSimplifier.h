@@ -0,0 +1,37 @@
+#ifndef VK_MESH_SIMPLIFIER_H
+#define VK_MESH_SIMPLIFIER_H
+#include "Engine/Configuration.h"
+#include "Utils/MeshLod.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	//collapses edges in order of their quadric error (Garland and Heckbert 1997) until the target is reached or the next collapse would exceed maxError
+	//a collapse moves every vertex on one position onto a vertex of the neighbouring position, so the result indexes the same vertices and attributes are never interpolated
+	//with preserveSeams, positions with several vertices (uv seams, hard edges) only collapse along the seam, without it a vertex that has no edge to the target takes
+	//the attributes of another side of the seam, which tears the texture but is fine for a lod seen from far away. collapses that flip a triangle are always rejected
+	//maxError and the error written to resultError are distances in the units of the positions
+	std::vector<uint32_t> SimplifyMesh(std::span<uint32_t const> indexSpan, std::span<glm::vec3 const> positionSpan, std::size_t targetIndexCount, float maxError, bool preserveSeams, float& resultError);
+
+	//appends up to MaxLodCount - 1 simplified versions of the index buffer to it, every lod has about half the triangles of the previous one
+	//the chain stops early when a lod no longer removes enough triangles to be worth a draw, the first lod is the mesh itself
+	std::vector<MeshLod> BuildLods(std::vector<uint32_t>& indexVec, std::span<glm::vec3 const> positionSpan, float meshRadius);
+
+	template<typename VertexStruct>
+	std::vector<MeshLod> BuildLods(std::vector<uint32_t>& indexVec, std::span<VertexStruct const> vertexSpan, float meshRadius)
+	{
+		std::vector<glm::vec3> positionVec(vertexSpan.size());
+		for (std::size_t vertexIdx{}; vertexIdx < vertexSpan.size(); ++vertexIdx)
+		{
+			positionVec[vertexIdx] = vertexSpan[vertexIdx].Position;
+		}
+		return BuildLods(indexVec, std::span<glm::vec3 const>{ positionVec }, meshRadius);
+	}
+
+	//what the lods of one mesh came down to
+	void PrintLodReport(std::string const& fileName, std::span<MeshLod const> lodSpan);
+
+}
+
+#endif
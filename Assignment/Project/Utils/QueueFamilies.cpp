@@ -9,25 +9,38 @@ vkUtil::QueueFamilyIndices vkUtil::FindQueueFamilies(const vk::PhysicalDevice& p
 	std::cout << "\nNumber of queue families supported: " << queueFamilyVec.size() << "\n";
 
 
+	//a pure transfer family is usually the dma engine, a compute family without graphics is the next best thing
+	bool transferOnly{ false };
+
 	int index{};
 	for (const auto& queueFamily : queueFamilyVec)
 	{
-		if (queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)
+		if (not queueFamilyIndices.AllIndicesSet())
 		{
-			queueFamilyIndices.GraphicsFamily = index;
+			if (queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)
+			{
+				queueFamilyIndices.GraphicsFamily = index;
 
-			std::cout << "Queue family \"" << index << "\" is suitable for graphics\n";
-		}
+				std::cout << "Queue family \"" << index << "\" is suitable for graphics\n";
+			}
 
-		if (physicalDevice.getSurfaceSupportKHR(index, surface))
-		{
-			queueFamilyIndices.PresentFamily = index;
+			if (physicalDevice.getSurfaceSupportKHR(index, surface))
+			{
+				queueFamilyIndices.PresentFamily = index;
 
-			std::cout << "Queue family \"" << index << "\" is suitable for presenting\n";
+				std::cout << "Queue family \"" << index << "\" is suitable for presenting\n";
+			}
 		}
-		if (queueFamilyIndices.AllIndicesSet())
+
+		bool const transfer{ static_cast<bool>(queueFamily.queueFlags & vk::QueueFlagBits::eTransfer) };
+		bool const graphics{ static_cast<bool>(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) };
+		bool const compute{ static_cast<bool>(queueFamily.queueFlags & vk::QueueFlagBits::eCompute) };
+		if (transfer and not graphics and not transferOnly)
 		{
-			break;
+			queueFamilyIndices.TransferFamily = index;
+			transferOnly = not compute;
+
+			std::cout << "Queue family \"" << index << "\" is suitable for transfers\n";
 		}
 		++index;
 	}
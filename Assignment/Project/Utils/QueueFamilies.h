@@ -9,11 +9,19 @@ namespace vkUtil
 	{
 		std::optional<uint32_t> GraphicsFamily;
 		std::optional<uint32_t> PresentFamily;
+		//a family with transfer but without graphics, uploads on it run next to rendering
+		std::optional<uint32_t> TransferFamily;
 
 		bool AllIndicesSet()
 		{
 			return GraphicsFamily.has_value() and PresentFamily.has_value();
 		}
+
+		//falls back to the graphics family when the device has no separate transfer family
+		uint32_t GetUploadFamily() const
+		{
+			return TransferFamily.value_or(GraphicsFamily.value());
+		}
 	};
 
 	QueueFamilyIndices FindQueueFamilies(const vk::PhysicalDevice& physicalDevice, const vk::SurfaceKHR& surface);
@@ -36,3 +36,23 @@ std::vector<vk::VertexInputAttributeDescription> vkUtil::Vertex3D::GetAttributeD
 
 	return attributeDescriptionVec;
 }
+
+
+std::vector<vk::VertexInputBindingDescription> vkUtil::CompressedVertex3D::GetBindingDescription()
+{
+	std::vector<vk::VertexInputBindingDescription> bindingDescriptionVec;
+	bindingDescriptionVec.emplace_back(vk::VertexInputBindingDescription{ 0, sizeof(CompressedVertex3D), vk::VertexInputRate::eVertex });
+
+	return bindingDescriptionVec;
+}
+
+std::vector<vk::VertexInputAttributeDescription> vkUtil::CompressedVertex3D::GetAttributeDescription()
+{
+	std::vector<vk::VertexInputAttributeDescription> attributeDescriptionVec{};
+
+	attributeDescriptionVec.emplace_back(vk::VertexInputAttributeDescription{ 0, 0, vk::Format::eR16G16B16A16Unorm, 0 });
+	attributeDescriptionVec.emplace_back(vk::VertexInputAttributeDescription{ 1, 0, vk::Format::eR16G16Snorm, sizeof(CompressedVertex3D::Position) });
+	attributeDescriptionVec.emplace_back(vk::VertexInputAttributeDescription{ 2, 0, vk::Format::eR16G16Sfloat, sizeof(CompressedVertex3D::Position) + sizeof(CompressedVertex3D::Normal) });
+
+	return attributeDescriptionVec;
+}
@@ -1,9 +1,12 @@
 #ifndef VK_RENDERSTRUCTS_H
 #define VK_RENDERSTRUCTS_H
 #include "Engine/Configuration.h"
+#include "Utils/MeshLod.h"
 
 namespace vkUtil
 {
+	class UploadContext;
+
 	template<typename T>
 	concept Vertex = requires(T t)
 	{
@@ -19,12 +22,44 @@ namespace vkUtil
 
 	struct MeshInBundle
 	{
-		vk::Queue const& GraphicsQueue;
-		vk::CommandBuffer const& MainCommandBuffer;
+		UploadContext* UploadContextPtr;
 		vk::Device const& Device;
 		vk::PhysicalDevice const& PhysicalDevice;
 	};
 
+	//per mesh data of the culling dispatch, matches the push constant block in Cull.comp
+	struct CullPushConstants
+	{
+		glm::vec4 BoundingSphere;
+		uint32_t FirstInstance;
+		uint32_t InstanceCount;
+		//command of the first lod, the other lods follow it
+		uint32_t DrawCommandIdx;
+		uint32_t CullingEnabled;
+		//distance from which each lod is used, the first one is always 0
+		float LodDistanceArr[MaxLodCount];
+		uint32_t LodCount;
+		//the visible indices of lod n start n * LodStride entries after those of lod 0
+		uint32_t LodStride;
+		float LodHysteresis;
+	};
+
+	//per draw data of the graphics pipeline, the vertex shader reads DrawDataBuffer[FirstDraw + gl_DrawID]
+	struct DrawPushConstants
+	{
+		uint32_t FirstDraw;
+	};
+
+	//one entry per indirect draw command, matches the DrawData struct in Shader3D.glsl
+	struct DrawData
+	{
+		//dequantizes the positions of compressed vertices, position = offset + stored position * scale
+		glm::vec3 PositionOffset;
+		uint32_t TextureIdx;
+		glm::vec3 PositionScale;
+		float Padding;
+	};
+
 	struct Vertex2D
 	{
 		glm::vec2 Position;
@@ -41,6 +76,26 @@ namespace vkUtil
 		static std::vector<vk::VertexInputBindingDescription> GetBindingDescription();
 		static std::vector<vk::VertexInputAttributeDescription> GetAttributeDescription();
 	};
+
+	//maps the unorm16 positions of a compressed mesh back onto its bounding box
+	struct VertexQuantization
+	{
+		glm::vec3 Offset{ 0.f };
+		glm::vec3 Scale{ 1.f };
+	};
+
+	//half the size of Vertex3D, read by Shader3DCompressed.vert
+	struct CompressedVertex3D
+	{
+		//unorm16 inside the bounding box of the mesh, the fourth component only pads the attribute to a widely supported format
+		uint16_t Position[4];
+		//snorm16 octahedral encoding of the unit normal
+		int16_t Normal[2];
+		//half floats
+		uint16_t UV[2];
+		static std::vector<vk::VertexInputBindingDescription> GetBindingDescription();
+		static std::vector<vk::VertexInputAttributeDescription> GetAttributeDescription();
+	};
 }
 
 #endif
\ No newline at end of file
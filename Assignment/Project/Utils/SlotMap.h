@@ -0,0 +1,145 @@
+#ifndef VK_SLOT_MAP_H
+#define VK_SLOT_MAP_H
+#include "Engine/Configuration.h"
+
+namespace vkUtil
+{
+
+	//stays valid until the element it points to is erased, a reused slot gets a new generation so old handles stop resolving
+	struct SlotHandle
+	{
+		static constexpr uint32_t InvalidIdx{ UINT32_MAX };
+
+		uint32_t Idx{ InvalidIdx };
+		uint32_t Generation{};
+
+		bool operator==(SlotHandle const& other) const = default;
+	};
+
+	//generational slot map, the values stay tightly packed so they can be copied or iterated as one array
+	//insert, erase and lookup are O(1), erasing moves the last value into the hole
+	template<typename T>
+	class SlotMap final
+	{
+	public:
+		SlotHandle Insert(T const& value)
+		{
+			uint32_t slotIdx{};
+			if (m_FreeSlotVec.empty())
+			{
+				slotIdx = static_cast<uint32_t>(m_SlotVec.size());
+				m_SlotVec.emplace_back(Slot{});
+			}
+			else
+			{
+				slotIdx = m_FreeSlotVec.back();
+				m_FreeSlotVec.pop_back();
+			}
+
+			Slot& slot{ m_SlotVec[slotIdx] };
+			slot.DenseIdx = static_cast<uint32_t>(m_DenseVec.size());
+
+			m_DenseVec.emplace_back(value);
+			m_DenseSlotVec.emplace_back(slotIdx);
+
+			return SlotHandle{ slotIdx, slot.Generation };
+		}
+
+		//returns false for a handle that no longer resolves
+		bool Erase(SlotHandle const& handle)
+		{
+			if (not Contains(handle))
+			{
+				return false;
+			}
+
+			Slot& slot{ m_SlotVec[handle.Idx] };
+			SwapDense(slot.DenseIdx, static_cast<uint32_t>(m_DenseVec.size() - 1));
+
+			m_DenseVec.pop_back();
+			m_DenseSlotVec.pop_back();
+
+			slot.DenseIdx = SlotHandle::InvalidIdx;
+			++slot.Generation;
+			m_FreeSlotVec.emplace_back(handle.Idx);
+			return true;
+		}
+
+		bool Contains(SlotHandle const& handle) const
+		{
+			return handle.Idx < m_SlotVec.size() and m_SlotVec[handle.Idx].Generation == handle.Generation
+				and m_SlotVec[handle.Idx].DenseIdx != SlotHandle::InvalidIdx;
+		}
+
+		//position of the value in the packed array, changes whenever values are swapped or erased
+		std::optional<uint32_t> GetDenseIdx(SlotHandle const& handle) const
+		{
+			if (not Contains(handle))
+			{
+				return std::nullopt;
+			}
+			return m_SlotVec[handle.Idx].DenseIdx;
+		}
+
+		SlotHandle GetHandle(uint32_t denseIdx) const
+		{
+			uint32_t const slotIdx{ m_DenseSlotVec[denseIdx] };
+			return SlotHandle{ slotIdx, m_SlotVec[slotIdx].Generation };
+		}
+
+		//swaps two packed values, the handles keep pointing at their own value
+		void SwapDense(uint32_t denseIdxA, uint32_t denseIdxB)
+		{
+			if (denseIdxA == denseIdxB)
+			{
+				return;
+			}
+
+			std::swap(m_DenseVec[denseIdxA], m_DenseVec[denseIdxB]);
+			std::swap(m_DenseSlotVec[denseIdxA], m_DenseSlotVec[denseIdxB]);
+
+			m_SlotVec[m_DenseSlotVec[denseIdxA]].DenseIdx = denseIdxA;
+			m_SlotVec[m_DenseSlotVec[denseIdxB]].DenseIdx = denseIdxB;
+		}
+
+		T& operator[](uint32_t denseIdx)
+		{
+			return m_DenseVec[denseIdx];
+		}
+
+		T const& operator[](uint32_t denseIdx) const
+		{
+			return m_DenseVec[denseIdx];
+		}
+
+		std::vector<T> const& GetDense() const
+		{
+			return m_DenseVec;
+		}
+
+		std::int64_t GetSize() const
+		{
+			return std::ssize(m_DenseVec);
+		}
+
+		std::size_t GetHostBytes() const
+		{
+			return m_DenseVec.capacity() * sizeof(T) + m_DenseSlotVec.capacity() * sizeof(uint32_t) + m_SlotVec.capacity() * sizeof(Slot) + m_FreeSlotVec.capacity() * sizeof(uint32_t);
+		}
+	private:
+		struct Slot
+		{
+			uint32_t DenseIdx{ SlotHandle::InvalidIdx };
+			uint32_t Generation{};
+		};
+
+		std::vector<T> m_DenseVec;
+		//packed index to slot, needed to fix up the slot of a value that gets moved
+		std::vector<uint32_t> m_DenseSlotVec;
+		std::vector<Slot> m_SlotVec;
+		std::vector<uint32_t> m_FreeSlotVec;
+	};
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+#include "TlsfAllocator.h"
+#include <bit>
+
+vkUtil::TlsfAllocator::TlsfAllocator(std::uint64_t capacity)
+	: m_Capacity{ capacity }
+{
+	for (auto& headArr : m_FreeListHeadArr)
+	{
+		headArr.fill(m_NoBlock);
+	}
+
+	if (capacity > 0)
+	{
+		std::int32_t const blockIdx{ CreateBlock() };
+		m_BlockVec[blockIdx].Offset = 0;
+		m_BlockVec[blockIdx].Size = capacity;
+		InsertFreeBlock(blockIdx);
+	}
+}
+
+std::optional<std::uint64_t> vkUtil::TlsfAllocator::Allocate(std::uint64_t size, std::uint64_t alignment)
+{
+	if (size == 0)
+	{
+		return std::nullopt;
+	}
+	alignment = std::max<std::uint64_t>(alignment, 1);
+
+	//any block of this size fits the allocation wherever the alignment lands
+	std::uint64_t const searchSize{ size + alignment - 1 };
+	if (searchSize > m_Capacity)
+	{
+		return std::nullopt;
+	}
+
+	std::int32_t blockIdx{ FindFreeBlock(searchSize) };
+	if (blockIdx == m_NoBlock)
+	{
+		return std::nullopt;
+	}
+	RemoveFreeBlock(blockIdx);
+
+	//the padding in front becomes a free block of its own
+	std::uint64_t const blockOffset{ m_BlockVec[blockIdx].Offset };
+	std::uint64_t const padding{ (blockOffset + alignment - 1) / alignment * alignment - blockOffset };
+	if (padding > 0)
+	{
+		SplitBlock(blockIdx, padding);
+		std::int32_t const alignedBlockIdx{ m_BlockVec[blockIdx].NextPhysical };
+		RemoveFreeBlock(alignedBlockIdx);
+		InsertFreeBlock(blockIdx);
+		blockIdx = alignedBlockIdx;
+	}
+
+	SplitBlock(blockIdx, size);
+
+	Block& block{ m_BlockVec[blockIdx] };
+	block.Free = false;
+	m_UsedSize += block.Size;
+	m_AllocatedBlockMap.emplace(block.Offset, blockIdx);
+
+	return block.Offset;
+}
+
+void vkUtil::TlsfAllocator::Free(std::uint64_t offset)
+{
+	auto const allocatedIt{ m_AllocatedBlockMap.find(offset) };
+	if (allocatedIt == m_AllocatedBlockMap.end())
+	{
+		return;
+	}
+
+	std::int32_t blockIdx{ allocatedIt->second };
+	m_AllocatedBlockMap.erase(allocatedIt);
+
+	m_BlockVec[blockIdx].Free = true;
+	m_UsedSize -= m_BlockVec[blockIdx].Size;
+
+	std::int32_t const nextIdx{ m_BlockVec[blockIdx].NextPhysical };
+	if (nextIdx != m_NoBlock and m_BlockVec[nextIdx].Free)
+	{
+		RemoveFreeBlock(nextIdx);
+		MergeWithNext(blockIdx);
+	}
+
+	std::int32_t const previousIdx{ m_BlockVec[blockIdx].PreviousPhysical };
+	if (previousIdx != m_NoBlock and m_BlockVec[previousIdx].Free)
+	{
+		RemoveFreeBlock(previousIdx);
+		MergeWithNext(previousIdx);
+		blockIdx = previousIdx;
+	}
+
+	InsertFreeBlock(blockIdx);
+}
+
+std::uint64_t vkUtil::TlsfAllocator::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+std::uint64_t vkUtil::TlsfAllocator::GetUsedSize() const
+{
+	return m_UsedSize;
+}
+
+std::int64_t vkUtil::TlsfAllocator::GetAllocationCount() const
+{
+	return std::ssize(m_AllocatedBlockMap);
+}
+
+void vkUtil::TlsfAllocator::MapSize(std::uint64_t size, int& firstLevel, int& secondLevel)
+{
+	//sizes below the second level count all share the first list
+	if (size < m_SecondLevelCount)
+	{
+		firstLevel = 0;
+		secondLevel = static_cast<int>(size);
+		return;
+	}
+
+	int const mostSignificantBit{ static_cast<int>(std::bit_width(size)) - 1 };
+	firstLevel = mostSignificantBit - m_SecondLevelLog2 + 1;
+	secondLevel = static_cast<int>((size >> (mostSignificantBit - m_SecondLevelLog2)) - m_SecondLevelCount);
+}
+
+std::int32_t vkUtil::TlsfAllocator::CreateBlock()
+{
+	if (not m_UnusedBlockIdxVec.empty())
+	{
+		std::int32_t const blockIdx{ m_UnusedBlockIdxVec.back() };
+		m_UnusedBlockIdxVec.pop_back();
+		m_BlockVec[blockIdx] = Block{};
+		return blockIdx;
+	}
+
+	m_BlockVec.emplace_back();
+	return static_cast<std::int32_t>(m_BlockVec.size() - 1);
+}
+
+void vkUtil::TlsfAllocator::ReleaseBlock(std::int32_t blockIdx)
+{
+	m_UnusedBlockIdxVec.emplace_back(blockIdx);
+}
+
+void vkUtil::TlsfAllocator::InsertFreeBlock(std::int32_t blockIdx)
+{
+	Block& block{ m_BlockVec[blockIdx] };
+	block.Free = true;
+
+	int firstLevel{};
+	int secondLevel{};
+	MapSize(block.Size, firstLevel, secondLevel);
+
+	std::int32_t& headIdx{ m_FreeListHeadArr[firstLevel][secondLevel] };
+	block.PreviousFree = m_NoBlock;
+	block.NextFree = headIdx;
+	if (headIdx != m_NoBlock)
+	{
+		m_BlockVec[headIdx].PreviousFree = blockIdx;
+	}
+	headIdx = blockIdx;
+
+	m_FirstLevelBitmap |= std::uint64_t{ 1 } << firstLevel;
+	m_SecondLevelBitmapArr[firstLevel] |= 1u << secondLevel;
+}
+
+void vkUtil::TlsfAllocator::RemoveFreeBlock(std::int32_t blockIdx)
+{
+	Block& block{ m_BlockVec[blockIdx] };
+
+	int firstLevel{};
+	int secondLevel{};
+	MapSize(block.Size, firstLevel, secondLevel);
+
+	if (block.PreviousFree != m_NoBlock)
+	{
+		m_BlockVec[block.PreviousFree].NextFree = block.NextFree;
+	}
+	else
+	{
+		m_FreeListHeadArr[firstLevel][secondLevel] = block.NextFree;
+	}
+
+	if (block.NextFree != m_NoBlock)
+	{
+		m_BlockVec[block.NextFree].PreviousFree = block.PreviousFree;
+	}
+
+	block.PreviousFree = m_NoBlock;
+	block.NextFree = m_NoBlock;
+
+	if (m_FreeListHeadArr[firstLevel][secondLevel] == m_NoBlock)
+	{
+		m_SecondLevelBitmapArr[firstLevel] &= ~(1u << secondLevel);
+		if (m_SecondLevelBitmapArr[firstLevel] == 0)
+		{
+			m_FirstLevelBitmap &= ~(std::uint64_t{ 1 } << firstLevel);
+		}
+	}
+}
+
+std::int32_t vkUtil::TlsfAllocator::FindFreeBlock(std::uint64_t size) const
+{
+	//round up to the next list so every block in the found list is large enough
+	if (size >= m_SecondLevelCount)
+	{
+		int const mostSignificantBit{ static_cast<int>(std::bit_width(size)) - 1 };
+		size += (std::uint64_t{ 1 } << (mostSignificantBit - m_SecondLevelLog2)) - 1;
+	}
+
+	int firstLevel{};
+	int secondLevel{};
+	MapSize(size, firstLevel, secondLevel);
+	if (firstLevel >= m_FirstLevelCount)
+	{
+		return m_NoBlock;
+	}
+
+	std::uint32_t secondLevelMap{ m_SecondLevelBitmapArr[firstLevel] & (~0u << secondLevel) };
+	if (secondLevelMap == 0)
+	{
+		if (firstLevel + 1 >= m_FirstLevelCount)
+		{
+			return m_NoBlock;
+		}
+
+		std::uint64_t const firstLevelMap{ m_FirstLevelBitmap & (~std::uint64_t{ 0 } << (firstLevel + 1)) };
+		if (firstLevelMap == 0)
+		{
+			return m_NoBlock;
+		}
+
+		firstLevel = std::countr_zero(firstLevelMap);
+		secondLevelMap = m_SecondLevelBitmapArr[firstLevel];
+	}
+
+	secondLevel = std::countr_zero(secondLevelMap);
+	return m_FreeListHeadArr[firstLevel][secondLevel];
+}
+
+void vkUtil::TlsfAllocator::SplitBlock(std::int32_t blockIdx, std::uint64_t size)
+{
+	if (m_BlockVec[blockIdx].Size <= size)
+	{
+		return;
+	}
+
+	std::int32_t const remainderIdx{ CreateBlock() };
+	Block& block{ m_BlockVec[blockIdx] };
+	Block& remainder{ m_BlockVec[remainderIdx] };
+
+	remainder.Offset = block.Offset + size;
+	remainder.Size = block.Size - size;
+	remainder.PreviousPhysical = blockIdx;
+	remainder.NextPhysical = block.NextPhysical;
+	if (block.NextPhysical != m_NoBlock)
+	{
+		m_BlockVec[block.NextPhysical].PreviousPhysical = remainderIdx;
+	}
+
+	block.Size = size;
+	block.NextPhysical = remainderIdx;
+
+	InsertFreeBlock(remainderIdx);
+}
+
+void vkUtil::TlsfAllocator::MergeWithNext(std::int32_t blockIdx)
+{
+	std::int32_t const nextIdx{ m_BlockVec[blockIdx].NextPhysical };
+	Block& block{ m_BlockVec[blockIdx] };
+	Block const& next{ m_BlockVec[nextIdx] };
+
+	block.Size += next.Size;
+	block.NextPhysical = next.NextPhysical;
+	if (next.NextPhysical != m_NoBlock)
+	{
+		m_BlockVec[next.NextPhysical].PreviousPhysical = blockIdx;
+	}
+
+	ReleaseBlock(nextIdx);
+}
@@ -0,0 +1,70 @@
+#ifndef VK_TLSF_ALLOCATOR_H
+#define VK_TLSF_ALLOCATOR_H
+#include "Engine/Configuration.h"
+#include <unordered_map>
+
+namespace vkUtil
+{
+
+	//two level segregated fit allocator over the offsets [0, capacity), allocating and freeing are O(1)
+	//the first level splits the free blocks by power of two, the second level splits every power of two in m_SecondLevelCount ranges
+	class TlsfAllocator final
+	{
+	public:
+		explicit TlsfAllocator(std::uint64_t capacity);
+
+		//alignment does not have to be a power of two
+		std::optional<std::uint64_t> Allocate(std::uint64_t size, std::uint64_t alignment);
+
+		void Free(std::uint64_t offset);
+
+		std::uint64_t GetCapacity() const;
+		std::uint64_t GetUsedSize() const;
+		std::int64_t GetAllocationCount() const;
+	private:
+		static constexpr int m_SecondLevelLog2{ 4 };
+		static constexpr int m_SecondLevelCount{ 1 << m_SecondLevelLog2 };
+		static constexpr int m_FirstLevelCount{ 64 - m_SecondLevelLog2 + 1 };
+		static constexpr std::int32_t m_NoBlock{ -1 };
+
+		//a range of the managed space, neighbours in space are linked as well as neighbours in the same free list
+		struct Block
+		{
+			std::uint64_t Offset{};
+			std::uint64_t Size{};
+			bool Free{};
+			std::int32_t PreviousPhysical{ m_NoBlock };
+			std::int32_t NextPhysical{ m_NoBlock };
+			std::int32_t PreviousFree{ m_NoBlock };
+			std::int32_t NextFree{ m_NoBlock };
+		};
+
+		std::uint64_t m_Capacity;
+		std::uint64_t m_UsedSize{};
+
+		std::vector<Block> m_BlockVec;
+		std::vector<std::int32_t> m_UnusedBlockIdxVec;
+		//offset of every allocated block to its index
+		std::unordered_map<std::uint64_t, std::int32_t> m_AllocatedBlockMap;
+
+		std::uint64_t m_FirstLevelBitmap{};
+		std::array<std::uint32_t, m_FirstLevelCount> m_SecondLevelBitmapArr{};
+		std::array<std::array<std::int32_t, m_SecondLevelCount>, m_FirstLevelCount> m_FreeListHeadArr{};
+
+		static void MapSize(std::uint64_t size, int& firstLevel, int& secondLevel);
+
+		std::int32_t CreateBlock();
+		void ReleaseBlock(std::int32_t blockIdx);
+
+		void InsertFreeBlock(std::int32_t blockIdx);
+		void RemoveFreeBlock(std::int32_t blockIdx);
+		std::int32_t FindFreeBlock(std::uint64_t size) const;
+		//cuts the part behind size off into a new free block
+		void SplitBlock(std::int32_t blockIdx, std::uint64_t size);
+		//merges the block with the next physical block, which has to be free
+		void MergeWithNext(std::int32_t blockIdx);
+	};
+
+}
+
+#endif
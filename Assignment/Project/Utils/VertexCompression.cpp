@@ -0,0 +1,103 @@
+#include "VertexCompression.h"
+#include <glm/gtc/packing.hpp>
+#include <iomanip>
+
+vkUtil::VertexQuantization vkUtil::ComputeQuantization(MeshBounds const& bounds)
+{
+	//a flat axis still needs a scale the positions can be divided by
+	constexpr float minExtent{ 1e-6f };
+
+	VertexQuantization quantization{};
+	quantization.Offset = bounds.Min;
+	quantization.Scale = glm::max(bounds.Max - bounds.Min, glm::vec3{ minExtent });
+	return quantization;
+}
+
+glm::vec2 vkUtil::EncodeOctahedral(glm::vec3 const& normal)
+{
+	float const manhattanLength{ std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z) };
+	if (manhattanLength == 0.f)
+	{
+		return glm::vec2{ 0.f };
+	}
+
+	glm::vec3 const projected{ normal / manhattanLength };
+	if (projected.z >= 0.f)
+	{
+		return glm::vec2{ projected.x, projected.y };
+	}
+
+	//the lower half of the octahedron is folded over the diagonals
+	return glm::vec2
+	{
+		(1.f - std::abs(projected.y)) * (projected.x >= 0.f ? 1.f : -1.f),
+		(1.f - std::abs(projected.x)) * (projected.y >= 0.f ? 1.f : -1.f)
+	};
+}
+
+glm::vec3 vkUtil::DecodeOctahedral(glm::vec2 const& encoded)
+{
+	glm::vec3 normal{ encoded.x, encoded.y, 1.f - std::abs(encoded.x) - std::abs(encoded.y) };
+	float const fold{ std::max(-normal.z, 0.f) };
+	normal.x += normal.x >= 0.f ? -fold : fold;
+	normal.y += normal.y >= 0.f ? -fold : fold;
+	return glm::normalize(normal);
+}
+
+std::vector<vkUtil::CompressedVertex3D> vkUtil::CompressVertices(std::span<Vertex3D const> vertexSpan, VertexQuantization const& quantization)
+{
+	std::vector<CompressedVertex3D> compressedVertexVec(vertexSpan.size());
+	for (std::size_t vertexIdx{}; vertexIdx < vertexSpan.size(); ++vertexIdx)
+	{
+		Vertex3D const& vertex{ vertexSpan[vertexIdx] };
+		CompressedVertex3D& compressedVertex{ compressedVertexVec[vertexIdx] };
+
+		glm::vec3 const normalizedPosition{ glm::clamp((vertex.Position - quantization.Offset) / quantization.Scale, glm::vec3{ 0.f }, glm::vec3{ 1.f }) };
+		compressedVertex.Position[0] = glm::packUnorm1x16(normalizedPosition.x);
+		compressedVertex.Position[1] = glm::packUnorm1x16(normalizedPosition.y);
+		compressedVertex.Position[2] = glm::packUnorm1x16(normalizedPosition.z);
+		compressedVertex.Position[3] = 0;
+
+		glm::vec2 const encodedNormal{ EncodeOctahedral(vertex.Normal) };
+		compressedVertex.Normal[0] = static_cast<int16_t>(glm::packSnorm1x16(encodedNormal.x));
+		compressedVertex.Normal[1] = static_cast<int16_t>(glm::packSnorm1x16(encodedNormal.y));
+
+		compressedVertex.UV[0] = glm::packHalf1x16(vertex.UV.x);
+		compressedVertex.UV[1] = glm::packHalf1x16(vertex.UV.y);
+	}
+	return compressedVertexVec;
+}
+
+void vkUtil::PrintCompressionReport(std::string const& fileName, std::span<Vertex3D const> vertexSpan, std::span<CompressedVertex3D const> compressedVertexSpan, VertexQuantization const& quantization)
+{
+	float maxPositionError{};
+	float minNormalCos{ 1.f };
+	for (std::size_t vertexIdx{}; vertexIdx < vertexSpan.size(); ++vertexIdx)
+	{
+		Vertex3D const& vertex{ vertexSpan[vertexIdx] };
+		CompressedVertex3D const& compressedVertex{ compressedVertexSpan[vertexIdx] };
+
+		glm::vec3 const normalizedPosition
+		{
+			glm::unpackUnorm1x16(compressedVertex.Position[0]),
+			glm::unpackUnorm1x16(compressedVertex.Position[1]),
+			glm::unpackUnorm1x16(compressedVertex.Position[2])
+		};
+		maxPositionError = std::max(maxPositionError, glm::length(quantization.Offset + normalizedPosition * quantization.Scale - vertex.Position));
+
+		float const normalLength{ glm::length(vertex.Normal) };
+		if (normalLength > 0.f)
+		{
+			glm::vec2 const encodedNormal
+			{
+				glm::unpackSnorm1x16(static_cast<uint16_t>(compressedVertex.Normal[0])),
+				glm::unpackSnorm1x16(static_cast<uint16_t>(compressedVertex.Normal[1]))
+			};
+			minNormalCos = std::min(minNormalCos, glm::dot(DecodeOctahedral(encodedNormal), vertex.Normal / normalLength));
+		}
+	}
+
+	std::cout << "Compressed " << fileName << ": " << vertexSpan.size_bytes() / 1024 << " -> " << compressedVertexSpan.size_bytes() / 1024 << " KB of vertices"
+		<< std::fixed << std::setprecision(5) << ", max position error " << maxPositionError
+		<< std::setprecision(3) << ", max normal error " << std::acos(std::clamp(minNormalCos, -1.f, 1.f)) * ave::ToDegrees << " degrees\n" << std::defaultfloat;
+}
@@ -0,0 +1,25 @@
+#ifndef VK_VERTEX_COMPRESSION_H
+#define VK_VERTEX_COMPRESSION_H
+#include "Engine/Configuration.h"
+#include "Utils/RenderStructs.h"
+#include "Utils/Bounds.h"
+#include <span>
+
+namespace vkUtil
+{
+
+	//the bounding box of the mesh becomes the unorm16 range of its positions
+	VertexQuantization ComputeQuantization(MeshBounds const& bounds);
+
+	//octahedral encoding of a unit vector (Cigolle et al. 2014), decoded by DecodeOctahedral in Shader3DCompressed.vert
+	glm::vec2 EncodeOctahedral(glm::vec3 const& normal);
+	glm::vec3 DecodeOctahedral(glm::vec2 const& encoded);
+
+	std::vector<CompressedVertex3D> CompressVertices(std::span<Vertex3D const> vertexSpan, VertexQuantization const& quantization);
+
+	//the largest distance a position moved and the largest angle in degrees a normal turned, to check the precision of a compressed mesh
+	void PrintCompressionReport(std::string const& fileName, std::span<Vertex3D const> vertexSpan, std::span<CompressedVertex3D const> compressedVertexSpan, VertexQuantization const& quantization);
+
+}
+
+#endif